@@ -68,15 +68,15 @@ public:
 
 	// Get all tokens from arguments
 	//
-	// \return std::vector<std::string>
-	std::vector<std::string> get_tokens() const noexcept {
+	// \return const std::vector<std::string>&
+	const std::vector<std::string>& get_tokens() const noexcept {
 		return m_tokens;
 	}
 
 	// Get all arguments in std::map
 	//
-	// \return std::map<std::string, std::string>
-	std::map<std::string, std::string> get_args() const noexcept {
+	// \return const std::map<std::string, std::string>&
+	const std::map<std::string, std::string>& get_args() const noexcept {
 		return m_args;
 	}
 
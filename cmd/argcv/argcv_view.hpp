@@ -0,0 +1,277 @@
+// argcv_view.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef CMD_ARGCV_ARGCV_VIEW_HPP_
+#define CMD_ARGCV_ARGCV_VIEW_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../../general/string/number.hpp"
+#include "../../general/string/string_view.hpp"
+
+namespace drodil {
+namespace cmd {
+namespace argcv {
+
+using drodil::general::string::string_view;
+
+namespace detail {
+
+// Check if get_value_as parses T as a number without allocations. Character
+// types are read as characters through a stream like ArgCV does.
+template<typename T>
+struct is_parsed_number : std::integral_constant<bool,
+		(std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value
+				&& !std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value
+				&& !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value
+				&& !std::is_same<T, char32_t>::value) || std::is_floating_point<T>::value> {
+};
+
+// Parse integer value, zero if it is not a valid number
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value, T>::type parse_number(string_view value) noexcept {
+	T result{};
+	if (drodil::general::string::from_chars(value.data(), value.data() + value.size(), result).ec != std::errc()) {
+		return T{};
+	}
+	return result;
+}
+
+// Parse floating point value through double, zero if it is not a valid number
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value, T>::type parse_number(string_view value) noexcept {
+	double result = 0;
+	if (drodil::general::string::from_chars(value.data(), value.data() + value.size(), result).ec != std::errc()) {
+		return T{};
+	}
+	return static_cast<T>(result);
+}
+
+// Parse value with operator>> like ArgCV::get_value_as
+template<typename T>
+T parse_stream(string_view value) {
+	std::istringstream iss{value.to_string()};
+	T result{};
+	iss >> result;
+	return result;
+}
+
+} // namespace detail
+
+// Parsed argument of ArgCVView, both views point into argv
+struct ArgView {
+	string_view key;
+	string_view value;
+};
+
+// \class ArgCVView
+// Parses command line arguments in the same formats as ArgCV but keeps views
+// into argv instead of copying it. Arguments are kept in a flat array sorted
+// by key, stored inline for typical command lines so parsing does no heap
+// allocations. argv must outlive the parser.
+class ArgCVView {
+public:
+	// Number of arguments stored without heap allocation
+	static const std::size_t inline_capacity = 32;
+
+	// Initialize the parser with argc and argv
+	//
+	// \param[in] argc int    Number of arguments
+	// \param[in] argv char** Pointer of char array of arguments
+	ArgCVView(int argc, char** argv)
+			: m_argv(argc > 1 ? argv + 1 : argv), m_token_count(argc > 1 ? static_cast<std::size_t>(argc - 1) : 0),
+			  m_args(m_inline), m_size(0) {
+		if (m_token_count > inline_capacity) {
+			m_overflow.resize(m_token_count);
+			m_args = m_overflow.data();
+		}
+		parse();
+	}
+
+	ArgCVView(const ArgCVView&) = delete;
+	ArgCVView& operator=(const ArgCVView&) = delete;
+
+	// Get number of tokens, argv[0] excluded
+	//
+	// \return size_t
+	std::size_t token_count() const noexcept {
+		return m_token_count;
+	}
+
+	// Get token, argv[0] excluded
+	//
+	// \param[in] index size_t Index of the token, less than token_count()
+	//
+	// \return string_view
+	string_view token(std::size_t index) const noexcept {
+		return string_view(m_argv[index]);
+	}
+
+	// Get number of parsed arguments
+	//
+	// \return size_t
+	std::size_t size() const noexcept {
+		return m_size;
+	}
+
+	// Iterate arguments sorted by key
+	const ArgView* begin() const noexcept {
+		return m_args;
+	}
+
+	const ArgView* end() const noexcept {
+		return m_args + m_size;
+	}
+
+	// Find argument with binary search
+	//
+	// \param[in] key string_view Parameter key to find
+	//
+	// \return const ArgView* Argument or nullptr if not set
+	const ArgView* find(string_view key) const noexcept {
+		const ArgView* it = std::lower_bound(begin(), end(), key,
+				[](const ArgView& arg, string_view k) { return arg.key < k; });
+		return it != end() && it->key == key ? it : nullptr;
+	}
+
+	// Check if argument is set
+	//
+	// \param[in] key string_view Parameter key to check
+	//
+	// \return bool
+	bool has_arg(string_view key) const noexcept {
+		return find(key) != nullptr;
+	}
+
+	// Check if argument is set and it's value is non-zero length
+	//
+	// \param[in] key string_view Parameter key to check
+	//
+	// \return bool
+	bool has_arg_with_value(string_view key) const noexcept {
+		const ArgView* arg = find(key);
+		return arg != nullptr && !arg->value.empty();
+	}
+
+	// Returns value for given key
+	//
+	// If key is not set in arguments, returns empty view
+	//
+	// \param[in] key string_view Parameter key to get value for
+	//
+	// \return string_view View into argv
+	string_view get_value(string_view key) const noexcept {
+		const ArgView* arg = find(key);
+		return arg != nullptr ? arg->value : string_view();
+	}
+
+	// Get parameter value as number, parsed without allocations
+	//
+	// If key is not set or value is not a valid number, returns zero. Used
+	// for integers and floating point types, float and long double are
+	// parsed through double.
+	//
+	// \param[in] key string_view Parameter key to get value for
+	//
+	// \return T
+	template<typename T>
+	typename std::enable_if<detail::is_parsed_number<T>::value, T>::type
+	get_value_as(string_view key) const noexcept {
+		return detail::parse_number<T>(get_value(key));
+	}
+
+	// Get parameter value as user defined format
+	//
+	// \param[in] key string_view Parameter key to get value for
+	//
+	// \return T
+	template<typename T>
+	typename std::enable_if<!detail::is_parsed_number<T>::value, T>::type
+	get_value_as(string_view key) const {
+		return detail::parse_stream<T>(get_value(key));
+	}
+
+private:
+	// Parse parameters from argv with the same rules as ArgCV::parse
+	void parse() noexcept {
+		for (std::size_t i = 0; i < m_token_count; i++) {
+			string_view token(m_argv[i]);
+			if (token.empty() || token[0] != '-') {
+				continue;
+			}
+			token = token.substr(token.starts_with("--") ? 2 : 1);
+
+			ArgView& arg = m_args[m_size++];
+			std::size_t pos = token.find('=');
+			if (pos != string_view::npos) {
+				arg.key = token.substr(0, pos);
+				arg.value = token.substr(pos + 1);
+			} else if (i + 1 < m_token_count && m_argv[i + 1][0] != '-') {
+				arg.key = token;
+				arg.value = string_view(m_argv[i + 1]);
+			} else {
+				arg.key = token;
+				arg.value = string_view();
+			}
+		}
+
+		// Stable sort keeps the first occurrence of a key first, which is the
+		// one kept like with std::map::insert. Short command lines use an
+		// insertion sort that needs no buffer, long ones already allocated
+		// and std::stable_sort keeps them O(n log n).
+		if (m_size <= inline_capacity) {
+			for (std::size_t i = 1; i < m_size; i++) {
+				ArgView arg = m_args[i];
+				std::size_t j = i;
+				while (j > 0 && arg.key < m_args[j - 1].key) {
+					m_args[j] = m_args[j - 1];
+					--j;
+				}
+				m_args[j] = arg;
+			}
+		} else {
+			std::stable_sort(m_args, m_args + m_size,
+					[](const ArgView& a, const ArgView& b) { return a.key < b.key; });
+		}
+		m_size = static_cast<std::size_t>(std::unique(m_args, m_args + m_size,
+				[](const ArgView& a, const ArgView& b) { return a.key == b.key; }) - m_args);
+	}
+
+	char** m_argv;
+	std::size_t m_token_count;
+	ArgView* m_args;
+	std::size_t m_size;
+	ArgView m_inline[inline_capacity];
+	std::vector<ArgView> m_overflow;
+};
+
+} // namespace argcv
+} // namespace cmd
+} // namespace drodil
+
+#endif // CMD_ARGCV_ARGCV_VIEW_HPP_
@@ -0,0 +1,410 @@
+// argument_reader.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef CMD_ARGCV_ARGUMENT_READER_HPP_
+#define CMD_ARGCV_ARGUMENT_READER_HPP_
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../general/string/string_view.hpp"
+
+namespace drodil {
+namespace cmd {
+namespace argcv {
+
+using drodil::general::string::string_view;
+
+// How arguments are separated in a file or stream
+enum class ArgumentFormat {
+	response, // Whitespace separated, with shell like '' and "" quoting and \ escapes
+	line,     // One argument per line, empty lines are skipped
+	null      // Separated by '\0', as written by find -print0
+};
+
+// \class ArgumentReader
+// Reads arguments lazily from a file or stream, e.g. for lists of paths too
+// long to fit into argv. Regular files are memory mapped where supported and
+// other sources, like stdin, are read in fixed size chunks, so memory use
+// does not depend on the length of the list and arguments are available
+// before the whole list has been read.
+//
+// \code
+// ArgumentReader paths(parser.get_value("files-from"));
+// for (string_view path : paths) {
+// 	...
+// }
+// \endcode
+class ArgumentReader {
+public:
+	// Size of the chunks read from streams
+	static const std::size_t chunk_size = 64 * 1024;
+
+	// Open file to read arguments from
+	//
+	// \param[in] path   std::string    Path of the file, "-" reads from stdin
+	// \param[in] format ArgumentFormat How arguments are separated
+	//
+	// \throws std::runtime_error if the file can't be opened
+	explicit ArgumentReader(const std::string& path, ArgumentFormat format = ArgumentFormat::line)
+			: ArgumentReader(format) {
+		if (path == "-") {
+			m_file = stdin;
+			return;
+		}
+		if (map(path)) {
+			return;
+		}
+		m_file = std::fopen(path.c_str(), "rb");
+		if (m_file == nullptr) {
+			throw std::runtime_error("Could not open argument file " + path);
+		}
+		m_owns_file = true;
+	}
+
+	// Read arguments from already opened stream, which is not closed
+	//
+	// \param[in] file   std::FILE*     Stream to read from
+	// \param[in] format ArgumentFormat How arguments are separated
+	explicit ArgumentReader(std::FILE* file, ArgumentFormat format = ArgumentFormat::line)
+			: ArgumentReader(format) {
+		m_file = file;
+	}
+
+	ArgumentReader(const ArgumentReader&) = delete;
+	ArgumentReader& operator=(const ArgumentReader&) = delete;
+
+	~ArgumentReader() {
+#if defined(__unix__) || defined(__APPLE__)
+		if (m_mapped) {
+			munmap(const_cast<char*>(m_data), m_size);
+		}
+#endif
+		if (m_owns_file) {
+			std::fclose(m_file);
+		}
+	}
+
+	// Read next argument
+	//
+	// \param[out] arg string_view Argument, valid until the next call
+	//
+	// \return bool False when there are no more arguments
+	// \throws std::runtime_error if reading fails
+	bool next(string_view& arg) {
+		for (;;) {
+			while (m_pos < m_size && is_separator(m_data[m_pos])) {
+				++m_pos;
+			}
+			if (m_pos == m_size) {
+				if (m_eof) {
+					return false;
+				}
+				refill();
+				continue;
+			}
+
+			bool quoted = false;
+			const char* end = m_format == ArgumentFormat::response ?
+					scan_response(m_data + m_pos, m_data + m_size, quoted) :
+					scan_separator(m_data + m_pos, m_data + m_size);
+			if (end == nullptr) {
+				if (!m_eof) {
+					refill();
+					continue;
+				}
+				end = m_data + m_size;
+			}
+
+			const char* first = m_data + m_pos;
+			m_pos = end - m_data;
+			if (quoted) {
+				arg = unquote(first, end);
+			} else if (m_format == ArgumentFormat::line && end[-1] == '\r') {
+				arg = string_view(first, end - first - 1);
+			} else {
+				arg = string_view(first, end - first);
+			}
+			return true;
+		}
+	}
+
+	// \class iterator
+	// Input iterator over the remaining arguments
+	class iterator {
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef string_view value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const string_view* pointer;
+		typedef const string_view& reference;
+
+		iterator() : m_reader(nullptr) {}
+		explicit iterator(ArgumentReader* reader) : m_reader(reader) {
+			++*this;
+		}
+
+		reference operator*() const noexcept {
+			return m_arg;
+		}
+
+		pointer operator->() const noexcept {
+			return &m_arg;
+		}
+
+		iterator& operator++() {
+			if (!m_reader->next(m_arg)) {
+				m_reader = nullptr;
+			}
+			return *this;
+		}
+
+		friend bool operator==(const iterator& a, const iterator& b) noexcept {
+			return a.m_reader == b.m_reader;
+		}
+
+		friend bool operator!=(const iterator& a, const iterator& b) noexcept {
+			return a.m_reader != b.m_reader;
+		}
+
+	private:
+		ArgumentReader* m_reader;
+		string_view m_arg;
+	};
+
+	// Start iterating the remaining arguments
+	//
+	// \return iterator
+	iterator begin() {
+		return iterator(this);
+	}
+
+	// \return iterator
+	iterator end() noexcept {
+		return iterator();
+	}
+
+private:
+	explicit ArgumentReader(ArgumentFormat format)
+			: m_format(format), m_file(nullptr), m_owns_file(false), m_mapped(false), m_data(nullptr), m_size(0),
+			  m_pos(0), m_eof(false) {
+	}
+
+	// Map regular file into memory, false if it should be streamed instead
+	bool map(const std::string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+		struct stat st;
+		bool ok = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+		if (ok && st.st_size == 0) {
+			m_eof = true;
+		} else if (ok) {
+			void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p != MAP_FAILED) {
+#if defined(MADV_SEQUENTIAL)
+				madvise(p, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+#endif
+				m_data = static_cast<const char*>(p);
+				m_size = static_cast<std::size_t>(st.st_size);
+				m_mapped = true;
+				m_eof = true;
+			} else {
+				ok = false;
+			}
+		}
+		close(fd);
+		return ok;
+#else
+		(void) path;
+		return false;
+#endif
+	}
+
+	// Move unread data to the front of the buffer and read the next chunk
+	void refill() {
+		std::size_t left = m_size - m_pos;
+		if (left == m_buffer.size()) {
+			// Single argument longer than the buffer
+			if (m_buffer.empty()) {
+				m_buffer.resize(chunk_size);
+			} else {
+				m_buffer.resize(m_buffer.size() * 2);
+			}
+		} else if (left > 0 && m_pos > 0) {
+			std::memmove(&m_buffer[0], m_data + m_pos, left);
+		}
+		std::size_t n = std::fread(&m_buffer[left], 1, m_buffer.size() - left, m_file);
+		if (n == 0) {
+			if (std::ferror(m_file)) {
+				throw std::runtime_error("Could not read arguments");
+			}
+			m_eof = true;
+		}
+		m_data = m_buffer.data();
+		m_size = left + n;
+		m_pos = 0;
+	}
+
+	bool is_separator(char c) const noexcept {
+		switch (m_format) {
+		case ArgumentFormat::response:
+			return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+		case ArgumentFormat::line:
+			return c == '\n' || c == '\r';
+		default:
+			return c == '\0';
+		}
+	}
+
+	// Find end of line or '\0' separated argument, nullptr if not in the data
+	const char* scan_separator(const char* p, const char* end) const noexcept {
+		return static_cast<const char*>(std::memchr(p, m_format == ArgumentFormat::line ? '\n' : '\0', end - p));
+	}
+
+	// Find end of response file argument, nullptr if not in the data. Quoted
+	// is set if the argument has quotes or escapes to remove.
+	const char* scan_response(const char* p, const char* end, bool& quoted) const noexcept {
+		char quote = '\0';
+		for (; p != end; ++p) {
+			char c = *p;
+			if (quote != '\0') {
+				if (c == quote) {
+					quote = '\0';
+				} else if (c == '\\' && quote == '"' && ++p == end) {
+					break;
+				}
+			} else if (c == '\'' || c == '"') {
+				quote = c;
+				quoted = true;
+			} else if (c == '\\') {
+				quoted = true;
+				if (++p == end) {
+					break;
+				}
+			} else if (is_separator(c)) {
+				return p;
+			}
+		}
+		return nullptr;
+	}
+
+	// Remove quotes and escapes of response file argument into scratch buffer
+	string_view unquote(const char* p, const char* end) {
+		m_scratch.clear();
+		char quote = '\0';
+		for (; p != end; ++p) {
+			char c = *p;
+			if (quote != '\0' && c == quote) {
+				quote = '\0';
+			} else if (quote == '\0' && (c == '\'' || c == '"')) {
+				quote = c;
+			} else if (c == '\\' && quote != '\'' && p + 1 != end) {
+				m_scratch += *++p;
+			} else {
+				m_scratch += c;
+			}
+		}
+		return string_view(m_scratch.data(), m_scratch.size());
+	}
+
+	ArgumentFormat m_format;
+	std::FILE* m_file;
+	bool m_owns_file;
+	bool m_mapped;
+
+	// Unread data is [m_pos, m_size) of m_data, either the mapping or m_buffer
+	const char* m_data;
+	std::size_t m_size;
+	std::size_t m_pos;
+	bool m_eof;
+
+	std::vector<char> m_buffer;
+	std::string m_scratch;
+};
+
+namespace detail {
+
+inline void expand_response_file(const std::string& arg, std::vector<std::string>& tokens, int depth) {
+	if (arg.size() < 2 || arg[0] != '@') {
+		tokens.push_back(arg);
+		return;
+	}
+	if (depth == 0) {
+		throw std::runtime_error("Response files nested too deeply in " + arg);
+	}
+	std::string path = arg.substr(1);
+	std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+	if (!file) {
+		// Like compilers, keep arguments that don't name a file as they are
+		tokens.push_back(arg);
+		return;
+	}
+	ArgumentReader reader(file.get(), ArgumentFormat::response);
+	string_view token;
+	while (reader.next(token)) {
+		expand_response_file(token.to_string(), tokens, depth - 1);
+	}
+}
+
+} // namespace detail
+
+// Replace @file arguments with the arguments read from the file, e.g. for
+// ArgCV(std::vector<std::string>). Response files may refer to other
+// response files and arguments that don't name a file are kept as they are.
+//
+// \param[in] argc      int    Number of arguments
+// \param[in] argv      char** Arguments, the first one is the program name
+// \param[in] max_depth int    Maximum nesting of response files
+//
+// \return std::vector<std::string> Arguments without the program name
+// \throws std::runtime_error if response files are nested too deeply or can't be read
+inline std::vector<std::string> expand_response_files(int argc, char** argv, int max_depth = 16) {
+	std::vector<std::string> tokens;
+	tokens.reserve(argc > 1 ? argc - 1 : 0);
+	for (int i = 1; i < argc; i++) {
+		detail::expand_response_file(argv[i], tokens, max_depth);
+	}
+	return tokens;
+}
+
+} // namespace argcv
+} // namespace cmd
+} // namespace drodil
+
+#endif // CMD_ARGCV_ARGUMENT_READER_HPP_
@@ -0,0 +1,199 @@
+// benchmark.cpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "argcv.hpp"
+#include "argcv_view.hpp"
+#include "argument_reader.hpp"
+#include "config.hpp"
+#include "schema.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <new>
+#include <vector>
+
+using namespace drodil::cmd::argcv;
+
+// Heap allocations made by the process, counted to report allocations per parse.
+// The replacements are kept out of line so GCC does not pair the inlined
+// malloc/free with new/delete expressions and warn about a mismatch.
+static std::atomic<std::size_t> g_allocations(0);
+
+__attribute__((noinline)) void* operator new(std::size_t size) {
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size > 0 ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](std::size_t size) {
+	return ::operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+namespace {
+
+// Options of the benchmarked command line
+constexpr Option options[] = {
+	{"config", OptionType::string, nullptr, true},
+	{"threads", OptionType::integer, "4"},
+	{"verbose", OptionType::flag, nullptr, false, "v"},
+	{"log-level", OptionType::string, "info"},
+	{"listen", OptionType::string, "127.0.0.1:80"},
+	{"queue", OptionType::string, "jobs"},
+	{"timeout", OptionType::unsigned_integer, "60"},
+	{"retry", OptionType::integer, "0"},
+};
+constexpr std::size_t threads_option = option_index(options, "threads");
+
+// Prevents the compiler from optimizing away benchmarked results
+volatile std::size_t g_sink = 0;
+
+// Run fn ops times and report time and allocations per operation
+template<typename Fn>
+void run(const char* name, std::size_t ops, Fn fn) {
+	std::size_t allocations = g_allocations.load(std::memory_order_relaxed);
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < ops; i++) {
+		fn();
+	}
+	auto end = std::chrono::steady_clock::now();
+	allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	std::printf("%-40s %12.1f ns/op %8.2f allocs/op\n", name, ns / ops, static_cast<double>(allocations) / ops);
+}
+
+} // namespace
+
+int main() {
+	// Typical worker command line
+	const char* args[] = {"worker", "--config=/etc/worker/worker.conf", "--threads", "8", "-v", "--log-level",
+			"debug", "--listen=0.0.0.0:8080", "--queue", "jobs.high", "--timeout=30", "--retry", "3", "input.dat"};
+	int argc = static_cast<int>(sizeof(args) / sizeof(args[0]));
+	char** argv = const_cast<char**>(args);
+	const std::size_t ops = 200000;
+
+	run("parse/ArgCV", ops, [&] {
+		ArgCV parser(argc, argv);
+		g_sink += parser.get_args().size();
+	});
+	run("parse/ArgCVView", ops, [&] {
+		ArgCVView parser(argc, argv);
+		g_sink += parser.size();
+	});
+	run("parse/ParsedArgs", ops, [&] {
+		ParsedArgs<8> parser(options, argc, argv);
+		g_sink += parser.ok();
+	});
+
+	ArgCV parser(argc, argv);
+	ArgCVView view(argc, argv);
+	ParsedArgs<8> parsed(options, argc, argv);
+	run("lookup/ArgCV::get_value_as<int>", ops, [&] { g_sink += parser.get_value_as<int>("threads"); });
+	run("lookup/ArgCVView::get_value_as<int>", ops, [&] { g_sink += view.get_value_as<int>("threads"); });
+	run("lookup/ParsedArgs::get_integer", ops, [&] { g_sink += parsed.get_integer(threads_option); });
+
+	// List of paths too long for argv
+	const char* list = "argcv_bench_paths.txt";
+	const std::size_t paths = 500000;
+	{
+		std::ofstream out(list);
+		for (std::size_t i = 0; i < paths; i++) {
+			out << "/srv/data/batch-" << i % 97 << "/input-" << i << ".dat\n";
+		}
+	}
+	run("read/std::getline", 1, [&] {
+		std::ifstream in(list);
+		std::string line;
+		while (std::getline(in, line)) {
+			g_sink += line.size();
+		}
+	});
+	run("read/ArgumentReader (mapped)", 1, [&] {
+		for (string_view path : ArgumentReader(list)) {
+			g_sink += path.size();
+		}
+	});
+	run("read/ArgumentReader (stream)", 1, [&] {
+		std::FILE* in = std::fopen(list, "rb");
+		for (string_view path : ArgumentReader(in)) {
+			g_sink += path.size();
+		}
+		std::fclose(in);
+	});
+	std::remove(list);
+
+	// Large configuration file loaded at every start
+	const char* ini = "argcv_bench_config.ini";
+	const char* snapshot = "argcv_bench_config.snapshot";
+	{
+		std::ofstream out(ini);
+		for (std::size_t section = 0; section < 1000; section++) {
+			out << "[service-" << section << "]\n";
+			for (std::size_t key = 0; key < 100; key++) {
+				out << "option-" << key << " = value of option " << key << " in " << section << "\n";
+			}
+		}
+	}
+	std::remove(snapshot);
+	run("config/load_files", 10, [&] {
+		Config config;
+		config.load_files({ini});
+		g_sink += config.has("service-500.option-50");
+	});
+	{
+		Config config;
+		config.load_files({ini}, snapshot);
+	}
+	run("config/load_files (snapshot)", 10, [&] {
+		Config config;
+		config.load_files({ini}, snapshot);
+		g_sink += config.from_snapshot();
+	});
+	Config config;
+	config.load_files({ini}, snapshot);
+	config.load_args(view);
+	run("config/get_value", ops, [&] { g_sink += config.get_value("service-500.option-50").size(); });
+	std::remove(ini);
+	std::remove(snapshot);
+	return 0;
+}
@@ -0,0 +1,613 @@
+// config.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef CMD_ARGCV_CONFIG_HPP_
+#define CMD_ARGCV_CONFIG_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+extern char** environ;
+#else
+#include <cstdlib>
+#endif
+
+#include "../../general/string/string_view.hpp"
+#include "argcv.hpp"
+#include "argcv_view.hpp"
+
+namespace drodil {
+namespace cmd {
+namespace argcv {
+
+using drodil::general::string::string_view;
+
+namespace detail {
+
+inline string_view trim_blank(string_view str) noexcept {
+	std::size_t first = 0;
+	std::size_t last = str.size();
+	while (first < last && (str[first] == ' ' || str[first] == '\t' || str[first] == '\r')) {
+		++first;
+	}
+	while (last > first && (str[last - 1] == ' ' || str[last - 1] == '\t' || str[last - 1] == '\r')) {
+		--last;
+	}
+	return str.substr(first, last - first);
+}
+
+// Entry of ConfigLayer, offsets point into the string blob of the layer
+struct ConfigEntry {
+	std::uint32_t key_offset;
+	std::uint32_t key_size;
+	std::uint32_t value_offset;
+	std::uint32_t value_size;
+};
+
+// \class ConfigLayer
+// Key value table sorted by key. The same layout is used for the snapshot
+// file, so a mapped snapshot is used as it is without parsing.
+class ConfigLayer {
+public:
+	ConfigLayer() : m_entries(nullptr), m_count(0), m_blob(nullptr), m_blob_size(0) {}
+
+	ConfigLayer(const ConfigLayer&) = delete;
+	ConfigLayer& operator=(const ConfigLayer&) = delete;
+
+	// Build table from pairs, later pairs with the same key override earlier ones
+	//
+	// \param[in] pairs std::vector<std::pair<std::string, std::string>> Keys and values, sorted in place
+	//
+	// \throws std::length_error if the strings don't fit 32-bit offsets
+	void build(std::vector<std::pair<std::string, std::string>>& pairs) {
+		std::stable_sort(pairs.begin(), pairs.end(),
+				[](const std::pair<std::string, std::string>& a, const std::pair<std::string, std::string>& b) {
+					return a.first < b.first;
+				});
+		m_owned_entries.clear();
+		m_owned_blob.clear();
+		for (std::size_t i = 0; i < pairs.size(); i++) {
+			if (i + 1 < pairs.size() && pairs[i + 1].first == pairs[i].first) {
+				continue;
+			}
+			if (m_owned_blob.size() + pairs[i].first.size() + pairs[i].second.size() > UINT32_MAX) {
+				throw std::length_error("Configuration is too large");
+			}
+			ConfigEntry entry;
+			entry.key_offset = static_cast<std::uint32_t>(m_owned_blob.size());
+			entry.key_size = static_cast<std::uint32_t>(pairs[i].first.size());
+			m_owned_blob += pairs[i].first;
+			entry.value_offset = static_cast<std::uint32_t>(m_owned_blob.size());
+			entry.value_size = static_cast<std::uint32_t>(pairs[i].second.size());
+			m_owned_blob += pairs[i].second;
+			m_owned_entries.push_back(entry);
+		}
+		attach(m_owned_entries.data(), m_owned_entries.size(), m_owned_blob.data(), m_owned_blob.size());
+	}
+
+	// Use table stored elsewhere, e.g. in a mapped snapshot
+	void attach(const ConfigEntry* entries, std::size_t count, const char* blob, std::size_t blob_size) noexcept {
+		m_entries = entries;
+		m_count = count;
+		m_blob = blob;
+		m_blob_size = blob_size;
+	}
+
+	// Find value of key
+	//
+	// \param[in]  key   string_view Key to find
+	// \param[out] value string_view Value if found
+	//
+	// \return bool
+	bool find(string_view key, string_view& value) const noexcept {
+		std::size_t first = 0;
+		std::size_t count = m_count;
+		while (count > 0) {
+			std::size_t half = count / 2;
+			if (key_of(first + half) < key) {
+				first += half + 1;
+				count -= half + 1;
+			} else {
+				count = half;
+			}
+		}
+		if (first == m_count || key_of(first) != key) {
+			return false;
+		}
+		value = string_view(m_blob + m_entries[first].value_offset, m_entries[first].value_size);
+		return true;
+	}
+
+	std::size_t size() const noexcept {
+		return m_count;
+	}
+
+	const ConfigEntry* entries() const noexcept {
+		return m_entries;
+	}
+
+	string_view blob() const noexcept {
+		return string_view(m_blob, m_blob_size);
+	}
+
+private:
+	string_view key_of(std::size_t i) const noexcept {
+		return string_view(m_blob + m_entries[i].key_offset, m_entries[i].key_size);
+	}
+
+	std::vector<ConfigEntry> m_owned_entries;
+	std::string m_owned_blob;
+	const ConfigEntry* m_entries;
+	std::size_t m_count;
+	const char* m_blob;
+	std::size_t m_blob_size;
+};
+
+// Header of configuration snapshot file, followed by the sources, the
+// entries and the string blob
+struct SnapshotHeader {
+	char magic[8];
+	std::uint32_t byte_order;
+	std::uint32_t source_count;
+	std::uint32_t entry_count;
+	std::uint32_t blob_size;
+};
+
+// Configuration file the snapshot was compiled from
+struct SnapshotSource {
+	std::int64_t mtime_sec;
+	std::int64_t mtime_nsec;
+	std::uint64_t size;
+	std::uint32_t path_offset;
+	std::uint32_t path_size;
+};
+
+static const char snapshot_magic[8] = {'A', 'R', 'G', 'C', 'V', 'C', 'F', '1'};
+
+// Get modification time and size of file, false if it can't be read
+inline bool stat_source(const std::string& path, SnapshotSource& source) noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) {
+		return false;
+	}
+	source.mtime_sec = static_cast<std::int64_t>(st.st_mtime);
+#if defined(__APPLE__)
+	source.mtime_nsec = static_cast<std::int64_t>(st.st_mtimespec.tv_nsec);
+#else
+	source.mtime_nsec = static_cast<std::int64_t>(st.st_mtim.tv_nsec);
+#endif
+	source.size = static_cast<std::uint64_t>(st.st_size);
+	return true;
+#else
+	(void) path;
+	(void) source;
+	return false;
+#endif
+}
+
+inline char** environment() noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+	return environ;
+#else
+	return _environ;
+#endif
+}
+
+} // namespace detail
+
+// Parse INI formatted text
+//
+// Lines are either "[section]", "key = value" or comments starting with ';'
+// or '#'. Whitespace around keys and values and double quotes around values
+// are removed.
+//
+// \param[in] text string_view Text to parse
+// \param[in] fn   Fn          Called with section, key and value of every entry
+//
+// \throws std::runtime_error with the line number if a line is invalid
+template<typename Fn>
+void parse_ini(string_view text, Fn fn) {
+	if (text.starts_with("\xEF\xBB\xBF")) {
+		text = text.substr(3);
+	}
+	string_view section;
+	for (std::size_t line_number = 1; !text.empty(); line_number++) {
+		std::size_t end = text.find('\n');
+		string_view line = detail::trim_blank(text.substr(0, end));
+		text = end == string_view::npos ? string_view() : text.substr(end + 1);
+		if (line.empty() || line[0] == ';' || line[0] == '#') {
+			continue;
+		}
+		if (line[0] == '[') {
+			if (line[line.size() - 1] != ']') {
+				throw std::runtime_error("Unterminated section on line " + std::to_string(line_number));
+			}
+			section = detail::trim_blank(line.substr(1, line.size() - 2));
+			continue;
+		}
+		std::size_t eq = line.find('=');
+		string_view key = detail::trim_blank(line.substr(0, eq));
+		if (eq == string_view::npos || key.empty()) {
+			throw std::runtime_error("Expected key = value on line " + std::to_string(line_number));
+		}
+		string_view value = detail::trim_blank(line.substr(eq + 1));
+		if (value.size() >= 2 && value[0] == '"' && value[value.size() - 1] == '"') {
+			value = value.substr(1, value.size() - 2);
+		}
+		fn(section, key, value);
+	}
+}
+
+// \class Config
+// Configuration merged from layers where arguments override environment
+// variables, which override configuration files. Values in the files are
+// named "section.key".
+//
+// The files can be compiled into a binary snapshot, which is memory mapped
+// on the next start instead of parsing the files if their modification
+// times and sizes are unchanged.
+//
+// \code
+// Config config;
+// config.load_files({"/etc/app.ini", "app.ini"}, "/var/cache/app/config.snapshot");
+// config.load_env("APP_");
+// config.load_args(ArgCV(argc, argv));
+// int port = config.get_value_as<int>("server.port");
+// \endcode
+class Config {
+public:
+	Config() : m_mapping(nullptr), m_mapping_size(0) {}
+
+	Config(const Config&) = delete;
+	Config& operator=(const Config&) = delete;
+
+	~Config() {
+		unmap();
+	}
+
+	// Load INI files as the lowest layer, later files override earlier ones
+	//
+	// \param[in] paths    std::vector<std::string> Files to load
+	// \param[in] snapshot std::string              Snapshot file to use and update, empty for none
+	//
+	// \throws std::runtime_error if a file can't be read or parsed
+	void load_files(const std::vector<std::string>& paths, const std::string& snapshot = std::string()) {
+		unmap();
+		if (!snapshot.empty() && map_snapshot(paths, snapshot)) {
+			return;
+		}
+
+		// Take times before reading, so changes while reading invalidate the snapshot
+		std::vector<detail::SnapshotSource> sources(paths.size());
+		bool cacheable = !snapshot.empty();
+		for (std::size_t i = 0; i < paths.size(); i++) {
+			cacheable = detail::stat_source(paths[i], sources[i]) && cacheable;
+		}
+
+		std::vector<std::pair<std::string, std::string>> pairs;
+		std::string text;
+		for (const std::string& path : paths) {
+			read_file(path, text);
+			try {
+				parse_ini(string_view(text.data(), text.size()), [&pairs](string_view section, string_view key,
+						string_view value) {
+					std::string name;
+					if (!section.empty()) {
+						name.reserve(section.size() + 1 + key.size());
+						name.append(section.data(), section.size());
+						name += '.';
+					}
+					name.append(key.data(), key.size());
+					pairs.emplace_back(std::move(name), value.to_string());
+				});
+			} catch (const std::runtime_error& e) {
+				throw std::runtime_error(path + ": " + e.what());
+			}
+		}
+		m_files.build(pairs);
+
+		if (cacheable) {
+			write_snapshot(paths, sources, snapshot);
+		}
+	}
+
+	// Load environment variables starting with prefix as the middle layer
+	//
+	// The prefix is removed and the rest is lower cased, with "__" replaced
+	// by '.' and '_' by '-', so APP_SERVER__PORT is "server.port" and
+	// APP_LOG_LEVEL is "log-level".
+	//
+	// \param[in] prefix string_view Prefix of the variables
+	// \param[in] env    char**      Environment, nullptr for the environment of the process
+	void load_env(string_view prefix, char** env = nullptr) {
+		std::vector<std::pair<std::string, std::string>> pairs;
+		for (char** var = env != nullptr ? env : detail::environment(); var != nullptr && *var != nullptr; ++var) {
+			string_view entry(*var);
+			std::size_t eq = entry.find('=');
+			if (eq == string_view::npos || eq <= prefix.size() || !entry.starts_with(prefix)) {
+				continue;
+			}
+			std::string name;
+			for (std::size_t i = prefix.size(); i < eq; i++) {
+				char c = entry[i];
+				if (c == '_' && i + 1 < eq && entry[i + 1] == '_') {
+					name += '.';
+					++i;
+				} else if (c == '_') {
+					name += '-';
+				} else {
+					name += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+				}
+			}
+			pairs.emplace_back(std::move(name), entry.substr(eq + 1).to_string());
+		}
+		m_env.build(pairs);
+	}
+
+	// Load parsed arguments as the highest layer
+	//
+	// \param[in] args ArgCV Parsed arguments
+	void load_args(const ArgCV& args) {
+		std::vector<std::pair<std::string, std::string>> pairs(args.get_args().begin(), args.get_args().end());
+		m_args.build(pairs);
+	}
+
+	// Load parsed arguments as the highest layer
+	//
+	// \param[in] args ArgCVView Parsed arguments
+	void load_args(const ArgCVView& args) {
+		std::vector<std::pair<std::string, std::string>> pairs;
+		pairs.reserve(args.size());
+		for (const ArgView& arg : args) {
+			pairs.emplace_back(arg.key.to_string(), arg.value.to_string());
+		}
+		m_args.build(pairs);
+	}
+
+	// Check if the files were loaded from the snapshot
+	//
+	// \return bool
+	bool from_snapshot() const noexcept {
+		return m_mapping != nullptr;
+	}
+
+	// Check if key is set in any layer
+	//
+	// \param[in] key string_view Key to check
+	//
+	// \return bool
+	bool has(string_view key) const noexcept {
+		string_view value;
+		return find(key, value);
+	}
+
+	// Returns value from the highest layer that has the key
+	//
+	// If key is not set, returns empty string
+	//
+	// \param[in] key string_view Key to get value for
+	//
+	// \return string_view Valid as long as the Config is not modified
+	string_view get_value(string_view key) const noexcept {
+		string_view value;
+		find(key, value);
+		return value;
+	}
+
+	// Get value as number, parsed without allocations
+	//
+	// If key is not set or value is not a valid number, returns zero. Same
+	// conversion as ArgCVView::get_value_as.
+	//
+	// \param[in] key string_view Key to get value for
+	//
+	// \return T
+	template<typename T>
+	typename std::enable_if<detail::is_parsed_number<T>::value, T>::type
+	get_value_as(string_view key) const noexcept {
+		return detail::parse_number<T>(get_value(key));
+	}
+
+	// Get value as user defined format
+	//
+	// \param[in] key string_view Key to get value for
+	//
+	// \return T
+	template<typename T>
+	typename std::enable_if<!detail::is_parsed_number<T>::value, T>::type
+	get_value_as(string_view key) const {
+		return detail::parse_stream<T>(get_value(key));
+	}
+
+private:
+	bool find(string_view key, string_view& value) const noexcept {
+		return m_args.find(key, value) || m_env.find(key, value) || m_files.find(key, value);
+	}
+
+	static void read_file(const std::string& path, std::string& text) {
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if (file == nullptr) {
+			throw std::runtime_error("Could not open config file " + path);
+		}
+		text.clear();
+		char buffer[64 * 1024];
+		std::size_t n;
+		while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+			text.append(buffer, n);
+		}
+		bool failed = std::ferror(file) != 0;
+		std::fclose(file);
+		if (failed) {
+			throw std::runtime_error("Could not read config file " + path);
+		}
+	}
+
+	// Map snapshot if it was compiled from the same, unchanged files
+	bool map_snapshot(const std::vector<std::string>& paths, const std::string& snapshot) {
+#if defined(__unix__) || defined(__APPLE__)
+		int fd = open(snapshot.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+		struct stat st;
+		void* p = MAP_FAILED;
+		if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(detail::SnapshotHeader)) {
+			p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		}
+		close(fd);
+		if (p == MAP_FAILED) {
+			return false;
+		}
+		m_mapping = p;
+		m_mapping_size = static_cast<std::size_t>(st.st_size);
+		if (!attach_snapshot(paths)) {
+			unmap();
+			return false;
+		}
+		return true;
+#else
+		(void) paths;
+		(void) snapshot;
+		return false;
+#endif
+	}
+
+	// Validate mapped snapshot and use its table
+	bool attach_snapshot(const std::vector<std::string>& paths) {
+		const char* data = static_cast<const char*>(m_mapping);
+		detail::SnapshotHeader header;
+		std::memcpy(&header, data, sizeof(header));
+		if (std::memcmp(header.magic, detail::snapshot_magic, sizeof(header.magic)) != 0 || header.byte_order != 1 ||
+				header.source_count != paths.size()) {
+			return false;
+		}
+		std::size_t sources_offset = sizeof(header);
+		std::size_t entries_offset = sources_offset + header.source_count * sizeof(detail::SnapshotSource);
+		std::size_t blob_offset = entries_offset + static_cast<std::size_t>(header.entry_count) * sizeof(detail::ConfigEntry);
+		if (blob_offset + header.blob_size != m_mapping_size) {
+			return false;
+		}
+		string_view blob(data + blob_offset, header.blob_size);
+		const detail::SnapshotSource* sources = reinterpret_cast<const detail::SnapshotSource*>(data + sources_offset);
+		for (std::size_t i = 0; i < paths.size(); i++) {
+			detail::SnapshotSource current;
+			if (static_cast<std::size_t>(sources[i].path_offset) + sources[i].path_size > blob.size() ||
+					blob.substr(sources[i].path_offset, sources[i].path_size) != paths[i] ||
+					!detail::stat_source(paths[i], current) || current.mtime_sec != sources[i].mtime_sec ||
+					current.mtime_nsec != sources[i].mtime_nsec || current.size != sources[i].size) {
+				return false;
+			}
+		}
+		const detail::ConfigEntry* entries = reinterpret_cast<const detail::ConfigEntry*>(data + entries_offset);
+		for (std::size_t i = 0; i < header.entry_count; i++) {
+			if (static_cast<std::size_t>(entries[i].key_offset) + entries[i].key_size > blob.size() ||
+					static_cast<std::size_t>(entries[i].value_offset) + entries[i].value_size > blob.size()) {
+				return false;
+			}
+		}
+		m_files.attach(entries, header.entry_count, blob.data(), blob.size());
+		return true;
+	}
+
+	// Write snapshot of the file layer, replacing the old one atomically.
+	// The snapshot is only a cache, so failures are ignored.
+	void write_snapshot(const std::vector<std::string>& paths, std::vector<detail::SnapshotSource>& sources,
+			const std::string& snapshot) const {
+		string_view blob = m_files.blob();
+		std::size_t blob_size = blob.size();
+		for (std::size_t i = 0; i < paths.size(); i++) {
+			sources[i].path_offset = static_cast<std::uint32_t>(blob_size);
+			sources[i].path_size = static_cast<std::uint32_t>(paths[i].size());
+			blob_size += paths[i].size();
+		}
+		if (blob_size > UINT32_MAX) {
+			return;
+		}
+
+		detail::SnapshotHeader header;
+		std::memcpy(header.magic, detail::snapshot_magic, sizeof(header.magic));
+		header.byte_order = 1;
+		header.source_count = static_cast<std::uint32_t>(sources.size());
+		header.entry_count = static_cast<std::uint32_t>(m_files.size());
+		header.blob_size = static_cast<std::uint32_t>(blob_size);
+
+		std::string tmp = snapshot + ".tmp";
+		std::FILE* file = std::fopen(tmp.c_str(), "wb");
+		if (file == nullptr) {
+			return;
+		}
+		bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+		ok = ok && (sources.empty() ||
+				std::fwrite(sources.data(), sizeof(detail::SnapshotSource), sources.size(), file) == sources.size());
+		ok = ok && (m_files.size() == 0 ||
+				std::fwrite(m_files.entries(), sizeof(detail::ConfigEntry), m_files.size(), file) == m_files.size());
+		ok = ok && std::fwrite(blob.data(), 1, blob.size(), file) == blob.size();
+		for (std::size_t i = 0; ok && i < paths.size(); i++) {
+			ok = std::fwrite(paths[i].data(), 1, paths[i].size(), file) == paths[i].size();
+		}
+		ok = std::fclose(file) == 0 && ok;
+		if (!ok || std::rename(tmp.c_str(), snapshot.c_str()) != 0) {
+			std::remove(tmp.c_str());
+		}
+	}
+
+	void unmap() noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+		if (m_mapping != nullptr) {
+			munmap(m_mapping, m_mapping_size);
+		}
+#endif
+		m_mapping = nullptr;
+		m_mapping_size = 0;
+		m_files.attach(nullptr, 0, nullptr, 0);
+	}
+
+	// Layers from the lowest to the highest
+	detail::ConfigLayer m_files;
+	detail::ConfigLayer m_env;
+	detail::ConfigLayer m_args;
+
+	// Mapped snapshot of m_files, if it was used
+	void* m_mapping;
+	std::size_t m_mapping_size;
+};
+
+} // namespace argcv
+} // namespace cmd
+} // namespace drodil
+
+#endif // CMD_ARGCV_CONFIG_HPP_
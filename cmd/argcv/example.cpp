@@ -23,17 +23,36 @@
 // SOFTWARE.
 
 #include "argcv.hpp"
+#include "argcv_view.hpp"
+#include "argument_reader.hpp"
+#include "config.hpp"
+#include "schema.hpp"
 #include <iostream>
 
 using namespace drodil::cmd::argcv;
 
+// Options understood by the example when validated against a schema
+constexpr Option options[] = {
+	{"threads", OptionType::integer, "4", false, "t"},
+	{"ratio", OptionType::number, "0.5"},
+	{"name", OptionType::string, "example"},
+	{"verbose", OptionType::flag, nullptr, false, "v"},
+	{"files-from", OptionType::string, ""},
+	{"config", OptionType::string, ""},
+};
+constexpr std::size_t threads_option = option_index(options, "threads");
+constexpr std::size_t ratio_option = option_index(options, "ratio");
+constexpr std::size_t name_option = option_index(options, "name");
+constexpr std::size_t verbose_option = option_index(options, "verbose");
+
 int main(int argc, char** argv) {
 	if (argc <= 1) {
 		std::cout << "Pass some parameters to see it work." << std::endl;
 		return 0;
 	}
 
-	ArgCV parser(argc, argv);
+	// Arguments may also come from @file response files
+	ArgCV parser(expand_response_files(argc, argv));
 	auto tokens = parser.get_tokens();
 	std::cout << "Parsed tokens are:" << std::endl;
 	for (const auto& token : tokens) {
@@ -59,6 +78,46 @@ int main(int argc, char** argv) {
 		std::cout << "get_value_as: " << s << " " << typeid(s).name() << std::endl;
 	}
 
+	// Positional arguments listed in a file, or stdin with --files-from=-
+	if (parser.has_arg_with_value("files-from")) {
+		std::size_t count = 0;
+		for (string_view path : ArgumentReader(parser.get_value("files-from"))) {
+			if (count++ < 3) {
+				std::cout << "  file: " << path << std::endl;
+			}
+		}
+		std::cout << "Read " << count << " files from " << parser.get_value("files-from") << std::endl;
+	}
+
+	// Arguments layered over ARGCV_ environment variables and --config=file.ini
+	Config config;
+	if (parser.has_arg_with_value("config")) {
+		config.load_files({parser.get_value("config")}, parser.get_value("config") + ".snapshot");
+		std::cout << "Loaded " << parser.get_value("config") << (config.from_snapshot() ? " from snapshot" : "")
+				<< std::endl;
+	}
+	config.load_env("ARGCV_");
+	config.load_args(parser);
+	std::cout << "Configured name is " << config.get_value("name") << std::endl;
+
+	// Same arguments as views into argv, without copies
+	ArgCVView view(argc, argv);
+	std::cout << std::endl << "Arguments viewed in argv:" << std::endl;
+	for (const ArgView& arg : view) {
+		std::cout << "  " << arg.key << " => " << arg.value << std::endl;
+	}
+
+	// Same arguments validated and converted once against the schema
+	auto parsed = parse_args(options, argc, argv);
+	std::cout << std::endl << "Arguments validated against schema:" << std::endl;
+	for (const ArgumentError& error : parsed.errors()) {
+		std::cout << "  error: " << error.to_string() << std::endl;
+	}
+	std::cout << "  threads => " << parsed.get_integer(threads_option) << std::endl;
+	std::cout << "  ratio => " << parsed.get_number(ratio_option) << std::endl;
+	std::cout << "  name => " << parsed.get_string(name_option) << std::endl;
+	std::cout << "  verbose => " << parsed.get_flag(verbose_option) << std::endl;
+
 	return 1;
 }
 
@@ -0,0 +1,409 @@
+// schema.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef CMD_ARGCV_SCHEMA_HPP_
+#define CMD_ARGCV_SCHEMA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../general/string/number.hpp"
+#include "../../general/string/string_view.hpp"
+
+namespace drodil {
+namespace cmd {
+namespace argcv {
+
+using drodil::general::string::string_view;
+
+// Type of an option value
+enum class OptionType {
+	flag,             // No value, set or not set
+	string,           // Any text
+	integer,          // Signed 64-bit integer
+	unsigned_integer, // Unsigned 64-bit integer
+	number            // Double
+};
+
+// Declaration of a command line option, usable in constant expressions
+//
+// \code
+// constexpr Option options[] = {
+// 	{"threads", OptionType::integer, "4", false, "t"},
+// 	{"config", OptionType::string, nullptr, true},
+// 	{"verbose", OptionType::flag, nullptr, false, "v"},
+// };
+// constexpr std::size_t threads = option_index(options, "threads");
+// \endcode
+struct Option {
+	constexpr Option(const char* name, OptionType type, const char* default_value = nullptr, bool required = false,
+			const char* alias = nullptr)
+			: name(name), type(type), default_value(default_value), required(required), alias(alias) {
+	}
+
+	const char* name;
+	OptionType type;
+	const char* default_value;
+	bool required;
+	const char* alias;
+};
+
+namespace detail {
+
+constexpr bool equal(const char* a, const char* b) {
+	return *a == *b && (*a == '\0' || equal(a + 1, b + 1));
+}
+
+template<std::size_t N>
+constexpr std::size_t option_index(const Option (&options)[N], const char* name, std::size_t i) {
+	return i == N ? throw std::invalid_argument("Unknown option") : equal(options[i].name, name) ? i
+			: option_index(options, name, i + 1);
+}
+
+} // namespace detail
+
+// Find index of option by name, at compile time when used in a constant expression
+//
+// \param[in] options Option[] Declared options
+// \param[in] name    const char* Name of the option
+//
+// \return size_t
+// \throws std::invalid_argument if there's no such option, which fails compilation in constant expressions
+template<std::size_t N>
+constexpr std::size_t option_index(const Option (&options)[N], const char* name) {
+	return detail::option_index(options, name, 0);
+}
+
+// Error found while parsing the command line
+struct ArgumentError {
+	// Index of the offending token in argv, or zero if not related to a token
+	int position;
+
+	// Offset of the first invalid character in the token
+	std::size_t offset;
+
+	// Name of the option
+	std::string option;
+
+	// Description of the error
+	std::string message;
+
+	// Format error for the user
+	//
+	// \return std::string
+	std::string to_string() const {
+		std::string ret;
+		if (position > 0) {
+			ret += "argument " + std::to_string(position);
+			if (offset > 0) {
+				ret += " at " + std::to_string(offset);
+			}
+			ret += ": ";
+		}
+		if (!option.empty()) {
+			ret += "--" + option + ": ";
+		}
+		return ret + message;
+	}
+};
+
+// \class ParsedArgs
+// Command line validated and converted against a schema of N options. Values
+// are accessed with the index of the option in the schema in constant time.
+template<std::size_t N>
+class ParsedArgs {
+public:
+	// Parse and validate arguments, errors are collected to errors()
+	//
+	// \param[in] options Option[] Declared options, must outlive the result
+	// \param[in] argc    int      Number of arguments
+	// \param[in] argv    char**   Arguments, must outlive the result
+	ParsedArgs(const Option (&options)[N], int argc, char** argv)
+			: m_options(options) {
+		for (std::size_t i = 0; i < N; i++) {
+			m_values[i].present = false;
+			m_values[i].position = 0;
+			// Options without a default read as zero of their own type
+			if (options[i].type == OptionType::number) {
+				m_values[i].number = 0;
+			} else if (options[i].type == OptionType::integer) {
+				m_values[i].integer = 0;
+			} else {
+				m_values[i].uinteger = 0;
+			}
+			if (options[i].default_value != nullptr && options[i].type != OptionType::flag) {
+				convert(i, string_view(options[i].default_value), 0, 0);
+				m_values[i].present = false;
+			}
+		}
+		parse(argc, argv);
+		for (std::size_t i = 0; i < N; i++) {
+			if (options[i].required && !m_values[i].present) {
+				add_error(0, 0, i, "required option is missing");
+			}
+		}
+	}
+
+	// Check if the command line was valid
+	//
+	// \return bool
+	bool ok() const noexcept {
+		return m_errors.empty();
+	}
+
+	// Get errors in the order they were found
+	//
+	// \return const std::vector<ArgumentError>&
+	const std::vector<ArgumentError>& errors() const noexcept {
+		return m_errors;
+	}
+
+	// Get tokens that are not options or their values
+	//
+	// \return const std::vector<string_view>&
+	const std::vector<string_view>& positionals() const noexcept {
+		return m_positionals;
+	}
+
+	// Check if the option was given on the command line
+	//
+	// \param[in] index size_t Index of the option
+	//
+	// \return bool
+	bool has(std::size_t index) const noexcept {
+		return m_values[index].present;
+	}
+
+	// Get index in argv of the option, zero if it was not given
+	//
+	// \param[in] index size_t Index of the option
+	//
+	// \return int
+	int position(std::size_t index) const noexcept {
+		return m_values[index].position;
+	}
+
+	// Get flag option
+	//
+	// \param[in] index size_t Index of the option
+	//
+	// \return bool
+	// \throws std::invalid_argument if the option is not a flag
+	bool get_flag(std::size_t index) const {
+		check(index, OptionType::flag);
+		return m_values[index].present;
+	}
+
+	// Get value of string option, or its default
+	//
+	// \param[in] index size_t Index of the option
+	//
+	// \return string_view View into argv or the default value
+	// \throws std::invalid_argument if the option is not a string
+	string_view get_string(std::size_t index) const {
+		check(index, OptionType::string);
+		return m_values[index].text;
+	}
+
+	// Get value of integer option, or its default
+	//
+	// \param[in] index size_t Index of the option
+	//
+	// \return std::int64_t
+	// \throws std::invalid_argument if the option is not an integer
+	std::int64_t get_integer(std::size_t index) const {
+		check(index, OptionType::integer);
+		return m_values[index].integer;
+	}
+
+	// Get value of unsigned option, or its default
+	//
+	// \param[in] index size_t Index of the option
+	//
+	// \return std::uint64_t
+	// \throws std::invalid_argument if the option is not unsigned
+	std::uint64_t get_unsigned(std::size_t index) const {
+		check(index, OptionType::unsigned_integer);
+		return m_values[index].uinteger;
+	}
+
+	// Get value of number option, or its default
+	//
+	// \param[in] index size_t Index of the option
+	//
+	// \return double
+	// \throws std::invalid_argument if the option is not a number
+	double get_number(std::size_t index) const {
+		check(index, OptionType::number);
+		return m_values[index].number;
+	}
+
+private:
+	struct Value {
+		bool present;
+		int position;
+		string_view text;
+		union {
+			std::int64_t integer;
+			std::uint64_t uinteger;
+			double number;
+		};
+	};
+
+	void parse(int argc, char** argv) {
+		bool options_done = false;
+		for (int i = 1; i < argc; i++) {
+			string_view token(argv[i]);
+			if (options_done || token.size() < 2 || token[0] != '-') {
+				m_positionals.push_back(token);
+				continue;
+			}
+			if (token == "--") {
+				options_done = true;
+				continue;
+			}
+			std::size_t start = token.starts_with("--") ? 2 : 1;
+			string_view key = token.substr(start);
+			std::size_t eq = key.find('=');
+			if (eq != string_view::npos) {
+				key = key.substr(0, eq);
+			}
+
+			std::size_t index = find(key);
+			if (index == N) {
+				add_error(i, start, N, "unknown option '" + key.to_string() + "'");
+				continue;
+			}
+			Value& value = m_values[index];
+			value.present = true;
+			value.position = i;
+			if (m_options[index].type == OptionType::flag) {
+				if (eq != string_view::npos) {
+					add_error(i, start + eq, index, "flag does not take a value");
+				}
+				continue;
+			}
+			if (eq != string_view::npos) {
+				convert(index, token.substr(start + eq + 1), i, start + eq + 1);
+			} else if (i + 1 < argc) {
+				++i;
+				convert(index, string_view(argv[i]), i, 0);
+			} else {
+				add_error(i, 0, index, "missing value");
+			}
+		}
+	}
+
+	std::size_t find(string_view key) const noexcept {
+		for (std::size_t i = 0; i < N; i++) {
+			if (matches(key, m_options[i].name) || (m_options[i].alias != nullptr && matches(key, m_options[i].alias))) {
+				return i;
+			}
+		}
+		return N;
+	}
+
+	// Compare without measuring the name first, most names differ in the first characters
+	static bool matches(string_view key, const char* name) noexcept {
+		std::size_t i = 0;
+		for (; i < key.size(); i++) {
+			if (name[i] != key[i]) {
+				return false;
+			}
+		}
+		return name[i] == '\0';
+	}
+
+	// Convert text to the type of the option, reporting errors at the token offset
+	void convert(std::size_t index, string_view text, int position, std::size_t offset) {
+		using drodil::general::string::from_chars;
+		Value& value = m_values[index];
+		value.text = text;
+		const char* first = text.data();
+		const char* last = first + text.size();
+		drodil::general::string::from_chars_result result{last, std::errc()};
+		const char* kind = nullptr;
+		switch (m_options[index].type) {
+		case OptionType::integer:
+			result = from_chars(first, last, value.integer);
+			kind = "integer";
+			break;
+		case OptionType::unsigned_integer:
+			result = from_chars(first, last, value.uinteger);
+			kind = "unsigned integer";
+			break;
+		case OptionType::number:
+			result = from_chars(first, last, value.number);
+			kind = "number";
+			break;
+		default:
+			return;
+		}
+		if (text.empty() || result.ec != std::errc() || result.ptr != last) {
+			std::size_t at = offset + static_cast<std::size_t>((result.ec == std::errc() ? result.ptr : first) - first);
+			std::string message = result.ec == std::errc::result_out_of_range ? "value is out of range" :
+					"invalid " + std::string(kind) + " '" + text.to_string() + "'";
+			if (position == 0) {
+				message = "default value: " + message;
+			}
+			add_error(position, at, index, message);
+		}
+	}
+
+	void check(std::size_t index, OptionType type) const {
+		if (index >= N || m_options[index].type != type) {
+			throw std::invalid_argument("Option is not of the requested type");
+		}
+	}
+
+	void add_error(int position, std::size_t offset, std::size_t index, std::string message) {
+		m_errors.push_back(ArgumentError{position, offset, index < N ? m_options[index].name : "",
+				std::move(message)});
+	}
+
+	const Option* m_options;
+	Value m_values[N];
+	std::vector<string_view> m_positionals;
+	std::vector<ArgumentError> m_errors;
+};
+
+// Parse command line against declared options
+//
+// \param[in] options Option[] Declared options, must outlive the result
+// \param[in] argc    int      Number of arguments
+// \param[in] argv    char**   Arguments, must outlive the result
+//
+// \return ParsedArgs
+template<std::size_t N>
+ParsedArgs<N> parse_args(const Option (&options)[N], int argc, char** argv) {
+	return ParsedArgs<N>(options, argc, argv);
+}
+
+} // namespace argcv
+} // namespace cmd
+} // namespace drodil
+
+#endif // CMD_ARGCV_SCHEMA_HPP_
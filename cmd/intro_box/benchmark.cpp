@@ -0,0 +1,174 @@
+// benchmark.cpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "intro_box.hpp"
+#include "live_box.hpp"
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace drodil::cmd::intro_box;
+
+namespace {
+
+// Prevents the compiler from optimizing away benchmarked results
+volatile std::size_t g_sink = 0;
+
+// Run fn ops times and report time per operation and throughput
+template<typename Fn>
+void run(const char* name, std::size_t ops, std::size_t bytes, Fn fn) {
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < ops; i++) {
+		fn();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	std::printf("%-32s %12.1f ns/op %10.1f MB/s\n", name, ns / ops, bytes * ops / (ns / 1e9) / 1e6);
+}
+
+// Rendering of IntroBox before it was done in a single pass, for comparison
+std::string append_to_string(const std::string& content, unsigned short box_width, unsigned short border_width,
+		unsigned short padding) {
+	std::string str;
+	for (unsigned short i = 0; i < border_width; i++) {
+		str += std::string(box_width, '*') + "\n";
+	}
+	for (unsigned short i = 0; i < padding; i++) {
+		str += std::string(border_width, '*');
+		str += std::string(box_width - 2 * border_width, ' ');
+		str += std::string(border_width, '*') + "\n";
+	}
+	std::stringstream ss(content);
+	std::string line;
+	unsigned short max_line_length = box_width - ((border_width * 2) + (padding * 2));
+	while (std::getline(ss, line, '\n')) {
+		do {
+			str += std::string(border_width, '*');
+			str += std::string(padding, ' ');
+			std::string substr = line.substr(0, max_line_length);
+			str += substr;
+			line.erase(0, substr.length());
+			unsigned short r_padding = box_width - substr.length() - padding - (border_width * 2);
+			str += std::string(r_padding, ' ');
+			str += std::string(border_width, '*') + "\n";
+		} while (line.length() > 0);
+	}
+	for (unsigned short i = 0; i < padding; i++) {
+		str += std::string(border_width, '*');
+		str += std::string(box_width - 2 * border_width, ' ');
+		str += std::string(border_width, '*') + "\n";
+	}
+	for (unsigned short i = 0; i < border_width; i++) {
+		str += std::string(box_width, '*') + "\n";
+	}
+	return str;
+}
+
+// Help text like content with lines of varying length
+std::string make_content(std::size_t lines) {
+	std::string content;
+	for (std::size_t i = 0; i < lines; i++) {
+		content += "--option-" + std::to_string(i) + "  ";
+		content += std::string(10 + (i * 37) % 140, 'a' + static_cast<char>(i % 26));
+		content += '\n';
+	}
+	return content;
+}
+
+} // namespace
+
+int main() {
+	struct Case {
+		const char* name;
+		std::size_t lines;
+		std::size_t ops;
+	};
+	const Case cases[] = {{"small", 10, 100000}, {"large", 10000, 100}};
+
+	for (const Case& c : cases) {
+		std::string content = make_content(c.lines);
+		IntroBox box(content);
+		box.set_border_width(2);
+		box.set_wrap_mode(WrapMode::character);
+		std::size_t size = box.rendered_size();
+		if (append_to_string(content, 80, 2, 1) != box.to_string()) {
+			std::printf("%s: rendering differs from the appending implementation\n", c.name);
+			return 1;
+		}
+		std::printf("%s box, %zu lines, %zu bytes\n", c.name, c.lines, size);
+
+		run("  appending to_string", c.ops, size, [&] { g_sink += append_to_string(content, 80, 2, 1).size(); });
+		run("  to_string", c.ops, size, [&] { g_sink += box.to_string().size(); });
+		std::vector<char> buffer(size);
+		run("  render into buffer", c.ops, size, [&] { g_sink += box.render(buffer.data()); });
+		std::ostringstream os;
+		run("  write_to(std::ostream&)", c.ops, size, [&] {
+			os.str(std::string());
+			box.write_to(os);
+			g_sink += static_cast<std::size_t>(os.tellp());
+		});
+
+		// Layout after every change, the above only render the laid out rows
+		const WrapMode modes[] = {WrapMode::character, WrapMode::greedy, WrapMode::balanced};
+		const char* names[] = {"  relayout character", "  relayout greedy", "  relayout balanced"};
+		for (std::size_t i = 0; i < 3; i++) {
+			run(names[i], c.ops, size, [&] {
+				box.set_wrap_mode(modes[i]);
+				g_sink += box.rendered_size();
+			});
+		}
+	}
+
+	// Status panel of jobs making progress, drawn as full frames and as changes
+	const std::size_t frames = 10000;
+	auto status = [](std::size_t frame) {
+		std::string content = "Running jobs\n\n";
+		for (std::size_t job = 0; job < 10; job++) {
+			std::size_t progress = (frame * (job + 1) / 7) % 101;
+			content += "job-" + std::to_string(job) + "  [" + std::string(progress / 5, '#')
+					+ std::string(20 - progress / 5, ' ') + "] " + std::to_string(progress) + "%\n";
+		}
+		return content;
+	};
+	std::size_t full_bytes = 0;
+	std::size_t frame = 0;
+	IntroBox full(status(0));
+	run("status/full redraw", frames, full.rendered_size(), [&] {
+		full.set_content(status(frame++));
+		std::size_t size = full.to_string().size();
+		full_bytes += size;
+		g_sink += size;
+	});
+	LiveBox live(IntroBox(status(0)), 0);
+	frame = 0;
+	run("status/LiveBox", frames, full.rendered_size(), [&] {
+		live.set_content(status(frame++));
+		live.update();
+		g_sink += live.frame().size();
+	});
+	std::printf("status bytes/frame: full redraw %.1f, LiveBox %.1f\n", static_cast<double>(full_bytes) / frames,
+			static_cast<double>(live.bytes()) / live.frames());
+	return 0;
+}
@@ -23,6 +23,9 @@
 // SOFTWARE.
 
 #include "intro_box.hpp"
+#include "live_box.hpp"
+#include <chrono>
+#include <thread>
 #include <iostream>
 
 using namespace drodil::cmd::intro_box;
@@ -43,5 +46,27 @@ int main() {
 	box.set_border_width(2);
 	std::cout << box << std::endl;
 
+	// Long lines are wrapped at spaces and measured in terminal columns
+	IntroBox wrapped("Lines longer than the box are broken at spaces, and wide "
+			"characters like \xe4\xb8\xad\xe6\x96\x87 or \xf0\x9f\x98\x80 take two columns.");
+	wrapped.set_box_width(40);
+	wrapped.set_wrap_mode(WrapMode::balanced);
+	std::cout << wrapped << std::endl;
+
+	// Status box redrawn in place, writing only what changed
+	LiveBox live(IntroBox("", '#'), 30);
+	std::size_t full_bytes = 0;
+	for (int progress = 0; progress <= 100; progress += 2) {
+		std::string status = "Progress [" + std::string(progress / 5, '=') + std::string(20 - progress / 5, ' ')
+				+ "] " + std::to_string(progress) + "%";
+		live.set_content(status);
+		if (live.present(std::cout, progress == 100) > 0) {
+			full_bytes += IntroBox(status, '#').rendered_size();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	std::cout << live.frames() << " frames took " << live.bytes() << " bytes instead of " << full_bytes
+			<< " bytes for full redraws" << std::endl;
+
 	return 0;
 }
@@ -29,6 +29,16 @@
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
+#include <cstring>
+#include <ostream>
+#include <memory>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include "text_layout.hpp"
 
 namespace drodil {
 namespace cmd {
@@ -48,7 +58,8 @@ public:
 	noexcept :
 m_content			(content), m_ver_border_char(border_char), m_hor_border_char(
 					border_char), m_border_width(1), m_box_width(80), m_split_char(
-					'\n'), m_padding(1) {
+					'\n'), m_padding(1), m_wrap_mode(WrapMode::greedy) {
+				update_layout();
 			}
 
 			// Set character for vertical borders
@@ -83,6 +94,7 @@ m_content			(content), m_ver_border_char(border_char), m_hor_border_char(
 							split_char);
 				}
 				m_split_char = split_char;
+				update_layout();
 			}
 
 			// Set padding of the box
@@ -96,6 +108,7 @@ m_content			(content), m_ver_border_char(border_char), m_hor_border_char(
 							"Too large padding - no space for content");
 				}
 				m_padding = padding;
+				update_layout();
 			}
 
 			// Set content for this intro box
@@ -105,6 +118,7 @@ m_content			(content), m_ver_border_char(border_char), m_hor_border_char(
 			// \return void
 			void set_content(const std::string& content) noexcept {
 				m_content = content;
+				update_layout();
 			}
 
 			// Set border width in characters
@@ -119,6 +133,7 @@ m_content			(content), m_ver_border_char(border_char), m_hor_border_char(
 							"Too large border width - no space for content");
 				}
 				m_border_width = border_width;
+				update_layout();
 			}
 
 			// Set box width in characters
@@ -134,83 +149,179 @@ m_content			(content), m_ver_border_char(border_char), m_hor_border_char(
 				}
 
 				m_box_width = box_width;
+				update_layout();
 			}
 
-			// Return string presentation of the box
+			// Set how lines longer than the box are wrapped
 			//
-			// \return std::string
-			std::string to_string() const noexcept {
-				std::string str;
+			// Default is WrapMode::greedy, breaking lines at spaces
+			//
+			// \param[in] wrap_mode WrapMode How to wrap long lines
+			//
+			// \return void
+			void set_wrap_mode(WrapMode wrap_mode) noexcept {
+				m_wrap_mode = wrap_mode;
+				update_layout();
+			}
+
+			// Get exact number of characters the rendered box takes
+			//
+			// \return std::size_t
+			std::size_t rendered_size() const noexcept {
+				const std::vector<LayoutRow>& rows = m_layout.rows();
+				const std::size_t max_line_width = line_capacity();
+
+				// Every row takes the box width, except for the bytes of
+				// multi-byte characters and characters too wide for the box
+				std::size_t size = ((m_border_width * 2) + (m_padding * 2) + rows.size())
+						* (static_cast<std::size_t>(m_box_width) + 1);
+				for (const LayoutRow& row : rows) {
+					size += row.length - std::min(row.width, max_line_width);
+				}
+				return size;
+			}
+
+			// Render the box into buffer in a single pass
+			//
+			// \param[out] out char* Buffer of at least rendered_size() characters
+			//
+			// \return std::size_t Number of characters written
+			std::size_t render(char* out) const noexcept {
+				char* const begin = out;
+				const std::size_t inner_width = m_box_width - (m_border_width * 2);
+				const std::size_t max_line_width = line_capacity();
+
 				// Box upper border
-				for(unsigned short i = 0; i < m_border_width; i++) {
-					str += std::string(m_box_width, m_hor_border_char) + "\n";
+				for (unsigned short i = 0; i < m_border_width; i++) {
+					out = fill(out, m_hor_border_char, m_box_width);
+					*out++ = '\n';
 				}
 
 				// Upper padding
-				for(unsigned short i = 0; i < m_padding; i++) {
-					// Upper padding left boreder
-					str += std::string(m_border_width, m_ver_border_char);
-					str += std::string(m_box_width - 2*m_border_width, ' ');
-					str += std::string(m_border_width, m_ver_border_char) + "\n";
+				for (unsigned short i = 0; i < m_padding; i++) {
+					out = fill(out, m_ver_border_char, m_border_width);
+					out = fill(out, ' ', inner_width);
+					out = fill(out, m_ver_border_char, m_border_width);
+					*out++ = '\n';
 				}
 
-				// Loop content
-				std::stringstream ss(m_content);
-				std::string line;
-				std::vector<std::string> lines;
-				unsigned short max_line_length = m_box_width - ((m_border_width*2) + (m_padding*2));
-
-				while(std::getline(ss, line, m_split_char)) {
-					// Handle line breaks
-					do {
-						// Box left border
-						str += std::string(m_border_width, m_ver_border_char);
-
-						// Left padding
-						str += std::string(m_padding, ' ');
-
-						// todo: Word-break from space or other character
-						std::string substr = line.substr(0, max_line_length);
-						str += substr;
-						line.erase(0, substr.length());
-
-						unsigned short r_padding = m_box_width - substr.length() - m_padding - (m_border_width * 2);
-						// Right padding
-						str += std::string(r_padding, ' ');
-
-						// Box right border
-						str += std::string(m_border_width, m_ver_border_char) + "\n";
-					}while(line.length() > 0);
+				// Content rows
+				for (const LayoutRow& row : m_layout.rows()) {
+					out = fill(out, m_ver_border_char, m_border_width);
+					out = fill(out, ' ', m_padding);
+					std::memcpy(out, m_content.data() + row.offset, row.length);
+					out += row.length;
+					out = fill(out, ' ', inner_width - m_padding - std::min(row.width, max_line_width));
+					out = fill(out, m_ver_border_char, m_border_width);
+					*out++ = '\n';
 				}
 
 				// Bottom padding
-				for(unsigned short i = 0; i < m_padding; i++) {
-					// Bottom padding left border
-					str += std::string(m_border_width, m_ver_border_char);
-					str += std::string(m_box_width - 2*m_border_width, ' ');
-					// Bottom padding right border
-					str += std::string(m_border_width, m_ver_border_char) + "\n";
+				for (unsigned short i = 0; i < m_padding; i++) {
+					out = fill(out, m_ver_border_char, m_border_width);
+					out = fill(out, ' ', inner_width);
+					out = fill(out, m_ver_border_char, m_border_width);
+					*out++ = '\n';
 				}
 
 				// Box bottom border
-				for(unsigned short i = 0; i < m_border_width; i++) {
-					str += std::string(m_box_width, m_hor_border_char) + "\n";
+				for (unsigned short i = 0; i < m_border_width; i++) {
+					out = fill(out, m_hor_border_char, m_box_width);
+					*out++ = '\n';
+				}
+				return static_cast<std::size_t>(out - begin);
+			}
+
+			// Return string presentation of the box
+			//
+			// \return std::string
+			std::string to_string() const {
+				std::string str(rendered_size(), '\0');
+				if (!str.empty()) {
+					render(&str[0]);
 				}
 				return str;
 			}
 
+			// Write box to output stream with a single write
+			//
+			// \param[in|out] os std::ostream Target stream
+			//
+			// \return std::ostream&
+			std::ostream& write_to(std::ostream& os) const {
+				with_rendered([&os](const char* data, std::size_t size) {
+					os.write(data, static_cast<std::streamsize>(size));
+				});
+				return os;
+			}
+
+#if defined(__unix__) || defined(__APPLE__)
+			// Write box to file descriptor, with a single write() unless it is partial
+			//
+			// \param[in] fd int File descriptor to write to
+			//
+			// \return void
+			// \throws std::runtime_error if writing fails
+			void write_to(int fd) const {
+				with_rendered([fd](const char* data, std::size_t size) {
+					while (size > 0) {
+						ssize_t r = ::write(fd, data, size);
+						if (r < 0) {
+							if (errno == EINTR) {
+								continue;
+							}
+							throw std::runtime_error("Could not write to file descriptor");
+						}
+						data += r;
+						size -= static_cast<std::size_t>(r);
+					}
+				});
+			}
+#endif
+
 			// Output box to output stream
 			//
-			// \param[in|out] os  std::ostream Target steram
+			// \param[in|out] os  std::ostream Target steram
 			// \param[in]     box IntroBox     IntroBox to output
 			//
 			// \return std::ostream
 			friend std::ostream& operator<<(std::ostream& os, const IntroBox& box) {
-				os << box.to_string();
-				return os;
+				return box.write_to(os);
 			}
 
 		private:
+			// Boxes up to this size are rendered on the stack
+			static const std::size_t stack_render_size = 4096;
+
+			// Lay out the content again after a change. Done eagerly so that
+			// the const rendering functions only read and are thread-safe.
+			void update_layout() {
+				m_layout.layout(m_content.data(), m_content.size(), m_split_char, line_capacity(), m_wrap_mode);
+			}
+
+			// Number of content columns that fit on a row
+			std::size_t line_capacity() const noexcept {
+				return m_box_width - ((m_border_width * 2) + (m_padding * 2));
+			}
+
+			// Render into stack or heap buffer and pass it to fn
+			template<typename Fn>
+			void with_rendered(Fn fn) const {
+				std::size_t size = rendered_size();
+				if (size <= stack_render_size) {
+					char buffer[stack_render_size];
+					fn(buffer, render(buffer));
+				} else {
+					std::unique_ptr<char[]> buffer(new char[size]);
+					fn(buffer.get(), render(buffer.get()));
+				}
+			}
+
+			static char* fill(char* out, char c, std::size_t count) noexcept {
+				std::memset(out, c, count);
+				return out + count;
+			}
+
 			std::string m_content;
 			char m_ver_border_char;
 			char m_hor_border_char;
@@ -218,6 +329,10 @@ m_content			(content), m_ver_border_char(border_char), m_hor_border_char(
 			unsigned short m_border_width;
 			unsigned short m_box_width;
 			unsigned short m_padding;
+			WrapMode m_wrap_mode;
+
+			// Rows of the content, updated by every change that affects them
+			TextLayout m_layout;
 		};
 
 	}
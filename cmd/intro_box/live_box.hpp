@@ -0,0 +1,375 @@
+// live_box.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef INTRO_BOX_LIVE_BOX_HPP_
+#define INTRO_BOX_LIVE_BOX_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include "../../general/string/number.hpp"
+#include "../../general/string/string_view.hpp"
+#include "../../general/string/utf8.hpp"
+#include "intro_box.hpp"
+
+namespace drodil {
+namespace cmd {
+namespace intro_box {
+
+using drodil::general::string::string_view;
+
+// \class LiveBox
+// IntroBox that is redrawn in place, e.g. for status panels updated many
+// times per second. The previous frame is kept and only the changed parts
+// of its rows are written, using relative ANSI cursor movements so the box
+// can be anywhere on the screen. Every frame is written with a single write
+// and frames are limited to the given rate.
+//
+// The box is drawn at the cursor and the cursor is left on the line below
+// it. Call invalidate() if something else is written to the terminal, to
+// draw the next frame in full.
+//
+// \code
+// LiveBox live(IntroBox(""), 20);
+// while (running) {
+// 	live.set_content(status());
+// 	live.present(STDOUT_FILENO);
+// }
+// live.present(STDOUT_FILENO, true);
+// \endcode
+class LiveBox {
+public:
+	// Unchanged text shorter than this is rewritten rather than skipped
+	// with a cursor movement, which takes about as many bytes
+	static const std::size_t min_skip = 8;
+
+	// Constructor
+	//
+	// \param[in] box     IntroBox Box with the initial content and styling
+	// \param[in] max_fps unsigned Maximum frames per second, 0 for unlimited
+	explicit LiveBox(const IntroBox& box, unsigned max_fps = 30)
+			: m_box(box), m_interval(max_fps > 0 ? std::chrono::steady_clock::duration(
+					std::chrono::seconds(1)) / max_fps : std::chrono::steady_clock::duration::zero()), m_drawn(false),
+			  m_dirty(true), m_row(0), m_column(0), m_last_frame(), m_frames(0), m_bytes(0) {
+	}
+
+	// Get the box to change its styling, which is shown with the next frame
+	//
+	// \return IntroBox&
+	IntroBox& box() noexcept {
+		m_dirty = true;
+		return m_box;
+	}
+
+	// Set content shown with the next frame
+	//
+	// \param[in] content std::string Content of the box
+	//
+	// \return void
+	void set_content(const std::string& content) {
+		m_box.set_content(content);
+		m_dirty = true;
+	}
+
+	// Draw the next frame in full, e.g. after other output
+	//
+	// \return void
+	void invalidate() noexcept {
+		m_drawn = false;
+		m_dirty = true;
+	}
+
+	// Prepare the changes since the last frame, available from frame()
+	//
+	// \param[in] now   time_point Current time
+	// \param[in] force bool       Ignore the frame rate limit
+	//
+	// \return bool False if nothing changed or the last frame was too recent
+	bool update(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now(), bool force = false) {
+		m_out.clear();
+		if (!m_dirty || (!force && m_frames > 0 && now - m_last_frame < m_interval)) {
+			return false;
+		}
+		m_next.resize(m_box.rendered_size());
+		m_box.render(&m_next[0]);
+		if (!m_drawn || row_count(m_next) != row_count(m_current)) {
+			redraw();
+		} else {
+			diff();
+		}
+		m_current.swap(m_next);
+		m_drawn = true;
+		m_dirty = false;
+		m_last_frame = now;
+		++m_frames;
+		m_bytes += m_out.size();
+		return !m_out.empty();
+	}
+
+	// Get output of the last update()
+	//
+	// \return string_view Text and ANSI escape sequences
+	string_view frame() const noexcept {
+		return string_view(m_out.data(), m_out.size());
+	}
+
+	// Write changes since the last frame to stream, if a frame is due
+	//
+	// \param[in|out] os    std::ostream Terminal stream
+	// \param[in]     force bool         Ignore the frame rate limit
+	//
+	// \return std::size_t Number of bytes written
+	std::size_t present(std::ostream& os, bool force = false) {
+		if (!update(std::chrono::steady_clock::now(), force)) {
+			return 0;
+		}
+		os.write(m_out.data(), static_cast<std::streamsize>(m_out.size()));
+		os.flush();
+		return m_out.size();
+	}
+
+#if defined(__unix__) || defined(__APPLE__)
+	// Write changes since the last frame to file descriptor, if a frame is due
+	//
+	// \param[in] fd    int  Terminal file descriptor
+	// \param[in] force bool Ignore the frame rate limit
+	//
+	// \return std::size_t Number of bytes written
+	// \throws std::runtime_error if writing fails
+	std::size_t present(int fd, bool force = false) {
+		if (!update(std::chrono::steady_clock::now(), force)) {
+			return 0;
+		}
+		const char* data = m_out.data();
+		std::size_t size = m_out.size();
+		while (size > 0) {
+			ssize_t r = ::write(fd, data, size);
+			if (r < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::runtime_error("Could not write to file descriptor");
+			}
+			data += r;
+			size -= static_cast<std::size_t>(r);
+		}
+		return m_out.size();
+	}
+#endif
+
+	// Get number of frames drawn
+	//
+	// \return std::size_t
+	std::size_t frames() const noexcept {
+		return m_frames;
+	}
+
+	// Get number of bytes of all frames drawn
+	//
+	// \return std::size_t
+	std::size_t bytes() const noexcept {
+		return m_bytes;
+	}
+
+private:
+	static std::size_t row_count(const std::string& frame) noexcept {
+		std::size_t rows = 0;
+		for (const char* p = frame.data(), *end = p + frame.size();
+				(p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr; ++p) {
+			++rows;
+		}
+		return rows;
+	}
+
+	// Append cursor movement ESC [ count code
+	void move(std::size_t count, char code) {
+		char buffer[24];
+		buffer[0] = '\x1b';
+		buffer[1] = '[';
+		char* end = drodil::general::string::to_chars(buffer + 2, buffer + sizeof(buffer) - 1, count).ptr;
+		*end++ = code;
+		m_out.append(buffer, end - buffer);
+	}
+
+	// Move cursor from the current row and column to the given ones
+	void move_to(std::size_t row, std::size_t column) {
+		if (row < m_row) {
+			move(m_row - row, 'A');
+		} else if (row > m_row) {
+			move(row - m_row, 'B');
+		}
+		if (column == 0 && m_column != 0) {
+			m_out += '\r';
+		} else if (column > m_column) {
+			move(column - m_column, 'C');
+		} else if (column < m_column) {
+			move(m_column - column, 'D');
+		}
+		m_row = row;
+		m_column = column;
+	}
+
+	// Write the whole frame over the previous one, clearing lines left below
+	void redraw() {
+		if (m_drawn) {
+			std::size_t rows = row_count(m_current);
+			if (rows > 0) {
+				move(rows, 'A');
+			}
+			m_out += '\r';
+		}
+		m_out += m_next;
+		if (m_drawn && row_count(m_next) < row_count(m_current)) {
+			m_out += "\x1b[J";
+		}
+	}
+
+	// Write the changed parts of every row. The box width is fixed, so the
+	// rows of both frames take the same number of columns.
+	void diff() {
+		std::size_t rows = row_count(m_current);
+		m_row = rows;
+		m_column = 0;
+		const char* old_row = m_current.data();
+		const char* new_row = m_next.data();
+		for (std::size_t row = 0; row < rows; row++) {
+			const char* old_end = static_cast<const char*>(std::memchr(old_row, '\n',
+					m_current.data() + m_current.size() - old_row));
+			const char* new_end = static_cast<const char*>(std::memchr(new_row, '\n',
+					m_next.data() + m_next.size() - new_row));
+			diff_row(row, string_view(old_row, old_end - old_row), string_view(new_row, new_end - new_row));
+			old_row = old_end + 1;
+			new_row = new_end + 1;
+		}
+		if (m_row != rows || m_column != 0) {
+			move_to(rows, 0);
+		}
+	}
+
+	void diff_row(std::size_t row, string_view old_row, string_view new_row) {
+		namespace utf8 = drodil::general::string::utf8;
+		if (old_row == new_row) {
+			return;
+		}
+
+		// Common prefix and suffix, kept at character boundaries
+		std::size_t prefix = 0;
+		std::size_t max_common = std::min(old_row.size(), new_row.size());
+		while (prefix < max_common && old_row[prefix] == new_row[prefix]) {
+			++prefix;
+		}
+		while (prefix > 0 && (static_cast<unsigned char>(new_row[prefix]) & 0xC0) == 0x80) {
+			--prefix;
+		}
+		std::size_t suffix = 0;
+		while (suffix < max_common - prefix
+				&& old_row[old_row.size() - 1 - suffix] == new_row[new_row.size() - 1 - suffix]) {
+			++suffix;
+		}
+		while (suffix > 0 && (static_cast<unsigned char>(new_row[new_row.size() - suffix]) & 0xC0) == 0x80) {
+			--suffix;
+		}
+
+		std::size_t column = utf8::display_width(new_row.data(), prefix);
+		string_view old_changed = old_row.substr(prefix, old_row.size() - suffix - prefix);
+		string_view changed = new_row.substr(prefix, new_row.size() - suffix - prefix);
+
+		// With ASCII on both sides bytes are columns, so long unchanged runs
+		// inside the change can be skipped too
+		if (old_changed.size() == changed.size()
+				&& utf8::ascii_prefix(changed.data(), changed.size()) == changed.size()
+				&& utf8::ascii_prefix(old_changed.data(), old_changed.size()) == old_changed.size()) {
+			std::size_t i = 0;
+			while (i < changed.size()) {
+				std::size_t first = i;
+				std::size_t last = i;
+				std::size_t same = 0;
+				for (; i < changed.size(); i++) {
+					if (changed[i] == old_changed[i]) {
+						if (++same == min_skip) {
+							break;
+						}
+					} else {
+						same = 0;
+						last = i + 1;
+					}
+				}
+				while (i < changed.size() && changed[i] == old_changed[i]) {
+					++i;
+				}
+				if (last > first) {
+					write(row, column + first, changed.substr(first, last - first), last - first,
+							suffix == 0 && last == changed.size());
+				}
+			}
+			return;
+		}
+		write(row, column, changed, utf8::display_width(changed.data(), changed.size()), suffix == 0);
+	}
+
+	// Write text taking width columns at row and column
+	void write(std::size_t row, std::size_t column, string_view text, std::size_t width, bool row_end) {
+		move_to(row, column);
+		m_out.append(text.data(), text.size());
+		if (row_end) {
+			// Terminals as wide as the box keep the cursor on the last column
+			m_out += '\r';
+			m_column = 0;
+		} else {
+			m_column += width;
+		}
+	}
+
+	IntroBox m_box;
+	std::chrono::steady_clock::duration m_interval;
+
+	// Previously drawn frame and the one being drawn
+	std::string m_current;
+	std::string m_next;
+	bool m_drawn;
+	bool m_dirty;
+
+	// Output of the frame and cursor position relative to the box while writing it
+	std::string m_out;
+	std::size_t m_row;
+	std::size_t m_column;
+
+	std::chrono::steady_clock::time_point m_last_frame;
+	std::size_t m_frames;
+	std::size_t m_bytes;
+};
+
+} // namespace intro_box
+} // namespace cmd
+} // namespace drodil
+
+#endif // INTRO_BOX_LIVE_BOX_HPP_
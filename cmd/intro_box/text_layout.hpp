@@ -0,0 +1,284 @@
+// text_layout.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef INTRO_BOX_TEXT_LAYOUT_HPP_
+#define INTRO_BOX_TEXT_LAYOUT_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "../../general/string/utf8.hpp"
+
+namespace drodil {
+namespace cmd {
+namespace intro_box {
+
+// How lines longer than the row width are wrapped
+enum class WrapMode {
+	character, // Fill rows completely, breaking between any characters
+	greedy,    // Break at spaces, putting as many words on each row as fit
+	balanced   // Break at spaces, keeping row lengths as even as possible
+};
+
+// Row of laid out text, a range of the content and its width in columns
+struct LayoutRow {
+	std::size_t offset;
+	std::size_t length;
+	std::size_t width;
+};
+
+// \class TextLayout
+// Wraps UTF-8 text into rows of limited display width. Widths are measured
+// in terminal columns, so wide CJK characters and emoji take two columns and
+// combining marks none. Words longer than a row are broken between
+// characters. Buffers are reused between layouts.
+class TextLayout {
+public:
+	// Lay out content into rows
+	//
+	// Lines are split with split_char like std::getline does. The first row
+	// of a line keeps its indentation, spaces at the row breaks are dropped.
+	//
+	// \param[in] content    const char* Text to lay out
+	// \param[in] size       size_t      Length of the text
+	// \param[in] split_char char        Character separating lines
+	// \param[in] width      size_t      Maximum width of a row in columns
+	// \param[in] mode       WrapMode    How to wrap long lines
+	//
+	// \return const std::vector<LayoutRow>& Rows, valid until the next layout
+	const std::vector<LayoutRow>& layout(const char* content, std::size_t size, char split_char, std::size_t width,
+			WrapMode mode) {
+		m_rows.clear();
+		m_text = content;
+		m_width = width > 0 ? width : 1;
+		std::size_t offset = 0;
+		while (offset < size) {
+			const char* split = static_cast<const char*>(std::memchr(content + offset, split_char, size - offset));
+			std::size_t end = split != nullptr ? static_cast<std::size_t>(split - content) : size;
+			if (mode == WrapMode::character) {
+				layout_characters(offset, end);
+			} else {
+				layout_words(offset, end, mode);
+			}
+			offset = split != nullptr ? end + 1 : size;
+		}
+		return m_rows;
+	}
+
+	// Get rows of the last layout
+	//
+	// \return const std::vector<LayoutRow>&
+	const std::vector<LayoutRow>& rows() const noexcept {
+		return m_rows;
+	}
+
+private:
+	// Word of a line, columns are counted from the start of the line
+	struct Word {
+		std::size_t begin;
+		std::size_t end;
+		std::size_t column_begin;
+		std::size_t column_end;
+	};
+
+	// Decode character at offset, returning its length and width
+	std::size_t next_char(std::size_t offset, std::size_t end, std::size_t& width) const noexcept {
+		unsigned char c = static_cast<unsigned char>(m_text[offset]);
+		if (c < 0x80) {
+			width = c >= 0x20 && c != 0x7F;
+			return 1;
+		}
+		std::uint32_t cp;
+		std::size_t length = drodil::general::string::utf8::decode(m_text + offset, end - offset, cp);
+		width = drodil::general::string::utf8::display_width(cp);
+		return length;
+	}
+
+	// Number of leading printable ASCII bytes, which take a column each.
+	// Spaces are excluded if words is set. Checks eight bytes at a time.
+	static std::size_t printable_prefix(const char* p, std::size_t n, bool words) noexcept {
+		const std::uint64_t ones = 0x0101010101010101ull;
+		const std::uint64_t highs = 0x8080808080808080ull;
+		const unsigned char first = words ? 0x21 : 0x20;
+		std::size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			std::uint64_t x;
+			std::memcpy(&x, p + i, sizeof(x));
+			std::uint64_t del = x ^ (ones * 0x7F);
+			if (((x | ((x - ones * first) & ~x) | ((del - ones) & ~del)) & highs) != 0) {
+				break;
+			}
+		}
+		while (i < n && static_cast<unsigned char>(p[i]) >= first && static_cast<unsigned char>(p[i]) < 0x7F) {
+			++i;
+		}
+		return i;
+	}
+
+	// Columns left on a row that already takes width columns
+	std::size_t room(std::size_t width) const noexcept {
+		return width < m_width ? m_width - width : 0;
+	}
+
+	void add_row(std::size_t begin, std::size_t end, std::size_t width) {
+		m_rows.push_back(LayoutRow{begin, end - begin, width});
+	}
+
+	// Fill rows up to the width, breaking anywhere
+	void layout_characters(std::size_t offset, std::size_t end) {
+		std::size_t begin = offset;
+		std::size_t width = 0;
+		while (offset < end) {
+			std::size_t n = printable_prefix(m_text + offset, std::min(end - offset, room(width)), false);
+			offset += n;
+			width += n;
+			if (offset == end) {
+				break;
+			}
+			std::size_t char_width;
+			std::size_t length = next_char(offset, end, char_width);
+			if (width + char_width > m_width && width > 0) {
+				add_row(begin, offset, width);
+				begin = offset;
+				width = 0;
+			}
+			width += char_width;
+			offset += length;
+		}
+		add_row(begin, end, width);
+	}
+
+	// Split line into words, breaking words wider than a row into pieces
+	void split_words(std::size_t offset, std::size_t end) {
+		m_words.clear();
+		std::size_t column = 0;
+		std::size_t line_begin = offset;
+		while (offset < end) {
+			while (offset < end && m_text[offset] == ' ') {
+				++offset;
+				++column;
+			}
+			if (offset == end) {
+				break;
+			}
+			// The first word includes the indentation of the line
+			Word word{m_words.empty() ? line_begin : offset, offset, m_words.empty() ? 0 : column, column};
+			const std::size_t word_begin = offset;
+			while (offset < end) {
+				std::size_t n = printable_prefix(m_text + offset,
+						std::min(end - offset, room(word.column_end - word.column_begin)), true);
+				word.end += n;
+				word.column_end += n;
+				offset += n;
+				if (offset == end || m_text[offset] == ' ') {
+					break;
+				}
+				std::size_t char_width;
+				std::size_t length = next_char(offset, end, char_width);
+				if (word.column_end + char_width - word.column_begin > m_width) {
+					if (offset > word_begin && word.column_end > word.column_begin) {
+						m_words.push_back(word);
+						word = Word{offset, offset, word.column_end, word.column_end};
+					} else if (offset == word_begin) {
+						// Drop indentation that leaves no room for the word
+						word.begin = offset;
+						word.column_begin = word.column_end;
+					}
+				}
+				word.end += length;
+				word.column_end += char_width;
+				offset += length;
+			}
+			column = word.column_end;
+			m_words.push_back(word);
+		}
+	}
+
+	// Width of words first to last on one row
+	std::size_t row_width(std::size_t first, std::size_t last) const noexcept {
+		return m_words[last].column_end - m_words[first].column_begin;
+	}
+
+	void layout_words(std::size_t offset, std::size_t end, WrapMode mode) {
+		split_words(offset, end);
+		std::size_t count = m_words.size();
+		if (count == 0) {
+			add_row(offset, offset, 0);
+			return;
+		}
+
+		if (mode == WrapMode::greedy) {
+			for (std::size_t first = 0; first < count;) {
+				std::size_t last = first;
+				while (last + 1 < count && row_width(first, last + 1) <= m_width) {
+					++last;
+				}
+				add_row(m_words[first].begin, m_words[last].end, row_width(first, last));
+				first = last + 1;
+			}
+			return;
+		}
+
+		// Minimum raggedness: cost of a row is its squared free space, except
+		// for the last row of the line. Solved from the end of the line.
+		m_cost.assign(count + 1, 0);
+		m_next.assign(count, 0);
+		for (std::size_t first = count; first-- > 0;) {
+			std::uint64_t best = std::numeric_limits<std::uint64_t>::max();
+			for (std::size_t last = first; last < count; last++) {
+				std::size_t width = row_width(first, last);
+				if (width > m_width && last > first) {
+					break;
+				}
+				std::uint64_t slack = width < m_width ? m_width - width : 0;
+				std::uint64_t cost = (last + 1 == count ? 0 : slack * slack) + m_cost[last + 1];
+				if (cost < best) {
+					best = cost;
+					m_next[first] = last;
+				}
+			}
+			m_cost[first] = best;
+		}
+		for (std::size_t first = 0; first < count; first = m_next[first] + 1) {
+			std::size_t last = m_next[first];
+			add_row(m_words[first].begin, m_words[last].end, row_width(first, last));
+		}
+	}
+
+	const char* m_text = nullptr;
+	std::size_t m_width = 1;
+	std::vector<LayoutRow> m_rows;
+	std::vector<Word> m_words;
+	std::vector<std::uint64_t> m_cost;
+	std::vector<std::size_t> m_next;
+};
+
+} // namespace intro_box
+} // namespace cmd
+} // namespace drodil
+
+#endif // INTRO_BOX_TEXT_LAYOUT_HPP_
@@ -0,0 +1,75 @@
+// benchmark.cpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "table.hpp"
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+using namespace drodil::cmd::table;
+
+namespace {
+
+// Run fn once and report time per row and throughput of the output
+template<typename Fn>
+void run(const char* name, std::size_t rows, Fn fn) {
+	auto start = std::chrono::steady_clock::now();
+	std::size_t bytes = fn();
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	std::printf("%-36s %8.1f ns/row %10.1f MB/s\n", name, ns / rows, bytes / (ns / 1e9) / 1e6);
+}
+
+} // namespace
+
+int main() {
+	const std::size_t rows = 2000000;
+	std::string path = "/srv/data/batch-00/input-000000.dat";
+
+	// Sink that only counts, so only formatting is measured
+	run("TableWriter to counting sink", rows, [&] {
+		std::size_t bytes = 0;
+		TableWriter table({{"File"}, {"Size", Align::right}, {"Ratio", Align::right}, {"Type", Align::left, 16}},
+				[&bytes](const char*, std::size_t size) { bytes += size; });
+		for (std::size_t i = 0; i < rows; i++) {
+			path[path.size() - 5] = static_cast<char>('0' + i % 10);
+			table.add_row({path, i * 4096, 1.0 / (1 + i % 8), i % 3 ? "application/octet-stream" : "text/plain"});
+		}
+		table.finish();
+		return bytes;
+	});
+
+	// Same through std::ostream, as std::cout would be used
+	run("TableWriter to std::ostringstream", rows / 10, [&] {
+		std::ostringstream os;
+		TableWriter table({{"File"}, {"Size", Align::right}, {"Ratio", Align::right}, {"Type", Align::left, 16}},
+				os);
+		for (std::size_t i = 0; i < rows / 10; i++) {
+			table.add_row({path, i * 4096, 1.0 / (1 + i % 8), i % 3 ? "application/octet-stream" : "text/plain"});
+		}
+		table.finish();
+		return static_cast<std::size_t>(os.tellp());
+	});
+	return 0;
+}
@@ -0,0 +1,53 @@
+// example.cpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "table.hpp"
+#include <iostream>
+
+using namespace drodil::cmd::table;
+
+int main() {
+	// Columns are sized from the rows, except for the fixed width type column
+	TableWriter table({{"File"}, {"Size", Align::right}, {"Ratio", Align::right}, {"Type", Align::left, 16}},
+			std::cout);
+	table.add_row({"README.md", 2048, 0.5, "text/markdown"});
+	table.add_row({"logo.png", 1048576, 1, "image/png"});
+	table.add_row({"\xe6\x96\x87\xe6\xa1\xa3.txt", 17, 0.25, "text/plain"});
+	table.add_row({"archive.tar.gz", 73400320, 0.125, "application/x-compressed-tar"});
+	table.finish();
+	std::cout << std::endl;
+
+	// Rows after the sample are truncated to the sampled widths
+	TableWriter streamed({{"#", Align::right}, {"Name", Align::center, 0, 12}}, std::cout);
+	streamed.set_sample_rows(2);
+	streamed.set_corner_char('*');
+	streamed.set_horizontal_border_char('*');
+	streamed.set_vertical_border_char('*');
+	streamed.add_row({1, "first"});
+	streamed.add_row({2, "second"});
+	streamed.add_row({3, "much longer than the others"});
+	streamed.finish();
+
+	return 0;
+}
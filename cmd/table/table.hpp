@@ -0,0 +1,557 @@
+// table.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef TABLE_TABLE_HPP_
+#define TABLE_TABLE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include "../../general/string/number.hpp"
+#include "../../general/string/string_view.hpp"
+#include "../../general/string/utf8.hpp"
+
+namespace drodil {
+namespace cmd {
+namespace table {
+
+using drodil::general::string::string_view;
+
+// Alignment of text in a column
+enum class Align {
+	left,
+	right,
+	center
+};
+
+// Column of a table
+struct Column {
+	// Constructor
+	//
+	// \param[in] title     std::string Title shown in the header
+	// \param[in] align     Align       Alignment of the cells
+	// \param[in] width     size_t      Fixed width in columns, 0 to size from the sampled rows
+	// \param[in] max_width size_t      Maximum width when sized from the sampled rows, 0 for no limit
+	Column(const std::string& title, Align align = Align::left, std::size_t width = 0, std::size_t max_width = 0)
+			: title(title), align(align), width(width), max_width(max_width) {
+	}
+
+	std::string title;
+	Align align;
+	std::size_t width;
+	std::size_t max_width;
+};
+
+// \class Cell
+// Value of a cell, either text or a number formatted without allocations.
+// Text is not copied and must outlive the call it is passed to.
+class Cell {
+public:
+	Cell(string_view text) noexcept : m_text(text.data()), m_size(text.size()) {}
+	Cell(const std::string& text) noexcept : m_text(text.data()), m_size(text.size()) {}
+	Cell(const char* text) noexcept : m_text(text), m_size(std::strlen(text)) {}
+
+	template<typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value
+			&& !std::is_same<T, bool>::value && !std::is_same<T, char>::value>::type>
+	Cell(T value) noexcept : m_text(nullptr) {
+		m_size = static_cast<std::size_t>(format(m_number, m_number + sizeof(m_number), value) - m_number);
+	}
+
+	// Get text of the cell
+	//
+	// \return string_view
+	string_view text() const noexcept {
+		return string_view(m_text != nullptr ? m_text : m_number, m_size);
+	}
+
+private:
+	template<typename T>
+	static typename std::enable_if<std::is_integral<T>::value, char*>::type
+	format(char* first, char* last, T value) noexcept {
+		return drodil::general::string::to_chars(first, last, value).ptr;
+	}
+
+	template<typename T>
+	static typename std::enable_if<std::is_floating_point<T>::value, char*>::type
+	format(char* first, char* last, T value) noexcept {
+		return drodil::general::string::to_chars(first, last, static_cast<double>(value)).ptr;
+	}
+
+	const char* m_text;
+	std::size_t m_size;
+	char m_number[32];
+};
+
+// \class TableWriter
+// Writes tables of any number of rows with bounded memory. Columns without
+// a fixed width are sized from the first rows, which are kept until the
+// sample is complete. After that every row is formatted into a reusable
+// buffer that is passed to the output when full. Cells wider than their
+// column are truncated with an ellipsis. Widths are measured in terminal
+// columns, so UTF-8 text stays aligned.
+//
+// \code
+// TableWriter table({{"File"}, {"Size", Align::right}, {"Type", Align::left, 24}}, std::cout);
+// for (const auto& result : results) {
+// 	table.add_row({result.path, result.size, result.mime});
+// }
+// table.finish();
+// \endcode
+class TableWriter {
+public:
+	// Function receiving the formatted output
+	typedef std::function<void(const char*, std::size_t)> Sink;
+
+	// Size of the output buffer
+	static const std::size_t buffer_size = 64 * 1024;
+
+	// Constructor
+	//
+	// \param[in] columns std::vector<Column> Columns of the table
+	// \param[in] sink    Sink                Function receiving the output
+	//
+	// \throws std::invalid_argument if there are no columns
+	TableWriter(std::vector<Column> columns, Sink sink)
+			: m_columns(std::move(columns)), m_sink(std::move(sink)), m_ver_border_char('|'),
+			  m_hor_border_char('-'), m_corner_char('+'), m_padding(1), m_sample_rows(100), m_ellipsis("..."),
+			  m_buffer(new char[buffer_size]), m_used(0), m_capacity(buffer_size), m_started(false),
+			  m_finished(false), m_rows(0) {
+		if (m_columns.empty()) {
+			throw std::invalid_argument("Table needs at least one column");
+		}
+	}
+
+	// Constructor writing to output stream
+	//
+	// \param[in] columns std::vector<Column> Columns of the table
+	// \param[in] os      std::ostream        Stream to write to, must outlive the writer
+	TableWriter(std::vector<Column> columns, std::ostream& os)
+			: TableWriter(std::move(columns), [&os](const char* data, std::size_t size) {
+				os.write(data, static_cast<std::streamsize>(size));
+			}) {
+	}
+
+#if defined(__unix__) || defined(__APPLE__)
+	// Constructor writing to file descriptor
+	//
+	// \param[in] columns std::vector<Column> Columns of the table
+	// \param[in] fd      int                 File descriptor to write to
+	TableWriter(std::vector<Column> columns, int fd)
+			: TableWriter(std::move(columns), [fd](const char* data, std::size_t size) {
+				while (size > 0) {
+					ssize_t r = ::write(fd, data, size);
+					if (r < 0) {
+						if (errno == EINTR) {
+							continue;
+						}
+						throw std::runtime_error("Could not write to file descriptor");
+					}
+					data += r;
+					size -= static_cast<std::size_t>(r);
+				}
+			}) {
+	}
+#endif
+
+	TableWriter(const TableWriter&) = delete;
+	TableWriter& operator=(const TableWriter&) = delete;
+
+	// Finishes the table if finish() was not called. Errors of the output
+	// are ignored here, call finish() to get them.
+	~TableWriter() {
+		try {
+			finish();
+		} catch (...) {
+		}
+	}
+
+	// Set character for vertical borders, '\0' for no borders
+	//
+	// \param[in] border_char char Character
+	//
+	// \return void
+	// \throws std::logic_error if rows have been written already
+	void set_vertical_border_char(char border_char) {
+		check_not_started();
+		m_ver_border_char = border_char;
+	}
+
+	// Set character for horizontal borders, '\0' for no borders
+	//
+	// \param[in] border_char char Character
+	//
+	// \return void
+	// \throws std::logic_error if rows have been written already
+	void set_horizontal_border_char(char border_char) {
+		check_not_started();
+		m_hor_border_char = border_char;
+	}
+
+	// Set character where borders cross
+	//
+	// \param[in] corner_char char Character
+	//
+	// \return void
+	// \throws std::logic_error if rows have been written already
+	void set_corner_char(char corner_char) {
+		check_not_started();
+		m_corner_char = corner_char;
+	}
+
+	// Set padding on both sides of the cells
+	//
+	// \param[in] padding size_t Number of spaces
+	//
+	// \return void
+	// \throws std::logic_error if rows have been written already
+	void set_padding(std::size_t padding) {
+		check_not_started();
+		m_padding = padding;
+	}
+
+	// Set number of rows used to size the columns without a fixed width
+	//
+	// \param[in] rows size_t Number of rows kept before writing, at least one
+	//
+	// \return void
+	// \throws std::logic_error if rows have been written already
+	void set_sample_rows(std::size_t rows) {
+		check_not_started();
+		m_sample_rows = std::max<std::size_t>(rows, 1);
+	}
+
+	// Set text marking truncated cells
+	//
+	// \param[in] ellipsis std::string Text, e.g. "..." or "…"
+	//
+	// \return void
+	// \throws std::logic_error if rows have been written already
+	void set_ellipsis(const std::string& ellipsis) {
+		check_not_started();
+		m_ellipsis = ellipsis;
+	}
+
+	// Add row to the table
+	//
+	// Missing cells are left empty and extra cells are ignored.
+	//
+	// \param[in] cells std::initializer_list<Cell> Cells of the row
+	//
+	// \return void
+	void add_row(std::initializer_list<Cell> cells) {
+		add_row(cells.begin(), cells.size());
+	}
+
+	// Add row to the table
+	//
+	// \param[in] cells std::vector<std::string> Cells of the row
+	//
+	// \return void
+	void add_row(const std::vector<std::string>& cells) {
+		m_cells.clear();
+		for (const std::string& cell : cells) {
+			m_cells.emplace_back(cell);
+		}
+		add_row(m_cells.data(), m_cells.size());
+	}
+
+	// Add row to the table
+	//
+	// \param[in] cells Cell*  Cells of the row
+	// \param[in] count size_t Number of cells
+	//
+	// \return void
+	// \throws std::logic_error if the table is finished
+	void add_row(const Cell* cells, std::size_t count) {
+		if (m_finished) {
+			throw std::logic_error("Table is finished");
+		}
+		++m_rows;
+		if (m_started) {
+			write_row(cells, count);
+		} else {
+			sample(cells, count);
+			if (m_sample_offsets.size() / (m_columns.size() + 1) == m_sample_rows) {
+				start();
+			}
+		}
+		if (m_used >= buffer_size) {
+			flush();
+		}
+	}
+
+	// Write the rest of the table and the bottom border
+	//
+	// \return void
+	void finish() {
+		if (m_finished) {
+			return;
+		}
+		if (!m_started) {
+			start();
+		}
+		m_finished = true;
+		write_border();
+		flush();
+	}
+
+	// Pass buffered output to the sink, without finishing the table
+	//
+	// \return void
+	void flush() {
+		if (m_used > 0) {
+			m_sink(m_buffer.get(), m_used);
+			m_used = 0;
+		}
+	}
+
+	// Get number of rows added
+	//
+	// \return std::size_t
+	std::size_t rows() const noexcept {
+		return m_rows;
+	}
+
+	// Get widths of the columns, known once the sampled rows have been written
+	//
+	// \return const std::vector<std::size_t>&
+	const std::vector<std::size_t>& widths() const noexcept {
+		return m_widths;
+	}
+
+private:
+	void check_not_started() const {
+		if (m_started) {
+			throw std::logic_error("Table style can't be changed after rows have been written");
+		}
+	}
+
+	static std::size_t width_of(string_view text) noexcept {
+		return drodil::general::string::utf8::display_width(text.data(), text.size());
+	}
+
+	// Keep row of the sample, offsets of its cells end with the end of the last one
+	void sample(const Cell* cells, std::size_t count) {
+		for (std::size_t i = 0; i < m_columns.size(); i++) {
+			m_sample_offsets.push_back(m_sample_text.size());
+			if (i < count) {
+				string_view text = cells[i].text();
+				m_sample_text.append(text.data(), text.size());
+			}
+		}
+		m_sample_offsets.push_back(m_sample_text.size());
+	}
+
+	string_view sampled_cell(std::size_t row, std::size_t column) const noexcept {
+		std::size_t index = row * (m_columns.size() + 1) + column;
+		return string_view(m_sample_text.data() + m_sample_offsets[index],
+				m_sample_offsets[index + 1] - m_sample_offsets[index]);
+	}
+
+	// Size columns from the sample and write the header and the sampled rows
+	void start() {
+		std::size_t sampled = m_sample_offsets.size() / (m_columns.size() + 1);
+		m_widths.resize(m_columns.size());
+		for (std::size_t i = 0; i < m_columns.size(); i++) {
+			const Column& column = m_columns[i];
+			if (column.width > 0) {
+				m_widths[i] = column.width;
+				continue;
+			}
+			std::size_t width = width_of(column.title);
+			for (std::size_t row = 0; row < sampled; row++) {
+				width = std::max(width, width_of(sampled_cell(row, i)));
+			}
+			m_widths[i] = column.max_width > 0 ? std::min(width, column.max_width) : width;
+		}
+		m_started = true;
+
+		write_border();
+		m_cells.clear();
+		for (const Column& column : m_columns) {
+			m_cells.emplace_back(column.title);
+		}
+		write_row(m_cells.data(), m_cells.size());
+		write_border();
+
+		for (std::size_t row = 0; row < sampled; row++) {
+			m_cells.clear();
+			for (std::size_t i = 0; i < m_columns.size(); i++) {
+				m_cells.emplace_back(sampled_cell(row, i));
+			}
+			write_row(m_cells.data(), m_cells.size());
+		}
+		std::string().swap(m_sample_text);
+		std::vector<std::size_t>().swap(m_sample_offsets);
+	}
+
+	// Make room for size more characters, flushing if the buffer is full
+	char* reserve(std::size_t size) {
+		if (m_used + size > m_capacity) {
+			flush();
+			if (size > m_capacity) {
+				m_capacity = size;
+				m_buffer.reset(new char[m_capacity]);
+			}
+		}
+		return m_buffer.get() + m_used;
+	}
+
+	static char* fill(char* out, char c, std::size_t count) noexcept {
+		std::memset(out, c, count);
+		return out + count;
+	}
+
+	void write_border() {
+		if (m_hor_border_char == '\0') {
+			return;
+		}
+		std::size_t size = m_widths.size() + 2;
+		for (std::size_t width : m_widths) {
+			size += width + (m_padding * 2);
+		}
+		char* const begin = reserve(size);
+		char* out = begin;
+		for (std::size_t i = 0; i < m_widths.size(); i++) {
+			if (m_ver_border_char != '\0') {
+				*out++ = m_corner_char;
+			} else if (i > 0) {
+				*out++ = m_hor_border_char;
+			}
+			out = fill(out, m_hor_border_char, m_widths[i] + (m_padding * 2));
+		}
+		if (m_ver_border_char != '\0') {
+			*out++ = m_corner_char;
+		}
+		*out++ = '\n';
+		m_used += out - begin;
+	}
+
+	void write_row(const Cell* cells, std::size_t count) {
+		// Upper bound of the row, cells take at most their text and width
+		std::size_t size = m_widths.size() + 2;
+		for (std::size_t i = 0; i < m_widths.size(); i++) {
+			size += m_widths[i] + (m_padding * 2) + m_ellipsis.size() + (i < count ? cells[i].text().size() : 0);
+		}
+		char* const begin = reserve(size);
+		char* out = begin;
+		for (std::size_t i = 0; i < m_widths.size(); i++) {
+			if (m_ver_border_char != '\0') {
+				*out++ = m_ver_border_char;
+			} else if (i > 0) {
+				*out++ = ' ';
+			}
+			out = fill(out, ' ', m_padding);
+			out = write_cell(out, i < count ? cells[i].text() : string_view(), m_widths[i], m_columns[i].align);
+			out = fill(out, ' ', m_padding);
+		}
+		if (m_ver_border_char != '\0') {
+			*out++ = m_ver_border_char;
+		}
+		*out++ = '\n';
+		m_used += out - begin;
+	}
+
+	char* write_cell(char* out, string_view text, std::size_t width, Align align) {
+		namespace utf8 = drodil::general::string::utf8;
+		std::size_t text_width = width_of(text);
+		if (text_width > width) {
+			// Keep as much of the text as fits with the ellipsis
+			std::size_t ellipsis_width = width_of(m_ellipsis);
+			bool ellipsis = ellipsis_width <= width;
+			std::size_t room = ellipsis ? width - ellipsis_width : width;
+			std::size_t length = std::min(utf8::ascii_prefix(text.data(), text.size()), room);
+			std::size_t used = width_of(text.substr(0, length));
+			while (length < text.size()) {
+				std::uint32_t cp;
+				std::size_t n = utf8::decode(text.data() + length, text.size() - length, cp);
+				std::size_t w = utf8::display_width(cp);
+				if (used + w > room) {
+					break;
+				}
+				used += w;
+				length += n;
+			}
+			if (length > 0) {
+				std::memcpy(out, text.data(), length);
+			}
+			out += length;
+			if (ellipsis) {
+				std::memcpy(out, m_ellipsis.data(), m_ellipsis.size());
+				out += m_ellipsis.size();
+				used += ellipsis_width;
+			}
+			return fill(out, ' ', width - used);
+		}
+
+		std::size_t space = width - text_width;
+		std::size_t left = align == Align::right ? space : align == Align::center ? space / 2 : 0;
+		out = fill(out, ' ', left);
+		if (!text.empty()) {
+			std::memcpy(out, text.data(), text.size());
+		}
+		return fill(out + text.size(), ' ', space - left);
+	}
+
+	std::vector<Column> m_columns;
+	Sink m_sink;
+	char m_ver_border_char;
+	char m_hor_border_char;
+	char m_corner_char;
+	std::size_t m_padding;
+	std::size_t m_sample_rows;
+	std::string m_ellipsis;
+
+	// Rows kept until the columns are sized
+	std::string m_sample_text;
+	std::vector<std::size_t> m_sample_offsets;
+
+	std::vector<std::size_t> m_widths;
+	std::vector<Cell> m_cells;
+	std::unique_ptr<char[]> m_buffer;
+	std::size_t m_used;
+	std::size_t m_capacity;
+	bool m_started;
+	bool m_finished;
+	std::size_t m_rows;
+};
+
+} // namespace table
+} // namespace cmd
+} // namespace drodil
+
+#endif // TABLE_TABLE_HPP_
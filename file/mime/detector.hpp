@@ -34,6 +34,8 @@
 #include <sstream>
 #include <string>
 
+#include "../../general/string/encoding.hpp"
+
 namespace drodil {
 namespace file {
 namespace mime {
@@ -105,13 +107,9 @@ private:
         }
 
         file.seekg(0, std::ios::beg);
-        char* x = new char[max_length];
-        file.read(x, max_length);
-        std::stringstream ss;
-        for (int i = 0; i < max_length; i++) {
-            ss << std::hex << std::setfill('0') << std::setw(2) << std::uppercase << static_cast<int>(x[i] & 0xff);
-        }
-        return ss.str();
+        std::string magic(max_length, '\0');
+        file.read(&magic[0], max_length);
+        return drodil::general::string::hex_encode(magic, true);
     }
 
     /// Detect mimetype from given extension
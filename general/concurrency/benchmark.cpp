@@ -0,0 +1,257 @@
+// benchmark.cpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+#include "work_stealing_deque.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace drodil::general::concurrency;
+
+namespace {
+
+// Prevents the compiler from optimizing away benchmarked results
+volatile std::uint64_t g_sink = 0;
+
+// Run fn rounds times and return the nanoseconds per round
+template<typename Fn>
+double measure(std::size_t rounds, Fn fn) {
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < rounds; i++) {
+		fn();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+}
+
+// Run fn rounds times and report time per processed item
+template<typename Fn>
+void run(const char* name, std::size_t rounds, std::size_t items, Fn fn) {
+	std::printf("%-40s %12.3f ns/item\n", name, measure(rounds, fn) / items);
+}
+
+// CPU bound work of one iteration, cost grows with rounds
+std::uint64_t mix(std::uint64_t value, unsigned rounds) {
+	for (unsigned i = 0; i < rounds; i++) {
+		value ^= value >> 31;
+		value *= 0x7fb5d329728ea185ull;
+		value ^= value >> 27;
+	}
+	return value;
+}
+
+// Thread counts to measure: powers of two up to the hardware threads
+std::vector<std::size_t> thread_counts() {
+	std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::size_t> ret;
+	for (std::size_t threads = 1; threads < hardware; threads *= 2) {
+		ret.push_back(threads);
+	}
+	ret.push_back(hardware);
+	return ret;
+}
+
+// Report time of a workload for every thread count relative to a serial loop
+void scaling(const char* name, std::size_t rounds, const std::function<void()>& serial,
+		const std::function<void(ThreadPool&)>& parallel) {
+	double base = measure(rounds, serial);
+	std::printf("%-40s %12.3f ms\n", (std::string(name) + "/serial").c_str(), base / 1e6);
+	for (std::size_t threads : thread_counts()) {
+		ThreadPool pool(threads);
+		// Wake the workers before measuring
+		parallel(pool);
+		double ns = measure(rounds, [&] { parallel(pool); });
+		std::string label = std::string(name) + "/threads:" + std::to_string(threads);
+		std::printf("%-40s %12.3f ms %8.2fx\n", label.c_str(), ns / 1e6, base / ns);
+	}
+}
+
+void bench_scaling() {
+	const std::size_t size = 1 << 20;
+
+	// Every iteration costs the same
+	scaling("parallel_for/uniform", 5,
+			[&] {
+				std::uint64_t sum = 0;
+				for (std::size_t i = 0; i < size; i++) {
+					sum += mix(i, 32);
+				}
+				g_sink += sum;
+			},
+			[&](ThreadPool& pool) {
+				std::vector<std::uint64_t> values(size);
+				parallel_for(pool, std::size_t(0), size, [&](std::size_t i) { values[i] = mix(i, 32); });
+				g_sink += values.back();
+			});
+
+	// Cost grows with the index, static partitioning would leave threads idle
+	const std::size_t triangle = 1 << 12;
+	scaling("parallel_for/triangular", 5,
+			[&] {
+				std::uint64_t sum = 0;
+				for (std::size_t i = 0; i < triangle; i++) {
+					sum += mix(i, static_cast<unsigned>(i));
+				}
+				g_sink += sum;
+			},
+			[&](ThreadPool& pool) {
+				std::vector<std::uint64_t> values(triangle);
+				parallel_for(pool, std::size_t(0), triangle, [&](std::size_t i) {
+					values[i] = mix(i, static_cast<unsigned>(i));
+				});
+				g_sink += values.back();
+			});
+
+	// Memory bound, limited by bandwidth rather than cores
+	std::vector<double> input(4 * size);
+	std::vector<double> output(input.size());
+	for (std::size_t i = 0; i < input.size(); i++) {
+		input[i] = static_cast<double>(i);
+	}
+	scaling("parallel_transform/sqrt", 5,
+			[&] {
+				std::transform(input.begin(), input.end(), output.begin(), [](double x) { return std::sqrt(x); });
+				g_sink += static_cast<std::uint64_t>(output.back());
+			},
+			[&](ThreadPool& pool) {
+				parallel_transform(pool, input.begin(), input.end(), output.begin(), [](double x) {
+					return std::sqrt(x);
+				});
+				g_sink += static_cast<std::uint64_t>(output.back());
+			});
+}
+
+std::uint64_t fib_serial(unsigned n) {
+	return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+// Naive recursive Fibonacci with a task per call above the cutoff
+std::uint64_t fib(ThreadPool& pool, unsigned n) {
+	if (n < 16) {
+		return fib_serial(n);
+	}
+	std::future<std::uint64_t> left = pool.submit(fib, std::ref(pool), n - 1);
+	std::uint64_t right = fib(pool, n - 2);
+	while (left.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		if (!pool.run_pending_task()) {
+			std::this_thread::yield();
+		}
+	}
+	return left.get() + right;
+}
+
+void bench_tasks() {
+	const std::size_t tasks = 100000;
+	ThreadPool pool;
+	std::atomic<std::size_t> counter(0);
+
+	// Submitted from outside, every task goes through the injection queue
+	run("post/external", 5, tasks, [&] {
+		for (std::size_t i = 0; i < tasks; i++) {
+			pool.post([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+		}
+		pool.wait_idle();
+	});
+
+	// Submitted from a worker to its own deque
+	run("post/worker", 5, tasks, [&] {
+		pool.post([&] {
+			for (std::size_t i = 0; i < tasks; i++) {
+				pool.post([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+			}
+		});
+		pool.wait_idle();
+	});
+
+	run("submit/future", 5, tasks, [&] {
+		std::vector<std::future<std::size_t>> results;
+		results.reserve(tasks);
+		for (std::size_t i = 0; i < tasks; i++) {
+			results.push_back(pool.submit([](std::size_t value) { return value * 2; }, i));
+		}
+		for (std::future<std::size_t>& result : results) {
+			g_sink += result.get();
+		}
+	});
+
+	// Thread per task for comparison, far fewer tasks to keep it short
+	const std::size_t async_tasks = 1000;
+	run("std::async/future", 5, async_tasks, [&] {
+		std::vector<std::future<std::size_t>> results;
+		for (std::size_t i = 0; i < async_tasks; i++) {
+			results.push_back(std::async(std::launch::async, [](std::size_t value) { return value * 2; }, i));
+		}
+		for (std::future<std::size_t>& result : results) {
+			g_sink += result.get();
+		}
+	});
+	g_sink += counter.load();
+
+	scaling("submit/fib(30)", 3, [] { g_sink += fib_serial(30); }, [](ThreadPool& workers) {
+		g_sink += fib(workers, 30);
+	});
+}
+
+void bench_deque() {
+	const std::size_t items = 1 << 20;
+	WorkStealingDeque<std::size_t> deque;
+	run("deque/push+take", 10, items, [&] {
+		for (std::size_t i = 0; i < items; i++) {
+			deque.push(i);
+		}
+		std::size_t value;
+		while (deque.take(value)) {
+			g_sink += value;
+		}
+	});
+	run("deque/push+steal", 10, items, [&] {
+		for (std::size_t i = 0; i < items; i++) {
+			deque.push(i);
+		}
+		std::size_t value;
+		while (deque.steal(value)) {
+			g_sink += value;
+		}
+	});
+}
+
+} // namespace
+
+int main() {
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	bench_deque();
+	bench_tasks();
+	bench_scaling();
+	return 0;
+}
@@ -0,0 +1,91 @@
+// example.cpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace drodil::general::concurrency;
+
+int main() {
+	ThreadPool pool(4);
+	std::cout << "Workers: " << pool.size() << std::endl;
+
+	// Futures carry the result or the exception
+	std::future<int> answer = pool.submit([](int a, int b) { return a * b; }, 6, 7);
+	std::future<void> failing = pool.submit([] { throw std::runtime_error("task failed"); });
+	std::cout << "Answer: " << answer.get() << std::endl;
+	try {
+		failing.get();
+	} catch (const std::runtime_error& e) {
+		std::cout << "Caught: " << e.what() << std::endl;
+	}
+
+	// Fire and forget, wait_idle waits until everything has run
+	std::atomic<int> done(0);
+	for (int i = 0; i < 100; i++) {
+		pool.post([&done] { done++; });
+	}
+	pool.wait_idle();
+	std::cout << "Posted tasks run: " << done.load() << std::endl;
+
+	// Every index is visited exactly once
+	std::vector<std::string> words(1000);
+	parallel_for(pool, std::size_t(0), words.size(), [&](std::size_t i) { words[i] = std::to_string(i); });
+	std::cout << "Last word: " << words.back() << std::endl;
+
+	std::vector<std::size_t> lengths(words.size());
+	parallel_transform(pool, words.begin(), words.end(), lengths.begin(),
+			[](const std::string& word) { return word.size(); });
+	std::cout << "Total length: " << std::accumulate(lengths.begin(), lengths.end(), std::size_t(0)) << std::endl;
+
+	// Loops can be nested, waiting workers run other chunks meanwhile
+	std::vector<std::vector<int>> matrix(64, std::vector<int>(64));
+	parallel_for(pool, 0, 64, [&](int row) {
+		parallel_for(pool, 0, 64, [&](int column) { matrix[row][column] = row * column; }, 8);
+	}, 1);
+	std::cout << "matrix[63][63]: " << matrix[63][63] << std::endl;
+
+	// First exception of an iteration is rethrown to the caller
+	try {
+		parallel_for(pool, 0, 1000, [](int i) {
+			if (i == 500) {
+				throw std::out_of_range("index 500");
+			}
+		});
+	} catch (const std::out_of_range& e) {
+		std::cout << "Loop failed: " << e.what() << std::endl;
+	}
+
+	// Without a pool the shared default pool is used
+	std::vector<double> squares(10);
+	parallel_for(0, 10, [&](int i) { squares[i] = i * i; });
+	std::cout << "squares[9]: " << squares[9] << std::endl;
+	return 0;
+}
@@ -0,0 +1,253 @@
+// parallel.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CONCURRENCY_PARALLEL_HPP_
+#define CONCURRENCY_PARALLEL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "thread_pool.hpp"
+
+namespace drodil {
+namespace general {
+namespace concurrency {
+
+// Shared pool used by the helpers that are not given a pool, created on
+// first use with one worker per hardware thread
+//
+// \return ThreadPool&
+inline ThreadPool& default_thread_pool() {
+	static ThreadPool pool;
+	return pool;
+}
+
+namespace detail {
+
+// Number of chunks created per worker when no grain size is given. More
+// chunks than workers lets stealing even out iterations of uneven cost.
+const std::size_t chunks_per_worker = 8;
+
+// Default grain size
+//
+// \param[in] count   size_t Number of iterations
+// \param[in] workers size_t Number of threads running them
+//
+// \return size_t
+inline std::size_t default_grain(std::size_t count, std::size_t workers) noexcept {
+	std::size_t chunks = workers * chunks_per_worker;
+	return count > chunks ? count / chunks : 1;
+}
+
+// Iterations shared by all chunks of a parallel loop. Lives on the stack of
+// the calling thread, which waits until every iteration is accounted for.
+template<class Index, class Fn>
+class ParallelLoop {
+public:
+	ParallelLoop(ThreadPool& pool, Fn& fn, std::size_t count, std::size_t grain)
+		: m_pool(pool), m_fn(fn), m_grain(grain), m_remaining(count), m_failed(false), m_done(count == 0) {}
+
+	// Run iterations [first, last). Halves of the range are handed to the
+	// pool until the rest fits into the grain, so idle workers steal large
+	// ranges and split them further on their own deques.
+	//
+	// \param[in] first Index First iteration
+	// \param[in] last  Index One past the last iteration
+	void run(Index first, Index last) {
+		while (static_cast<std::size_t>(last - first) > m_grain && !m_failed.load(std::memory_order_relaxed)) {
+			Index middle = first + static_cast<Index>(static_cast<std::size_t>(last - first) / 2);
+			Index end = last;
+			try {
+				m_pool.post([this, middle, end] { run(middle, end); });
+			} catch (...) {
+				// Could not queue the half, run the whole range here instead
+				break;
+			}
+			last = middle;
+		}
+		if (!m_failed.load(std::memory_order_relaxed)) {
+			try {
+				for (Index i = first; i != last; ++i) {
+					m_fn(i);
+				}
+			} catch (...) {
+				fail(std::current_exception());
+			}
+		}
+		finish(static_cast<std::size_t>(last - first));
+	}
+
+	// Help the pool until all iterations have run
+	//
+	// \throws the first exception thrown by an iteration
+	void wait() {
+		bool worker = m_pool.in_worker();
+		while (m_remaining.load(std::memory_order_acquire) != 0) {
+			if (m_pool.run_pending_task()) {
+				continue;
+			}
+			if (!worker) {
+				break;
+			}
+			// Workers keep looking for tasks instead of blocking a thread of
+			// the pool, the outstanding chunks may be waiting for one
+			std::this_thread::yield();
+		}
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cv.wait(lock, [this] { return m_done; });
+		if (m_error) {
+			std::rethrow_exception(m_error);
+		}
+	}
+
+private:
+	void fail(std::exception_ptr error) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_error) {
+			m_error = error;
+		}
+		m_failed.store(true, std::memory_order_relaxed);
+	}
+
+	void finish(std::size_t count) {
+		if (m_remaining.fetch_sub(count, std::memory_order_acq_rel) == count) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_done = true;
+			m_cv.notify_all();
+		}
+	}
+
+	ThreadPool& m_pool;
+	Fn& m_fn;
+	std::size_t m_grain;
+	std::atomic<std::size_t> m_remaining;
+	std::atomic<bool> m_failed;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_done;
+	std::exception_ptr m_error;
+};
+
+} // namespace detail
+
+// Call fn(i) for every i in [first, last) on the pool. The range is split
+// recursively into chunks of at most grain iterations, the calling thread
+// runs chunks too and returns when all have finished. May be nested, a
+// worker waiting for an inner loop runs other tasks meanwhile.
+//
+// \code
+// parallel_for(pool, std::size_t(0), paths.size(), [&](std::size_t i) { types[i] = detector.detect(paths[i]); });
+// \endcode
+//
+// \param[in] pool  ThreadPool& Pool to run on
+// \param[in] first Index       First iteration, any integer type
+// \param[in] last  Index       One past the last iteration
+// \param[in] fn    Fn          Function called with every index
+// \param[in] grain size_t      Maximum iterations per chunk, 0 picks one from the pool size
+//
+// \throws the first exception thrown by fn, remaining chunks are skipped
+template<class Index, class Fn>
+typename std::enable_if<std::is_integral<Index>::value>::type parallel_for(ThreadPool& pool, Index first,
+		Index last, Fn&& fn, std::size_t grain = 0) {
+	if (!(first < last)) {
+		return;
+	}
+	std::size_t count = static_cast<std::size_t>(last - first);
+	if (grain == 0) {
+		grain = detail::default_grain(count, pool.size() + 1);
+	}
+	if (count <= grain) {
+		for (Index i = first; i != last; ++i) {
+			fn(i);
+		}
+		return;
+	}
+	detail::ParallelLoop<Index, typename std::remove_reference<Fn>::type> loop(pool, fn, count, grain);
+	loop.run(first, last);
+	loop.wait();
+}
+
+// parallel_for on the default pool
+//
+// \param[in] first Index  First iteration, any integer type
+// \param[in] last  Index  One past the last iteration
+// \param[in] fn    Fn     Function called with every index
+// \param[in] grain size_t Maximum iterations per chunk, 0 picks one from the pool size
+//
+// \throws the first exception thrown by fn, remaining chunks are skipped
+template<class Index, class Fn>
+typename std::enable_if<std::is_integral<Index>::value>::type parallel_for(Index first, Index last, Fn&& fn,
+		std::size_t grain = 0) {
+	parallel_for(default_thread_pool(), first, last, std::forward<Fn>(fn), grain);
+}
+
+// Store fn(*it) for every element of [first, last) to the output range,
+// like std::transform. Chunking is the same as with parallel_for.
+//
+// \param[in]  pool   ThreadPool&   Pool to run on
+// \param[in]  first  InputIt       Random access iterator to the first element
+// \param[in]  last   InputIt       Random access iterator past the last element
+// \param[out] result OutputIt      Random access iterator to the output range
+// \param[in]  fn     Fn            Function converting one element
+// \param[in]  grain  size_t        Maximum elements per chunk, 0 picks one from the pool size
+//
+// \return OutputIt Iterator past the last written element
+// \throws the first exception thrown by fn
+template<class InputIt, class OutputIt, class Fn>
+OutputIt parallel_transform(ThreadPool& pool, InputIt first, InputIt last, OutputIt result, Fn&& fn,
+		std::size_t grain = 0) {
+	static_assert(std::is_base_of<std::random_access_iterator_tag,
+					typename std::iterator_traits<InputIt>::iterator_category>::value,
+			"parallel_transform needs random access input iterators");
+	std::ptrdiff_t count = std::distance(first, last);
+	parallel_for(pool, std::ptrdiff_t(0), count, [&](std::ptrdiff_t i) { result[i] = fn(first[i]); }, grain);
+	return result + count;
+}
+
+// parallel_transform on the default pool
+//
+// \param[in]  first  InputIt  Random access iterator to the first element
+// \param[in]  last   InputIt  Random access iterator past the last element
+// \param[out] result OutputIt Random access iterator to the output range
+// \param[in]  fn     Fn       Function converting one element
+// \param[in]  grain  size_t   Maximum elements per chunk, 0 picks one from the pool size
+//
+// \return OutputIt Iterator past the last written element
+// \throws the first exception thrown by fn
+template<class InputIt, class OutputIt, class Fn>
+OutputIt parallel_transform(InputIt first, InputIt last, OutputIt result, Fn&& fn, std::size_t grain = 0) {
+	return parallel_transform(default_thread_pool(), first, last, result, std::forward<Fn>(fn), grain);
+}
+
+} // namespace concurrency
+} // namespace general
+} // namespace drodil
+
+#endif // CONCURRENCY_PARALLEL_HPP_
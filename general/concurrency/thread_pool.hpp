@@ -0,0 +1,410 @@
+// thread_pool.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CONCURRENCY_THREAD_POOL_HPP_
+#define CONCURRENCY_THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "work_stealing_deque.hpp"
+
+namespace drodil {
+namespace general {
+namespace concurrency {
+
+namespace detail {
+
+// Type erased unit of work, owned by the pool until it has run
+class Task {
+public:
+	virtual ~Task() {}
+	virtual void run() = 0;
+};
+
+template<class Fn>
+class FunctionTask : public Task {
+public:
+	explicit FunctionTask(Fn&& fn) : m_fn(std::move(fn)) {}
+	explicit FunctionTask(const Fn& fn) : m_fn(fn) {}
+
+	void run() override {
+		m_fn();
+	}
+
+private:
+	Fn m_fn;
+};
+
+// Work queue of a single worker thread
+struct Worker {
+	WorkStealingDeque<Task*> tasks;
+	std::thread thread;
+};
+
+// Pool and worker index of the calling thread, empty outside of pools
+struct WorkerContext {
+	const void* pool;
+	std::size_t index;
+	std::uint32_t seed;
+};
+
+inline WorkerContext& worker_context() noexcept {
+	static thread_local WorkerContext context = {nullptr, 0, 0};
+	return context;
+}
+
+// Pick a victim for stealing (xorshift32)
+//
+// \param[in|out] seed uint32_t Generator state, must not be zero
+// \param[in]     n    size_t   Number of workers
+//
+// \return size_t
+inline std::size_t random_index(std::uint32_t& seed, std::size_t n) noexcept {
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return static_cast<std::size_t>(seed) % n;
+}
+
+} // namespace detail
+
+// \class ThreadPool
+// Work-stealing thread pool. Every worker owns a Chase-Lev deque: tasks
+// submitted from a worker go to the bottom of its own deque and are run in
+// LIFO order for cache locality, idle workers steal the oldest tasks from the
+// top of the other deques. Tasks submitted from other threads go through a
+// shared injection queue.
+//
+// Workers that run out of work spin briefly and then park on a condition
+// variable, so an idle pool does not consume CPU. Submitting only touches the
+// park mutex when some worker is actually parked.
+//
+// The destructor runs all tasks that are still queued and joins the workers.
+//
+// \code
+// ThreadPool pool;
+// std::future<int> answer = pool.submit([] { return 6 * 7; });
+// pool.post([] { std::cout << "fire and forget" << std::endl; });
+// answer.get();
+// pool.wait_idle();
+// \endcode
+class ThreadPool {
+public:
+	// Construct pool and start the workers
+	//
+	// \param[in] threads size_t Number of workers, 0 for one per hardware thread
+	explicit ThreadPool(std::size_t threads = 0) : m_pending(0), m_sleepers(0), m_epoch(0), m_injected_count(0),
+			m_stopping(false) {
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		m_workers.reserve(threads);
+		for (std::size_t i = 0; i < threads; i++) {
+			m_workers.emplace_back(new detail::Worker());
+		}
+		try {
+			for (std::size_t i = 0; i < threads; i++) {
+				m_workers[i]->thread = std::thread(&ThreadPool::worker_loop, this, i);
+			}
+		} catch (...) {
+			stop();
+			throw;
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Run remaining tasks and join the workers
+	~ThreadPool() {
+		stop();
+	}
+
+	// Number of worker threads
+	//
+	// \return size_t
+	std::size_t size() const noexcept {
+		return m_workers.size();
+	}
+
+	// Check if the calling thread is a worker of this pool
+	//
+	// \return bool
+	bool in_worker() const noexcept {
+		return detail::worker_context().pool == this;
+	}
+
+	// Run function with arguments on the pool
+	//
+	// \param[in] fn   F       Function to run
+	// \param[in] args Args... Arguments, copied or moved like with std::thread
+	//
+	// \return std::future Result of the call, holds the exception if fn throws
+	template<class F, class... Args>
+	std::future<typename std::result_of<typename std::decay<F>::type(typename std::decay<Args>::type...)>::type>
+	submit(F&& fn, Args&&... args) {
+		typedef typename std::result_of<typename std::decay<F>::type(typename std::decay<Args>::type...)>::type
+				result_type;
+		std::packaged_task<result_type()> task(std::bind(std::forward<F>(fn), std::forward<Args>(args)...));
+		std::future<result_type> ret = task.get_future();
+		enqueue(new detail::FunctionTask<std::packaged_task<result_type()>>(std::move(task)));
+		return ret;
+	}
+
+	// Run function on the pool without waiting for a result. Like with
+	// std::thread an exception escaping fn terminates the program.
+	//
+	// \param[in] fn F Function to run
+	template<class F>
+	void post(F&& fn) {
+		enqueue(new detail::FunctionTask<typename std::decay<F>::type>(std::forward<F>(fn)));
+	}
+
+	// Run one queued task on the calling thread. Used to help the pool while
+	// waiting for tasks the caller depends on, so waiting inside a task does
+	// not block a worker.
+	//
+	// \return bool False if no task was found
+	bool run_pending_task() {
+		detail::Task* task = find_task();
+		if (task == nullptr) {
+			return false;
+		}
+		execute(task);
+		return true;
+	}
+
+	// Wait until all submitted tasks have finished. The calling thread helps
+	// running the tasks.
+	//
+	// \throws std::logic_error if called from a worker of this pool
+	void wait_idle() {
+		if (in_worker()) {
+			throw std::logic_error("Cannot wait for the pool to become idle from its own worker");
+		}
+		while (m_pending.load(std::memory_order_acquire) != 0) {
+			if (run_pending_task()) {
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(m_idle_mutex);
+			m_idle_cv.wait(lock, [this] { return m_pending.load(std::memory_order_acquire) == 0; });
+		}
+	}
+
+private:
+	// Number of failed searches before a worker parks
+	static const unsigned spin_rounds = 64;
+
+	void enqueue(detail::Task* task) {
+		m_pending.fetch_add(1, std::memory_order_relaxed);
+		detail::WorkerContext& context = detail::worker_context();
+		if (context.pool == this) {
+			try {
+				m_workers[context.index]->tasks.push(task);
+			} catch (...) {
+				m_pending.fetch_sub(1, std::memory_order_relaxed);
+				delete task;
+				throw;
+			}
+		} else {
+			std::lock_guard<std::mutex> lock(m_injected_mutex);
+			try {
+				m_injected.push_back(task);
+			} catch (...) {
+				m_pending.fetch_sub(1, std::memory_order_relaxed);
+				delete task;
+				throw;
+			}
+			m_injected_count.store(m_injected.size(), std::memory_order_release);
+		}
+		notify();
+	}
+
+	// Wake one parked worker, if any. The fence pairs with the one in park():
+	// either the parking worker sees the new task or this sees the sleeper.
+	void notify() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_sleepers.load(std::memory_order_relaxed) != 0) {
+			std::lock_guard<std::mutex> lock(m_park_mutex);
+			m_epoch++;
+			m_park_cv.notify_one();
+		}
+	}
+
+	// Find task from the own deque, the injection queue or by stealing
+	//
+	// \return detail::Task* nullptr if there is no work
+	detail::Task* find_task() {
+		detail::Task* task = nullptr;
+		detail::WorkerContext& context = detail::worker_context();
+		bool worker = context.pool == this;
+		if (worker && m_workers[context.index]->tasks.take(task)) {
+			return task;
+		}
+		if (m_injected_count.load(std::memory_order_acquire) != 0) {
+			std::lock_guard<std::mutex> lock(m_injected_mutex);
+			if (!m_injected.empty()) {
+				task = m_injected.front();
+				m_injected.pop_front();
+				m_injected_count.store(m_injected.size(), std::memory_order_relaxed);
+				return task;
+			}
+		}
+		if (context.seed == 0) {
+			context.seed = static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+		}
+		std::size_t n = m_workers.size();
+		std::size_t start = detail::random_index(context.seed, n);
+		for (std::size_t i = 0; i < n; i++) {
+			std::size_t victim = start + i < n ? start + i : start + i - n;
+			if (worker && victim == context.index) {
+				continue;
+			}
+			if (m_workers[victim]->tasks.steal(task)) {
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	void execute(detail::Task* task) {
+		try {
+			task->run();
+		} catch (...) {
+			std::terminate();
+		}
+		delete task;
+		if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::lock_guard<std::mutex> lock(m_idle_mutex);
+			m_idle_cv.notify_all();
+		}
+	}
+
+	// Sleep until new work may be available
+	//
+	// \return bool False if the pool is stopping and there is no work left
+	bool park() {
+		std::uint64_t epoch;
+		{
+			std::lock_guard<std::mutex> lock(m_park_mutex);
+			epoch = m_epoch;
+		}
+		m_sleepers.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		// Work submitted before the fence is found here, later submissions
+		// see the sleeper and change the epoch
+		detail::Task* task = find_task();
+		if (task != nullptr) {
+			m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+			execute(task);
+			return true;
+		}
+		if (m_stopping.load(std::memory_order_acquire)) {
+			m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+			return false;
+		}
+		{
+			std::unique_lock<std::mutex> lock(m_park_mutex);
+			m_park_cv.wait(lock, [this, epoch] {
+				return m_epoch != epoch || m_stopping.load(std::memory_order_acquire);
+			});
+		}
+		m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void worker_loop(std::size_t index) {
+		detail::WorkerContext& context = detail::worker_context();
+		context.pool = this;
+		context.index = index;
+		context.seed = static_cast<std::uint32_t>(index * 2654435761u) | 1;
+		unsigned idle = 0;
+		for (;;) {
+			detail::Task* task = find_task();
+			if (task != nullptr) {
+				execute(task);
+				idle = 0;
+			} else if (idle < spin_rounds) {
+				idle++;
+				std::this_thread::yield();
+			} else if (!park()) {
+				break;
+			}
+		}
+		context.pool = nullptr;
+	}
+
+	void stop() {
+		m_stopping.store(true, std::memory_order_release);
+		{
+			std::lock_guard<std::mutex> lock(m_park_mutex);
+			m_epoch++;
+			m_park_cv.notify_all();
+		}
+		for (std::unique_ptr<detail::Worker>& worker : m_workers) {
+			if (worker->thread.joinable()) {
+				worker->thread.join();
+			}
+		}
+		// Only reached without workers, e.g. when starting a thread failed
+		for (detail::Task* task : m_injected) {
+			delete task;
+		}
+		m_injected.clear();
+	}
+
+	std::vector<std::unique_ptr<detail::Worker>> m_workers;
+	std::atomic<std::size_t> m_pending;
+	std::atomic<std::size_t> m_sleepers;
+	std::uint64_t m_epoch;
+	std::mutex m_park_mutex;
+	std::condition_variable m_park_cv;
+	std::mutex m_idle_mutex;
+	std::condition_variable m_idle_cv;
+	std::mutex m_injected_mutex;
+	std::deque<detail::Task*> m_injected;
+	std::atomic<std::size_t> m_injected_count;
+	std::atomic<bool> m_stopping;
+};
+
+} // namespace concurrency
+} // namespace general
+} // namespace drodil
+
+#endif // CONCURRENCY_THREAD_POOL_HPP_
@@ -0,0 +1,211 @@
+// work_stealing_deque.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CONCURRENCY_WORK_STEALING_DEQUE_HPP_
+#define CONCURRENCY_WORK_STEALING_DEQUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace drodil {
+namespace general {
+namespace concurrency {
+
+namespace detail {
+
+// Assumed size of a cache line, used to keep hot atomics apart
+const std::size_t cache_line_size = 64;
+
+// Circular array of atomic slots, the capacity is a power of two
+template<class T>
+class DequeArray {
+public:
+	// Construct array
+	//
+	// \param[in] capacity size_t Number of slots, must be a power of two
+	explicit DequeArray(std::size_t capacity)
+		: m_mask(capacity - 1), m_slots(new std::atomic<T>[capacity]) {}
+
+	std::size_t capacity() const noexcept {
+		return m_mask + 1;
+	}
+
+	T get(std::int64_t index) const noexcept {
+		return m_slots[static_cast<std::size_t>(index) & m_mask].load(std::memory_order_relaxed);
+	}
+
+	void put(std::int64_t index, T value) noexcept {
+		m_slots[static_cast<std::size_t>(index) & m_mask].store(value, std::memory_order_relaxed);
+	}
+
+	// Copy the live range [top, bottom) into an array twice the size
+	//
+	// \param[in] top    int64_t Index of the oldest element
+	// \param[in] bottom int64_t Index past the newest element
+	//
+	// \return DequeArray*
+	DequeArray* grow(std::int64_t top, std::int64_t bottom) const {
+		DequeArray* ret = new DequeArray(capacity() * 2);
+		for (std::int64_t i = top; i < bottom; i++) {
+			ret->put(i, get(i));
+		}
+		return ret;
+	}
+
+private:
+	std::size_t m_mask;
+	std::unique_ptr<std::atomic<T>[]> m_slots;
+};
+
+} // namespace detail
+
+// \class WorkStealingDeque
+// Chase-Lev deque (Chase and Lev 2005, memory orders from Le et al. 2013).
+// A single owner thread pushes and takes at the bottom in LIFO order, any
+// other thread may steal from the top in FIFO order. The owner never takes a
+// lock and thieves only contend on one compare-exchange of the top index.
+//
+// Arrays replaced by growing are kept until the deque is destroyed, because a
+// thief may still be reading from them. Growing doubles the capacity so the
+// retired arrays take at most as much memory as the live one.
+//
+// \code
+// WorkStealingDeque<Task*> deque;
+// deque.push(task);            // owner
+// Task* task;
+// if (deque.take(task)) { ... }  // owner
+// if (deque.steal(task)) { ... } // any thread
+// \endcode
+template<class T>
+class WorkStealingDeque {
+	static_assert(std::is_trivially_copyable<T>::value, "Elements must be trivially copyable, e.g. pointers");
+
+public:
+	// Construct empty deque
+	//
+	// \param[in] capacity size_t Initial capacity, rounded up to a power of two
+	explicit WorkStealingDeque(std::size_t capacity = 256) : m_top(0), m_bottom(0) {
+		std::size_t size = 2;
+		while (size < capacity) {
+			size *= 2;
+		}
+		m_retired.emplace_back(new detail::DequeArray<T>(size));
+		m_array.store(m_retired.back().get(), std::memory_order_relaxed);
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	// Push element to the bottom, only called by the owner
+	//
+	// \param[in] value T Element to push
+	void push(T value) {
+		std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		std::int64_t top = m_top.load(std::memory_order_acquire);
+		detail::DequeArray<T>* array = m_array.load(std::memory_order_relaxed);
+		if (bottom - top > static_cast<std::int64_t>(array->capacity()) - 1) {
+			array = array->grow(top, bottom);
+			m_retired.emplace_back(array);
+			m_array.store(array, std::memory_order_release);
+		}
+		array->put(bottom, value);
+		m_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	// Take the newest element from the bottom, only called by the owner
+	//
+	// \param[out] value T Taken element
+	//
+	// \return bool False if the deque was empty
+	bool take(T& value) noexcept {
+		std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		detail::DequeArray<T>* array = m_array.load(std::memory_order_relaxed);
+		m_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t top = m_top.load(std::memory_order_relaxed);
+		if (top > bottom) {
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+		value = array->get(bottom);
+		if (top == bottom) {
+			// Last element, race against the thieves for it
+			bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+					std::memory_order_relaxed);
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	// Steal the oldest element from the top, may be called by any thread
+	//
+	// \param[out] value T Stolen element
+	//
+	// \return bool False if the deque was empty or another thread won the element
+	bool steal(T& value) noexcept {
+		std::int64_t top = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+		if (top >= bottom) {
+			return false;
+		}
+		detail::DequeArray<T>* array = m_array.load(std::memory_order_acquire);
+		value = array->get(top);
+		return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	// Approximate number of elements, exact only when called by the owner
+	//
+	// \return size_t
+	std::size_t size() const noexcept {
+		std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+		std::int64_t top = m_top.load(std::memory_order_relaxed);
+		return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+	}
+
+	bool empty() const noexcept {
+		return size() == 0;
+	}
+
+private:
+	// Top and bottom are written by different threads, keep them on own lines
+	std::atomic<std::int64_t> m_top;
+	char m_top_padding[detail::cache_line_size - sizeof(std::atomic<std::int64_t>)];
+	std::atomic<std::int64_t> m_bottom;
+	std::atomic<detail::DequeArray<T>*> m_array;
+	char m_bottom_padding[detail::cache_line_size - sizeof(std::atomic<std::int64_t>) -
+			sizeof(std::atomic<detail::DequeArray<T>*>)];
+	std::vector<std::unique_ptr<detail::DequeArray<T>>> m_retired;
+};
+
+} // namespace concurrency
+} // namespace general
+} // namespace drodil
+
+#endif // CONCURRENCY_WORK_STEALING_DEQUE_HPP_
@@ -0,0 +1,284 @@
+// atomic_enum_flags.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OPERATORS_ATOMIC_ENUM_FLAGS_HPP_
+#define OPERATORS_ATOMIC_ENUM_FLAGS_HPP_
+
+#include <atomic>
+
+#include "enum_flags.hpp"
+
+namespace drodil {
+namespace general {
+namespace enum_flags {
+
+namespace detail {
+
+// Strongest memory order allowed for a failed compare-exchange
+//
+// \param[in] order std::memory_order Order of the successful exchange
+//
+// \return std::memory_order
+constexpr std::memory_order failure_order(std::memory_order order) noexcept {
+	return order == std::memory_order_acq_rel ? std::memory_order_acquire
+	       : order == std::memory_order_release ? std::memory_order_relaxed
+	                                            : order;
+}
+
+} // namespace detail
+
+// \class AtomicEnumFlags
+// Lock-free set of flags of a single enum type shared between threads.
+// Every operation takes an optional memory order, sequential consistency
+// is used by default like with std::atomic.
+//
+// \code
+// AtomicEnumFlags<State> state;
+// state.fetch_set(State::Open);
+// // Start closing only if open and not already closing
+// if (state.transition(State::Open, State::Closing, State::Closing)) { ... }
+// \endcode
+template<class Enum>
+class AtomicEnumFlags {
+public:
+	typedef EnumFlags<Enum> flags_type;
+	typedef typename flags_type::mask_type mask_type;
+
+	// Construct empty set
+	AtomicEnumFlags() noexcept : m_mask(0) {}
+
+	// Construct set with initial flags
+	//
+	// \param[in] flags flags_type Initial flags
+	AtomicEnumFlags(flags_type flags) noexcept : m_mask(flags.mask()) {}
+
+	AtomicEnumFlags(const AtomicEnumFlags&) = delete;
+	AtomicEnumFlags& operator=(const AtomicEnumFlags&) = delete;
+
+	// Check if operations are lock-free on this platform
+	//
+	// \return bool
+	bool is_lock_free() const noexcept { return m_mask.is_lock_free(); }
+
+	// Read the current flags
+	//
+	// \param[in] order std::memory_order Memory order of the load
+	//
+	// \return flags_type
+	flags_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+		return flags_type::from_mask(m_mask.load(order));
+	}
+
+	// Replace the flags
+	//
+	// \param[in] flags flags_type        New flags
+	// \param[in] order std::memory_order Memory order of the store
+	void store(flags_type flags, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		m_mask.store(flags.mask(), order);
+	}
+
+	// Replace the flags and return the previous ones
+	//
+	// \param[in] flags flags_type        New flags
+	// \param[in] order std::memory_order Memory order of the exchange
+	//
+	// \return flags_type Previous flags
+	flags_type exchange(flags_type flags, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return flags_type::from_mask(m_mask.exchange(flags.mask(), order));
+	}
+
+	// Check if all bits of the flag are set
+	//
+	// \param[in] flag  Enum              Flag to test
+	// \param[in] order std::memory_order Memory order of the load
+	//
+	// \return bool
+	bool test(Enum flag, std::memory_order order = std::memory_order_seq_cst) const noexcept {
+		return load(order).test(flag);
+	}
+
+	// Atomically OR the flags
+	//
+	// \param[in] flags flags_type        Flags to OR
+	// \param[in] order std::memory_order Memory order of the operation
+	//
+	// \return flags_type Previous flags
+	flags_type fetch_or(flags_type flags, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return flags_type::from_mask(m_mask.fetch_or(flags.mask(), order));
+	}
+
+	// Atomically AND the flags
+	//
+	// \param[in] flags flags_type        Flags to AND
+	// \param[in] order std::memory_order Memory order of the operation
+	//
+	// \return flags_type Previous flags
+	flags_type fetch_and(flags_type flags, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return flags_type::from_mask(m_mask.fetch_and(flags.mask(), order));
+	}
+
+	// Atomically XOR the flags
+	//
+	// \param[in] flags flags_type        Flags to XOR
+	// \param[in] order std::memory_order Memory order of the operation
+	//
+	// \return flags_type Previous flags
+	flags_type fetch_xor(flags_type flags, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return flags_type::from_mask(m_mask.fetch_xor(flags.mask(), order));
+	}
+
+	// Atomically set the flags
+	//
+	// \param[in] flags flags_type        Flags to set
+	// \param[in] order std::memory_order Memory order of the operation
+	//
+	// \return flags_type Previous flags
+	flags_type fetch_set(flags_type flags, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return fetch_or(flags, order);
+	}
+
+	// Atomically clear the flags
+	//
+	// \param[in] flags flags_type        Flags to clear
+	// \param[in] order std::memory_order Memory order of the operation
+	//
+	// \return flags_type Previous flags
+	flags_type fetch_clear(flags_type flags, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return fetch_and(~flags, order);
+	}
+
+	// Atomically toggle the flags
+	//
+	// \param[in] flags flags_type        Flags to toggle
+	// \param[in] order std::memory_order Memory order of the operation
+	//
+	// \return flags_type Previous flags
+	flags_type fetch_toggle(flags_type flags, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return fetch_xor(flags, order);
+	}
+
+	// Set the flag and check if this call was the one to set it
+	//
+	// \param[in] flag  Enum              Flag to set
+	// \param[in] order std::memory_order Memory order of the operation
+	//
+	// \return bool True if the flag was not set before
+	bool test_and_set(Enum flag, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return !fetch_or(flag, order).any_of(flag);
+	}
+
+	// Replace the flags if they equal the expected ones, may fail spuriously
+	//
+	// \param[in|out] expected flags_type        Expected flags, updated to current flags on failure
+	// \param[in]     desired  flags_type        New flags
+	// \param[in]     order    std::memory_order Memory order of a successful exchange
+	//
+	// \return bool True if the flags were replaced
+	bool compare_exchange_weak(flags_type& expected, flags_type desired,
+			std::memory_order order = std::memory_order_seq_cst) noexcept {
+		mask_type mask = expected.mask();
+		bool ret = m_mask.compare_exchange_weak(mask, desired.mask(), order, detail::failure_order(order));
+		expected = flags_type::from_mask(mask);
+		return ret;
+	}
+
+	// Replace the flags if they equal the expected ones
+	//
+	// \param[in|out] expected flags_type        Expected flags, updated to current flags on failure
+	// \param[in]     desired  flags_type        New flags
+	// \param[in]     order    std::memory_order Memory order of a successful exchange
+	//
+	// \return bool True if the flags were replaced
+	bool compare_exchange_strong(flags_type& expected, flags_type desired,
+			std::memory_order order = std::memory_order_seq_cst) noexcept {
+		mask_type mask = expected.mask();
+		bool ret = m_mask.compare_exchange_strong(mask, desired.mask(), order, detail::failure_order(order));
+		expected = flags_type::from_mask(mask);
+		return ret;
+	}
+
+	// Atomically set and clear flags only if the required flags are set and
+	// none of the forbidden flags are, e.g. "set B only if A is set"
+	//
+	// \param[in]  required  flags_type        Flags that must all be set
+	// \param[in]  forbidden flags_type        Flags that must all be clear
+	// \param[in]  to_set    flags_type        Flags to set
+	// \param[in]  to_clear  flags_type        Flags to clear, applied before to_set
+	// \param[in]  order     std::memory_order Memory order of a successful transition
+	//
+	// \return bool True if the transition was made
+	bool transition(flags_type required, flags_type forbidden, flags_type to_set, flags_type to_clear = flags_type(),
+			std::memory_order order = std::memory_order_seq_cst) noexcept {
+		flags_type previous;
+		return transition(required, forbidden, to_set, to_clear, previous, order);
+	}
+
+	// Same as above, also returns the flags seen by the last attempt
+	//
+	// \param[out] previous flags_type Flags before the transition, or the ones
+	//                                 that prevented it
+	bool transition(flags_type required, flags_type forbidden, flags_type to_set, flags_type to_clear,
+			flags_type& previous, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		const std::memory_order failure = detail::failure_order(order);
+		mask_type current = m_mask.load(failure);
+		while (true) {
+			previous = flags_type::from_mask(current);
+			if (!previous.all_of(required) || previous.any_of(forbidden)) {
+				return false;
+			}
+			mask_type desired = previous.without(to_clear).with(to_set).mask();
+			// Exchange even when nothing changes, so a successful transition
+			// always has the release semantics of order
+			if (m_mask.compare_exchange_weak(current, desired, order, failure)) {
+				return true;
+			}
+		}
+	}
+
+	// Atomically apply a function to the flags with a compare-exchange loop
+	//
+	// \param[in] fn    Function taking and returning flags_type, may be called many times
+	// \param[in] order std::memory_order Memory order of the successful exchange
+	//
+	// \return flags_type Previous flags
+	template<typename Fn>
+	flags_type update(Fn fn, std::memory_order order = std::memory_order_seq_cst) {
+		const std::memory_order failure = detail::failure_order(order);
+		mask_type current = m_mask.load(failure);
+		while (!m_mask.compare_exchange_weak(current, fn(flags_type::from_mask(current)).mask(), order, failure)) {
+		}
+		return flags_type::from_mask(current);
+	}
+
+	operator flags_type() const noexcept { return load(); }
+
+private:
+	std::atomic<mask_type> m_mask;
+};
+
+} // namespace enum_flags
+} // namespace general
+} // namespace drodil
+
+#endif // OPERATORS_ATOMIC_ENUM_FLAGS_HPP_
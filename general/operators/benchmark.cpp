@@ -0,0 +1,409 @@
+// benchmark.cpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "atomic_enum_flags.hpp"
+#include "binary_buffer.hpp"
+#include "binary_operators.hpp"
+#include "dynamic_bitset.hpp"
+#include "enum_flags.hpp"
+#include "enum_names.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using drodil::general::enum_flags::AtomicEnumFlags;
+using drodil::general::enum_flags::EnumFlags;
+
+namespace {
+
+// Prevents the compiler from optimizing away benchmarked results
+volatile std::size_t g_sink = 0;
+
+// Sixteen flags, values are created by shifting
+enum class Feature : std::uint16_t {
+	None = 0
+};
+
+const unsigned feature_count = 16;
+
+Feature feature(unsigned bit) {
+	return static_cast<Feature>(1u << bit);
+}
+
+// Run fn rounds times and report time per processed item
+template<typename Fn>
+void run(const char* name, std::size_t rounds, std::size_t items, Fn fn) {
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < rounds; i++) {
+		fn();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	std::printf("%-40s %12.3f ns/item\n", name, ns / (rounds * items));
+}
+
+// Count set flags by testing every enumerator with the free operators
+std::size_t count_free(const std::vector<Feature>& values) {
+	using namespace drodil::general::binary_operators;
+	std::size_t ret = 0;
+	for (Feature value : values) {
+		for (unsigned bit = 0; bit < feature_count; bit++) {
+			ret += (value & feature(bit)) == feature(bit);
+		}
+	}
+	return ret;
+}
+
+std::size_t count_flags(const std::vector<EnumFlags<Feature>>& values) {
+	std::size_t ret = 0;
+	for (EnumFlags<Feature> value : values) {
+		ret += value.count();
+	}
+	return ret;
+}
+
+// Visit set flags by testing every enumerator with the free operators
+std::size_t visit_free(const std::vector<Feature>& values) {
+	using namespace drodil::general::binary_operators;
+	std::size_t ret = 0;
+	for (Feature value : values) {
+		for (unsigned bit = 0; bit < feature_count; bit++) {
+			if ((value & feature(bit)) == feature(bit)) {
+				ret += static_cast<std::size_t>(feature(bit));
+			}
+		}
+	}
+	return ret;
+}
+
+std::size_t visit_flags(const std::vector<EnumFlags<Feature>>& values) {
+	std::size_t ret = 0;
+	for (EnumFlags<Feature> value : values) {
+		for (Feature f : value) {
+			ret += static_cast<std::size_t>(f);
+		}
+	}
+	return ret;
+}
+
+void update_free(std::vector<Feature>& values) {
+	using namespace drodil::general::binary_operators;
+	for (Feature& value : values) {
+		value |= feature(1);
+		value &= ~feature(3);
+		value ^= feature(5);
+	}
+}
+
+void update_flags(std::vector<EnumFlags<Feature>>& values) {
+	for (EnumFlags<Feature>& value : values) {
+		value.set(feature(1)).clear(feature(3)).toggle(feature(5));
+	}
+}
+
+enum class Color : std::uint8_t {
+	Red = 1 << 0, Green = 1 << 1, Blue = 1 << 2, Alpha = 1 << 3
+};
+
+// Name tables as they would be written by hand
+const std::map<Color, std::string> color_names{{Color::Red, "Red"}, {Color::Green, "Green"},
+		{Color::Blue, "Blue"}, {Color::Alpha, "Alpha"}};
+const std::map<std::string, Color> color_values{{"Red", Color::Red}, {"Green", Color::Green},
+		{"Blue", Color::Blue}, {"Alpha", Color::Alpha}};
+
+void bench_names() {
+	namespace ef = drodil::general::enum_flags;
+	const EnumFlags<Color> color = EnumFlags<Color>(Color::Red) | Color::Blue | Color::Alpha;
+	const std::string text = "Red|Blue|Alpha";
+	const std::size_t ops = 1000000;
+
+	run("names/to_string/map", ops, 1, [&] {
+		std::string ret;
+		for (Color c : color) {
+			if (!ret.empty()) {
+				ret += '|';
+			}
+			ret += color_names.at(c);
+		}
+		g_sink += ret.size();
+	});
+	run("names/to_string/reflected", ops, 1, [&] { g_sink += ef::to_string(color).size(); });
+	run("names/parse/map", ops, 1, [&] {
+		EnumFlags<Color> ret;
+		std::size_t pos = 0;
+		while (pos <= text.size()) {
+			std::size_t end = std::min(text.find('|', pos), text.size());
+			ret |= color_values.at(text.substr(pos, end - pos));
+			pos = end + 1;
+		}
+		g_sink += ret.mask();
+	});
+	run("names/parse/reflected", ops, 1, [&] {
+		EnumFlags<Color> ret;
+		ef::parse(text, ret);
+		g_sink += ret.mask();
+	});
+}
+
+// Ten million bit sets against std::vector<bool>
+void bench_bitset() {
+	using drodil::general::dynamic_bitset::DynamicBitset;
+	using drodil::general::dynamic_bitset::RankSelect;
+	const std::size_t size = 10000000;
+	std::mt19937_64 rng(42);
+	DynamicBitset a(size);
+	DynamicBitset b(size);
+	std::vector<bool> va(size);
+	std::vector<bool> vb(size);
+	for (std::size_t i = 0; i < size; i++) {
+		std::uint64_t r = rng();
+		// a is sparse, b is dense
+		if (r % 64 == 0) {
+			a.set(i);
+			va[i] = true;
+		}
+		if (r & 64) {
+			b.set(i);
+			vb[i] = true;
+		}
+	}
+
+	run("bitset/count/vector<bool>", 5, size, [&] { g_sink += std::count(vb.begin(), vb.end(), true); });
+	run("bitset/count/DynamicBitset", 50, size, [&] { g_sink += b.count(); });
+	run("bitset/and/vector<bool>", 5, size, [&] {
+		std::vector<bool> r(va);
+		for (std::size_t i = 0; i < size; i++) {
+			r[i] = r[i] && vb[i];
+		}
+		g_sink += r[size / 2];
+	});
+	run("bitset/and/DynamicBitset", 50, size, [&] {
+		DynamicBitset r(a);
+		r &= b;
+		g_sink += r[size / 2];
+	});
+	run("bitset/iterate_sparse/vector<bool>", 5, size, [&] {
+		for (std::size_t i = 0; i < size; i++) {
+			if (va[i]) {
+				g_sink += i;
+			}
+		}
+	});
+	run("bitset/iterate_sparse/DynamicBitset", 50, size, [&] {
+		std::size_t sum = 0;
+		a.for_each_set([&](std::size_t i) { sum += i; });
+		g_sink += sum;
+	});
+
+	RankSelect index(b);
+	std::vector<std::size_t> queries;
+	for (std::size_t i = 0; i < 1000000; i++) {
+		queries.push_back(rng() % size);
+	}
+	run("bitset/rank/RankSelect", 1, queries.size(), [&] {
+		for (std::size_t q : queries) {
+			g_sink += index.rank(q);
+		}
+	});
+	run("bitset/select/RankSelect", 1, queries.size(), [&] {
+		for (std::size_t q : queries) {
+			g_sink += index.select(q % index.ones());
+		}
+	});
+}
+
+// Four million values through the binary reader and writer
+void bench_binary_buffer() {
+	using namespace drodil::general::binary_buffer;
+	const std::size_t count = 4000000;
+	std::mt19937_64 rng(42);
+	std::vector<std::uint32_t> values(count);
+	for (std::uint32_t& value : values) {
+		// Mostly small values like lengths and offsets
+		value = static_cast<std::uint32_t>(rng() >> (32 + rng() % 32));
+	}
+
+	BinaryWriter fixed(count * 4);
+	for (std::uint32_t value : values) {
+		fixed.write(value, Endian::big);
+	}
+	run("buffer/read_u32_be/shifts", 10, count, [&] {
+		const unsigned char* p = fixed.data();
+		std::uint32_t sum = 0;
+		for (std::size_t i = 0; i < count; i++, p += 4) {
+			sum += (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | p[3];
+		}
+		g_sink += sum;
+	});
+	run("buffer/read_u32_be/BinaryReader", 10, count, [&] {
+		BinaryReader reader(fixed.data(), fixed.size());
+		std::uint32_t sum = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			sum += reader.read<std::uint32_t>(Endian::big);
+		}
+		g_sink += sum;
+	});
+
+	BinaryWriter varints;
+	run("buffer/write_uleb128", 10, count, [&] {
+		varints.clear();
+		for (std::uint32_t value : values) {
+			varints.write_uleb128(value);
+		}
+		g_sink += varints.size();
+	});
+	run("buffer/read_uleb128", 10, count, [&] {
+		BinaryReader reader(varints.data(), varints.size());
+		std::uint64_t sum = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			sum += reader.read_uleb128();
+		}
+		g_sink += sum;
+	});
+
+	std::vector<unsigned char> packed(packed_size(count, 32));
+	std::vector<std::uint32_t> unpacked(count);
+	const unsigned widths[] = {4, 8, 13, 16};
+	for (unsigned bits : widths) {
+		const std::string suffix = "/" + std::to_string(bits) + "bits";
+		run(("buffer/pack_bits" + suffix).c_str(), 10, count, [&] {
+			pack_bits(values.data(), count, bits, packed.data());
+			g_sink += packed[0];
+		});
+		run(("buffer/unpack_bits" + suffix).c_str(), 10, count, [&] {
+			unpack_bits(packed.data(), count, bits, unpacked.data());
+			g_sink += unpacked[0];
+		});
+	}
+}
+
+// Run fn(thread index) on threads concurrently and report time per operation
+template<typename Fn>
+void run_threads(const std::string& name, unsigned threads, std::size_t ops_per_thread, Fn fn) {
+	std::vector<std::thread> workers;
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned t = 0; t < threads; t++) {
+		workers.emplace_back([&fn, t] { fn(t); });
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	std::printf("%-40s %12.3f ns/op\n", name.c_str(), ns / (threads * ops_per_thread));
+}
+
+// Every thread sets and clears its own flag in a shared set
+void bench_contention() {
+	const std::size_t ops = 1000000;
+	// At least a few threads even on small machines to show the contention
+	unsigned max_threads = std::thread::hardware_concurrency();
+	if (max_threads < 4) {
+		max_threads = 4;
+	}
+	for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+		const std::string suffix = "/" + std::to_string(threads) + "threads";
+
+		std::mutex mutex;
+		Feature locked = Feature::None;
+		run_threads("contention/mutex" + suffix, threads, ops, [&](unsigned t) {
+			using namespace drodil::general::binary_operators;
+			const Feature mine = feature(t % feature_count);
+			for (std::size_t i = 0; i < ops / 2; i++) {
+				std::lock_guard<std::mutex> lock(mutex);
+				locked |= mine;
+			}
+			for (std::size_t i = 0; i < ops / 2; i++) {
+				std::lock_guard<std::mutex> lock(mutex);
+				locked &= ~mine;
+			}
+		});
+
+		AtomicEnumFlags<Feature> shared;
+		run_threads("contention/fetch_set+fetch_clear" + suffix, threads, ops, [&](unsigned t) {
+			const Feature mine = feature(t % feature_count);
+			for (std::size_t i = 0; i < ops / 2; i++) {
+				shared.fetch_set(mine, std::memory_order_acq_rel);
+				shared.fetch_clear(mine, std::memory_order_acq_rel);
+			}
+		});
+
+		// Compare-exchange loop, claims the flag only when the previous owner released it
+		run_threads("contention/transition" + suffix, threads, ops, [&](unsigned t) {
+			const Feature mine = feature(t % feature_count);
+			const Feature ready = feature(feature_count - 1);
+			for (std::size_t i = 0; i < ops / 2; i++) {
+				shared.transition({}, mine, mine, {}, std::memory_order_acq_rel);
+				shared.transition(mine, ready, {}, mine, std::memory_order_acq_rel);
+			}
+		});
+		g_sink += shared.load().mask() + static_cast<std::size_t>(locked);
+	}
+}
+
+} // namespace
+
+int main() {
+	const std::size_t size = 1 << 20;
+	std::mt19937 rng(42);
+	std::vector<Feature> sparse;
+	std::vector<Feature> dense;
+	for (std::size_t i = 0; i < size; i++) {
+		sparse.push_back(feature(rng() % feature_count));
+		dense.push_back(static_cast<Feature>(rng() & 0xffff));
+	}
+	std::vector<EnumFlags<Feature>> sparse_flags(sparse.begin(), sparse.end());
+	std::vector<EnumFlags<Feature>> dense_flags(dense.begin(), dense.end());
+
+	const std::size_t rounds = 20;
+	run("count/sparse/free_operators", rounds, size, [&] { g_sink += count_free(sparse); });
+	run("count/sparse/EnumFlags", rounds, size, [&] { g_sink += count_flags(sparse_flags); });
+	run("count/dense/free_operators", rounds, size, [&] { g_sink += count_free(dense); });
+	run("count/dense/EnumFlags", rounds, size, [&] { g_sink += count_flags(dense_flags); });
+	run("visit/sparse/free_operators", rounds, size, [&] { g_sink += visit_free(sparse); });
+	run("visit/sparse/EnumFlags", rounds, size, [&] { g_sink += visit_flags(sparse_flags); });
+	run("visit/dense/free_operators", rounds, size, [&] { g_sink += visit_free(dense); });
+	run("visit/dense/EnumFlags", rounds, size, [&] { g_sink += visit_flags(dense_flags); });
+	run("update/free_operators", rounds, size, [&] {
+		update_free(dense);
+		g_sink += static_cast<std::size_t>(dense[0]);
+	});
+	run("update/EnumFlags", rounds, size, [&] {
+		update_flags(dense_flags);
+		g_sink += dense_flags[0].mask();
+	});
+
+	bench_names();
+	bench_bitset();
+	bench_binary_buffer();
+	bench_contention();
+	return 0;
+}
@@ -0,0 +1,674 @@
+// binary_buffer.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OPERATORS_BINARY_BUFFER_HPP_
+#define OPERATORS_BINARY_BUFFER_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace drodil {
+namespace general {
+namespace binary_buffer {
+
+// Byte order of values in a buffer
+enum class Endian {
+	little, big,
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	native = big
+#else
+	native = little
+#endif
+};
+
+namespace detail {
+
+inline std::uint8_t byte_swap(std::uint8_t value) noexcept {
+	return value;
+}
+
+inline std::uint16_t byte_swap(std::uint16_t value) noexcept {
+	return static_cast<std::uint16_t>((value >> 8) | (value << 8));
+}
+
+inline std::uint32_t byte_swap(std::uint32_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_bswap32(value);
+#else
+	return (value >> 24) | ((value >> 8) & 0xff00u) | ((value << 8) & 0xff0000u) | (value << 24);
+#endif
+}
+
+inline std::uint64_t byte_swap(std::uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_bswap64(value);
+#else
+	return (static_cast<std::uint64_t>(byte_swap(static_cast<std::uint32_t>(value))) << 32) |
+			byte_swap(static_cast<std::uint32_t>(value >> 32));
+#endif
+}
+
+// Unsigned integer with the given size in bytes
+template<std::size_t Size> struct uint_of_size;
+template<> struct uint_of_size<1> { typedef std::uint8_t type; };
+template<> struct uint_of_size<2> { typedef std::uint16_t type; };
+template<> struct uint_of_size<4> { typedef std::uint32_t type; };
+template<> struct uint_of_size<8> { typedef std::uint64_t type; };
+
+// Read value of arithmetic type from possibly unaligned memory
+template<class T>
+inline T load(const unsigned char* data, Endian endian) noexcept {
+	typename uint_of_size<sizeof(T)>::type bits;
+	std::memcpy(&bits, data, sizeof(bits));
+	if (endian != Endian::native) {
+		bits = byte_swap(bits);
+	}
+	T ret;
+	std::memcpy(&ret, &bits, sizeof(ret));
+	return ret;
+}
+
+// Write value of arithmetic type to possibly unaligned memory
+template<class T>
+inline void store(unsigned char* data, T value, Endian endian) noexcept {
+	typename uint_of_size<sizeof(T)>::type bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	if (endian != Endian::native) {
+		bits = byte_swap(bits);
+	}
+	std::memcpy(data, &bits, sizeof(bits));
+}
+
+// Number of trailing zero bits of a non-zero value
+inline unsigned trailing_zeros(std::uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+	unsigned ret = 0;
+	while (!(value & 1)) {
+		value >>= 1;
+		++ret;
+	}
+	return ret;
+#endif
+}
+
+// Number of significant bits, at least one
+inline unsigned bit_width(std::uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return 64 - static_cast<unsigned>(__builtin_clzll(value | 1));
+#else
+	unsigned ret = 1;
+	while (value >>= 1) {
+		++ret;
+	}
+	return ret;
+#endif
+}
+
+// Join the low 7 bits of every byte into one value
+inline std::uint64_t compact_groups(std::uint64_t word) noexcept {
+	return (word & 0x7full) | ((word >> 1) & (0x7full << 7)) | ((word >> 2) & (0x7full << 14)) |
+			((word >> 3) & (0x7full << 21)) | ((word >> 4) & (0x7full << 28)) | ((word >> 5) & (0x7full << 35)) |
+			((word >> 6) & (0x7full << 42)) | ((word >> 7) & (0x7full << 49));
+}
+
+// Spread 7-bit groups of the value to the low bits of every byte
+inline std::uint64_t spread_groups(std::uint64_t value) noexcept {
+	return (value & 0x7full) | ((value & (0x7full << 7)) << 1) | ((value & (0x7full << 14)) << 2) |
+			((value & (0x7full << 21)) << 3) | ((value & (0x7full << 28)) << 4) | ((value & (0x7full << 35)) << 5) |
+			((value & (0x7full << 42)) << 6) | ((value & (0x7full << 49)) << 7);
+}
+
+inline void check_bits(unsigned bits) {
+	if (bits == 0 || bits > 32) {
+		throw std::invalid_argument("Packed width must be between 1 and 32 bits");
+	}
+}
+
+} // namespace detail
+
+// Get number of bytes needed for bit-packed values
+//
+// \param[in] count size_t   Number of values
+// \param[in] bits  unsigned Width of a value in bits
+//
+// \return size_t
+inline std::size_t packed_size(std::size_t count, unsigned bits) noexcept {
+	return (count * bits + 7) / 8;
+}
+
+// Pack values to a little endian bit stream, value i occupies bits
+// [i * bits, (i + 1) * bits). Values are truncated to the width.
+//
+// \param[in]  values const std::uint32_t* Values to pack
+// \param[in]  count  size_t               Number of values
+// \param[in]  bits   unsigned             Width of a value, 1 to 32
+// \param[out] out    unsigned char*       Buffer of at least packed_size(count, bits) bytes
+//
+// \throws std::invalid_argument if bits is out of range
+inline void pack_bits(const std::uint32_t* values, std::size_t count, unsigned bits, unsigned char* out) {
+	detail::check_bits(bits);
+	std::size_t i = 0;
+#if defined(__SSE2__) && !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	// Byte aligned widths map directly to narrowing packs
+	if (bits == 8) {
+		const __m128i mask = _mm_set1_epi32(0xff);
+		for (; i + 16 <= count; i += 16) {
+			const __m128i* in = reinterpret_cast<const __m128i*>(values + i);
+			__m128i a = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(in), mask),
+					_mm_and_si128(_mm_loadu_si128(in + 1), mask));
+			__m128i b = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(in + 2), mask),
+					_mm_and_si128(_mm_loadu_si128(in + 3), mask));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(a, b));
+		}
+	} else if (bits == 16) {
+		for (; i + 8 <= count; i += 8) {
+			const __m128i* in = reinterpret_cast<const __m128i*>(values + i);
+			// Sign extend the low halves so the saturating pack keeps them intact
+			__m128i a = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(in), 16), 16);
+			__m128i b = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(in + 1), 16), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_packs_epi32(a, b));
+		}
+	} else if (bits == 4) {
+		const __m128i mask = _mm_set1_epi32(0x0f);
+		for (; i + 32 <= count; i += 32) {
+			const __m128i* in = reinterpret_cast<const __m128i*>(values + i);
+			__m128i bytes[2];
+			for (int half = 0; half < 2; half++) {
+				__m128i a = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(in + 4 * half), mask),
+						_mm_and_si128(_mm_loadu_si128(in + 4 * half + 1), mask));
+				__m128i b = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(in + 4 * half + 2), mask),
+						_mm_and_si128(_mm_loadu_si128(in + 4 * half + 3), mask));
+				bytes[half] = _mm_packus_epi16(a, b);
+			}
+			// Merge neighbouring nibbles within 16-bit lanes
+			__m128i lo = _mm_packus_epi16(_mm_and_si128(bytes[0], _mm_set1_epi16(0x00ff)),
+					_mm_and_si128(bytes[1], _mm_set1_epi16(0x00ff)));
+			__m128i hi = _mm_packus_epi16(_mm_srli_epi16(bytes[0], 8), _mm_srli_epi16(bytes[1], 8));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 2), _mm_or_si128(lo, _mm_slli_epi16(hi, 4)));
+		}
+	}
+#endif
+	// Generic path collects bits into a 64-bit accumulator
+	out += i * bits / 8;
+	const std::uint64_t mask = bits == 32 ? 0xffffffffull : (std::uint64_t(1) << bits) - 1;
+	std::uint64_t acc = 0;
+	unsigned filled = 0;
+	for (; i < count; i++) {
+		acc |= (values[i] & mask) << filled;
+		filled += bits;
+		if (filled >= 32) {
+			detail::store<std::uint32_t>(out, static_cast<std::uint32_t>(acc), Endian::little);
+			out += 4;
+			acc >>= 32;
+			filled -= 32;
+		}
+	}
+	while (filled > 0) {
+		*out++ = static_cast<unsigned char>(acc);
+		acc >>= 8;
+		filled = filled > 8 ? filled - 8 : 0;
+	}
+}
+
+// Unpack values written by pack_bits
+//
+// \param[in]  data   const unsigned char* Packed bit stream of at least packed_size(count, bits) bytes
+// \param[in]  count  size_t               Number of values
+// \param[in]  bits   unsigned             Width of a value, 1 to 32
+// \param[out] values std::uint32_t*       Buffer for count values
+//
+// \throws std::invalid_argument if bits is out of range
+inline void unpack_bits(const unsigned char* data, std::size_t count, unsigned bits, std::uint32_t* values) {
+	detail::check_bits(bits);
+	std::size_t i = 0;
+#if defined(__SSE2__) && !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	const __m128i zero = _mm_setzero_si128();
+	if (bits == 8) {
+		for (; i + 16 <= count; i += 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			__m128i lo = _mm_unpacklo_epi8(v, zero);
+			__m128i hi = _mm_unpackhi_epi8(v, zero);
+			__m128i* out = reinterpret_cast<__m128i*>(values + i);
+			_mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+		}
+	} else if (bits == 16) {
+		for (; i + 8 <= count; i += 8) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 2 * i));
+			__m128i* out = reinterpret_cast<__m128i*>(values + i);
+			_mm_storeu_si128(out, _mm_unpacklo_epi16(v, zero));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(v, zero));
+		}
+	} else if (bits == 4) {
+		const __m128i mask = _mm_set1_epi8(0x0f);
+		for (; i + 32 <= count; i += 32) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i / 2));
+			__m128i lo_nibbles = _mm_and_si128(v, mask);
+			__m128i hi_nibbles = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+			__m128i bytes[2] = {_mm_unpacklo_epi8(lo_nibbles, hi_nibbles), _mm_unpackhi_epi8(lo_nibbles, hi_nibbles)};
+			__m128i* out = reinterpret_cast<__m128i*>(values + i);
+			for (int half = 0; half < 2; half++) {
+				__m128i lo = _mm_unpacklo_epi8(bytes[half], zero);
+				__m128i hi = _mm_unpackhi_epi8(bytes[half], zero);
+				_mm_storeu_si128(out + 4 * half, _mm_unpacklo_epi16(lo, zero));
+				_mm_storeu_si128(out + 4 * half + 1, _mm_unpackhi_epi16(lo, zero));
+				_mm_storeu_si128(out + 4 * half + 2, _mm_unpacklo_epi16(hi, zero));
+				_mm_storeu_si128(out + 4 * half + 3, _mm_unpackhi_epi16(hi, zero));
+			}
+		}
+	}
+#endif
+	// Generic path reads the stream into a 64-bit accumulator
+	const unsigned char* end = data + packed_size(count, bits);
+	data += i * bits / 8;
+	const std::uint64_t mask = bits == 32 ? 0xffffffffull : (std::uint64_t(1) << bits) - 1;
+	std::uint64_t acc = 0;
+	unsigned filled = 0;
+	for (; i < count; i++) {
+		if (filled < bits) {
+			if (end - data >= 4) {
+				acc |= static_cast<std::uint64_t>(detail::load<std::uint32_t>(data, Endian::little)) << filled;
+				data += 4;
+				filled += 32;
+			} else {
+				while (filled < bits) {
+					acc |= static_cast<std::uint64_t>(*data++) << filled;
+					filled += 8;
+				}
+			}
+		}
+		values[i] = static_cast<std::uint32_t>(acc & mask);
+		acc >>= bits;
+		filled -= bits;
+	}
+}
+
+// \class BinaryReader
+// Reads values from a byte span without copying it. The span must outlive
+// the reader.
+class BinaryReader {
+public:
+	// Construct reader over the bytes
+	//
+	// \param[in] data const void* Bytes to read
+	// \param[in] size size_t      Number of bytes
+	BinaryReader(const void* data, std::size_t size) noexcept
+			: m_data(static_cast<const unsigned char*>(data)), m_size(size), m_pos(0) {
+	}
+
+	// Get number of bytes in the span
+	//
+	// \return size_t
+	std::size_t size() const noexcept {
+		return m_size;
+	}
+
+	// Get the read position
+	//
+	// \return size_t
+	std::size_t position() const noexcept {
+		return m_pos;
+	}
+
+	// Get number of bytes left to read
+	//
+	// \return size_t
+	std::size_t remaining() const noexcept {
+		return m_size - m_pos;
+	}
+
+	// Move the read position
+	//
+	// \param[in] pos size_t New position, up to size()
+	//
+	// \throws std::out_of_range if pos is past the end
+	void seek(std::size_t pos) {
+		if (pos > m_size) {
+			throw std::out_of_range("Position is past the end of the buffer");
+		}
+		m_pos = pos;
+	}
+
+	// Skip bytes
+	//
+	// \param[in] count size_t Number of bytes to skip
+	//
+	// \throws std::out_of_range if there are not enough bytes
+	void skip(std::size_t count) {
+		require(count);
+		m_pos += count;
+	}
+
+	// Read fixed width value if there are enough bytes
+	//
+	// \param[out] value  T      Integer or floating point value
+	// \param[in]  endian Endian Byte order of the value
+	//
+	// \return bool False if there are not enough bytes
+	template<class T>
+	typename std::enable_if<std::is_arithmetic<T>::value, bool>::type try_read(T& value,
+			Endian endian = Endian::little) noexcept {
+		if (remaining() < sizeof(T)) {
+			return false;
+		}
+		value = detail::load<T>(m_data + m_pos, endian);
+		m_pos += sizeof(T);
+		return true;
+	}
+
+	// Read fixed width value
+	//
+	// \param[in] endian Endian Byte order of the value
+	//
+	// \return T
+	// \throws std::out_of_range if there are not enough bytes
+	template<class T>
+	typename std::enable_if<std::is_arithmetic<T>::value, T>::type read(Endian endian = Endian::little) {
+		require(sizeof(T));
+		T ret = detail::load<T>(m_data + m_pos, endian);
+		m_pos += sizeof(T);
+		return ret;
+	}
+
+	// Read fixed width value at an offset from the read position without advancing
+	//
+	// \param[in] offset size_t Offset from the read position
+	// \param[in] endian Endian Byte order of the value
+	//
+	// \return T
+	// \throws std::out_of_range if there are not enough bytes
+	template<class T>
+	typename std::enable_if<std::is_arithmetic<T>::value, T>::type peek(std::size_t offset = 0,
+			Endian endian = Endian::little) const {
+		if (offset > remaining() || remaining() - offset < sizeof(T)) {
+			throw std::out_of_range("Read past the end of the buffer");
+		}
+		return detail::load<T>(m_data + m_pos + offset, endian);
+	}
+
+	// Get pointer to the next bytes and advance past them
+	//
+	// \param[in] count size_t Number of bytes
+	//
+	// \return const unsigned char* Pointer into the span
+	// \throws std::out_of_range if there are not enough bytes
+	const unsigned char* read_bytes(std::size_t count) {
+		require(count);
+		const unsigned char* ret = m_data + m_pos;
+		m_pos += count;
+		return ret;
+	}
+
+	// Read unsigned LEB128 encoded value if it's complete and valid
+	//
+	// \param[out] value std::uint64_t Decoded value
+	//
+	// \return bool False if the value is truncated or does not fit 64 bits
+	bool try_read_uleb128(std::uint64_t& value) noexcept {
+		const unsigned char* p = m_data + m_pos;
+		std::size_t limit = std::min<std::size_t>(remaining(), 10);
+		if (limit >= 8) {
+			// Values up to 8 bytes are decoded from one load without branching per byte
+			std::uint64_t word = detail::load<std::uint64_t>(p, Endian::little);
+			std::uint64_t stops = ~word & 0x8080808080808080ull;
+			if (stops != 0) {
+				unsigned length = detail::trailing_zeros(stops) / 8 + 1;
+				if (length < 8) {
+					word &= (std::uint64_t(1) << (8 * length)) - 1;
+				}
+				value = detail::compact_groups(word);
+				m_pos += length;
+				return true;
+			}
+		}
+		std::uint64_t ret = 0;
+		for (std::size_t i = 0; i < limit; i++) {
+			std::uint64_t byte = p[i];
+			ret |= (byte & 0x7f) << (7 * i);
+			if (byte < 0x80) {
+				// Tenth byte may only hold the highest bit
+				if (i == 9 && byte > 1) {
+					return false;
+				}
+				value = ret;
+				m_pos += i + 1;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Read unsigned LEB128 encoded value
+	//
+	// \return std::uint64_t
+	// \throws std::runtime_error if the value is truncated or does not fit 64 bits
+	std::uint64_t read_uleb128() {
+		std::uint64_t ret;
+		if (!try_read_uleb128(ret)) {
+			throw std::runtime_error("Malformed LEB128 value");
+		}
+		return ret;
+	}
+
+	// Read signed LEB128 encoded value
+	//
+	// \return std::int64_t
+	// \throws std::runtime_error if the value is truncated or does not fit 64 bits
+	std::int64_t read_sleb128() {
+		const unsigned char* p = m_data + m_pos;
+		std::size_t limit = std::min<std::size_t>(remaining(), 10);
+		std::uint64_t ret = 0;
+		for (std::size_t i = 0; i < limit; i++) {
+			std::uint64_t byte = p[i];
+			ret |= (byte & 0x7f) << (7 * i);
+			if (byte < 0x80) {
+				unsigned shift = static_cast<unsigned>(7 * (i + 1));
+				if (shift < 64 && (byte & 0x40)) {
+					ret |= ~std::uint64_t(0) << shift;
+				}
+				// Tenth byte may only hold the sign
+				if (i == 9 && byte != 0 && byte != 0x7f) {
+					break;
+				}
+				m_pos += i + 1;
+				return static_cast<std::int64_t>(ret);
+			}
+		}
+		throw std::runtime_error("Malformed LEB128 value");
+	}
+
+	// Read bit-packed values written with BinaryWriter::write_packed
+	//
+	// \param[out] values std::uint32_t* Buffer for count values
+	// \param[in]  count  size_t         Number of values
+	// \param[in]  bits   unsigned       Width of a value, 1 to 32
+	//
+	// \throws std::out_of_range if there are not enough bytes
+	// \throws std::invalid_argument if bits is out of range
+	void read_packed(std::uint32_t* values, std::size_t count, unsigned bits) {
+		detail::check_bits(bits);
+		std::size_t size = packed_size(count, bits);
+		require(size);
+		unpack_bits(m_data + m_pos, count, bits, values);
+		m_pos += size;
+	}
+
+private:
+	void require(std::size_t count) const {
+		if (remaining() < count) {
+			throw std::out_of_range("Read past the end of the buffer");
+		}
+	}
+
+	const unsigned char* m_data;
+	std::size_t m_size;
+	std::size_t m_pos;
+};
+
+// \class BinaryWriter
+// Appends values to a growing byte buffer.
+class BinaryWriter {
+public:
+	// Construct empty writer
+	//
+	// \param[in] capacity size_t Number of bytes to reserve
+	explicit BinaryWriter(std::size_t capacity = 0)
+			: m_buffer(capacity), m_size(0) {
+	}
+
+	// Get pointer to the written bytes
+	//
+	// \return const unsigned char*
+	const unsigned char* data() const noexcept {
+		return m_buffer.data();
+	}
+
+	// Get number of written bytes
+	//
+	// \return size_t
+	std::size_t size() const noexcept {
+		return m_size;
+	}
+
+	// Remove the written bytes, keeping the allocated memory
+	void clear() noexcept {
+		m_size = 0;
+	}
+
+	// Move the written bytes out of the writer
+	//
+	// \return std::vector<unsigned char>
+	std::vector<unsigned char> release() {
+		m_buffer.resize(m_size);
+		m_size = 0;
+		std::vector<unsigned char> ret;
+		ret.swap(m_buffer);
+		return ret;
+	}
+
+	// Write fixed width value
+	//
+	// \param[in] value  T      Integer or floating point value
+	// \param[in] endian Endian Byte order of the value
+	template<class T>
+	typename std::enable_if<std::is_arithmetic<T>::value>::type write(T value, Endian endian = Endian::little) {
+		detail::store<T>(grow(sizeof(T)), value, endian);
+	}
+
+	// Write raw bytes
+	//
+	// \param[in] data  const void* Bytes to write
+	// \param[in] count size_t      Number of bytes
+	void write_bytes(const void* data, std::size_t count) {
+		if (count > 0) {
+			std::memcpy(grow(count), data, count);
+		}
+	}
+
+	// Write unsigned LEB128 encoded value
+	//
+	// \param[in] value std::uint64_t Value to write
+	void write_uleb128(std::uint64_t value) {
+		unsigned char* out = grow(10);
+		unsigned length = (detail::bit_width(value) + 6) / 7;
+		if (length <= 8) {
+			// Continuation bits on all but the last byte, written with one store
+			std::uint64_t continuation = 0x8080808080808080ull & ((std::uint64_t(1) << (8 * (length - 1))) - 1);
+			detail::store<std::uint64_t>(out, detail::spread_groups(value) | continuation, Endian::little);
+			m_size -= 10 - length;
+			return;
+		}
+		std::size_t n = 0;
+		while (value >= 0x80) {
+			out[n++] = static_cast<unsigned char>(value | 0x80);
+			value >>= 7;
+		}
+		out[n++] = static_cast<unsigned char>(value);
+		m_size -= 10 - n;
+	}
+
+	// Write signed LEB128 encoded value
+	//
+	// \param[in] value std::int64_t Value to write
+	void write_sleb128(std::int64_t value) {
+		unsigned char* out = grow(10);
+		std::size_t n = 0;
+		while (true) {
+			unsigned char byte = static_cast<unsigned char>(value & 0x7f);
+			// Arithmetic shift keeps the sign
+			value = value < 0 ? ~(~value >> 7) : value >> 7;
+			if ((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40))) {
+				out[n++] = byte;
+				break;
+			}
+			out[n++] = byte | 0x80;
+		}
+		m_size -= 10 - n;
+	}
+
+	// Write values bit-packed to the given width
+	//
+	// \param[in] values const std::uint32_t* Values to write, truncated to the width
+	// \param[in] count  size_t               Number of values
+	// \param[in] bits   unsigned             Width of a value, 1 to 32
+	//
+	// \throws std::invalid_argument if bits is out of range
+	void write_packed(const std::uint32_t* values, std::size_t count, unsigned bits) {
+		detail::check_bits(bits);
+		pack_bits(values, count, bits, grow(packed_size(count, bits)));
+	}
+
+private:
+	// Reserve bytes at the end and return pointer to them
+	unsigned char* grow(std::size_t count) {
+		if (m_buffer.size() - m_size < count) {
+			m_buffer.resize(std::max(m_buffer.size() * 2, std::max<std::size_t>(m_size + count, 64)));
+		}
+		unsigned char* ret = m_buffer.data() + m_size;
+		m_size += count;
+		return ret;
+	}
+
+	std::vector<unsigned char> m_buffer;
+	std::size_t m_size;
+};
+
+} // namespace binary_buffer
+} // namespace general
+} // namespace drodil
+
+#endif // OPERATORS_BINARY_BUFFER_HPP_
@@ -26,6 +26,7 @@
 #define OPERATORS_BINARY_OPERATORS_HPP_
 
 #include <iostream>
+#include <type_traits>
 
 namespace drodil {
 namespace general {
@@ -61,22 +62,19 @@ inline Enum operator^(Enum a, Enum b) {
 // Allows |= operator for any enum class in the same namespace
 template<class Enum, class = typename std::enable_if<std::is_enum<Enum>::value, Enum>::type> 
 inline Enum& operator|=(Enum& a, Enum b) {
-	return static_cast<Enum&>(static_cast<typename std::underlying_type<Enum>::type&>(a) |= 
-                            static_cast<typename std::underlying_type<Enum>::type&>(b));
+	return a = a | b;
 }
 
 // Allows &= operator for any enum class in the same namespace
 template<class Enum, class = typename std::enable_if<std::is_enum<Enum>::value, Enum>::type> 
 inline Enum& operator&=(Enum& a, Enum b) {
-	return static_cast<Enum&>(static_cast<typename std::underlying_type<Enum>::type&>(a) &= 
-                            static_cast<typename std::underlying_type<Enum>::type&>(b));
+	return a = a & b;
 }
 
 // Allows ^= operator for any enum class in the same namespace
 template<class Enum, class = typename std::enable_if<std::is_enum<Enum>::value, Enum>::type> 
 inline Enum& operator^=(Enum& a, Enum b) {
-	return static_cast<Enum&>(static_cast<typename std::underlying_type<Enum>::type&>(a) ^= 
-                            static_cast<typename std::underlying_type<Enum>::type&>(a));
+	return a = a ^ b;
 }
 
 } // namespace binary_operators
@@ -0,0 +1,632 @@
+// dynamic_bitset.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OPERATORS_DYNAMIC_BITSET_HPP_
+#define OPERATORS_DYNAMIC_BITSET_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "enum_flags.hpp"
+
+namespace drodil {
+namespace general {
+namespace dynamic_bitset {
+
+namespace detail {
+
+using enum_flags::detail::ctz;
+using enum_flags::detail::popcount;
+
+// Index of the k:th set bit of the word, the word must have more than k bits set
+//
+// \param[in] word std::uint64_t Bits to search
+// \param[in] k    unsigned      Zero based index of the set bit
+//
+// \return unsigned
+inline unsigned select64(std::uint64_t word, unsigned k) noexcept {
+#if defined(__BMI2__) && (defined(__x86_64__) || defined(_M_X64))
+	return ctz(_pdep_u64(std::uint64_t(1) << k, word));
+#else
+	// Byte i of the prefix holds the number of set bits in bytes 0..i
+	std::uint64_t prefix = word - ((word >> 1) & 0x5555555555555555ull);
+	prefix = (prefix & 0x3333333333333333ull) + ((prefix >> 2) & 0x3333333333333333ull);
+	prefix = ((prefix + (prefix >> 4)) & 0x0f0f0f0f0f0f0f0full) * 0x0101010101010101ull;
+	unsigned shift = 0;
+	while (((prefix >> shift) & 0xff) <= k) {
+		shift += 8;
+	}
+	if (shift > 0) {
+		k -= static_cast<unsigned>((prefix >> (shift - 8)) & 0xff);
+	}
+	unsigned byte = static_cast<unsigned>(word >> shift) & 0xff;
+	while (k-- > 0) {
+		byte &= byte - 1;
+	}
+	return shift + ctz(byte);
+#endif
+}
+
+// Count set bits of the words
+//
+// \param[in] words const std::uint64_t* Words to count
+// \param[in] count size_t                Number of words
+//
+// \return size_t
+inline std::size_t popcount_words(const std::uint64_t* words, std::size_t count) noexcept {
+	std::size_t ret = 0;
+	std::size_t i = 0;
+#if defined(__AVX2__) || defined(__SSSE3__)
+	// Nibble lookup with pshufb, byte counts summed with psadbw (Mula et al.)
+#if defined(__AVX2__)
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low = _mm256_set1_epi8(0x0f);
+	__m256i total = _mm256_setzero_si256();
+	while (i + 4 <= count) {
+		// Byte counters hold at most 8 per iteration, flush before they overflow
+		__m256i bytes = _mm256_setzero_si256();
+		std::size_t end = std::min(count & ~std::size_t(3), i + 4 * 31);
+		for (; i < end; i += 4) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+			__m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low));
+			__m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+			bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(lo, hi));
+		}
+		total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+	}
+	// Lanes are summed through memory, 64-bit lane extracts only exist on x86-64
+	std::uint64_t lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+	ret += static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+#else
+	const __m128i lookup = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m128i low = _mm_set1_epi8(0x0f);
+	__m128i total = _mm_setzero_si128();
+	while (i + 2 <= count) {
+		__m128i bytes = _mm_setzero_si128();
+		std::size_t end = std::min(count & ~std::size_t(1), i + 2 * 31);
+		for (; i < end; i += 2) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+			__m128i lo = _mm_shuffle_epi8(lookup, _mm_and_si128(v, low));
+			__m128i hi = _mm_shuffle_epi8(lookup, _mm_and_si128(_mm_srli_epi16(v, 4), low));
+			bytes = _mm_add_epi8(bytes, _mm_add_epi8(lo, hi));
+		}
+		total = _mm_add_epi64(total, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+	}
+	std::uint64_t lanes[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), total);
+	ret += static_cast<std::size_t>(lanes[0] + lanes[1]);
+#endif
+#endif
+	for (; i < count; i++) {
+		ret += popcount(words[i]);
+	}
+	return ret;
+}
+
+// Combine words of b into a with the given operation
+//
+// \param[in|out] a     std::uint64_t* Words to update
+// \param[in]     b     const std::uint64_t* Words to combine with
+// \param[in]     count size_t Number of words
+// \param[in]     op    Op Scalar operation, vector operations are chosen with Op::simd
+template<class Op>
+inline void combine_words(std::uint64_t* a, const std::uint64_t* b, std::size_t count, Op op) noexcept {
+	std::size_t i = 0;
+#if defined(__AVX2__)
+	for (; i + 4 <= count; i += 4) {
+		__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i), op(va, vb));
+	}
+#elif defined(__SSE2__)
+	for (; i + 2 <= count; i += 2) {
+		__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), op(va, vb));
+	}
+#endif
+	for (; i < count; i++) {
+		a[i] = op(a[i], b[i]);
+	}
+}
+
+struct and_op {
+	std::uint64_t operator()(std::uint64_t a, std::uint64_t b) const noexcept { return a & b; }
+#if defined(__AVX2__)
+	__m256i operator()(__m256i a, __m256i b) const noexcept { return _mm256_and_si256(a, b); }
+#elif defined(__SSE2__)
+	__m128i operator()(__m128i a, __m128i b) const noexcept { return _mm_and_si128(a, b); }
+#endif
+};
+
+struct or_op {
+	std::uint64_t operator()(std::uint64_t a, std::uint64_t b) const noexcept { return a | b; }
+#if defined(__AVX2__)
+	__m256i operator()(__m256i a, __m256i b) const noexcept { return _mm256_or_si256(a, b); }
+#elif defined(__SSE2__)
+	__m128i operator()(__m128i a, __m128i b) const noexcept { return _mm_or_si128(a, b); }
+#endif
+};
+
+struct xor_op {
+	std::uint64_t operator()(std::uint64_t a, std::uint64_t b) const noexcept { return a ^ b; }
+#if defined(__AVX2__)
+	__m256i operator()(__m256i a, __m256i b) const noexcept { return _mm256_xor_si256(a, b); }
+#elif defined(__SSE2__)
+	__m128i operator()(__m128i a, __m128i b) const noexcept { return _mm_xor_si128(a, b); }
+#endif
+};
+
+struct and_not_op {
+	std::uint64_t operator()(std::uint64_t a, std::uint64_t b) const noexcept { return a & ~b; }
+#if defined(__AVX2__)
+	__m256i operator()(__m256i a, __m256i b) const noexcept { return _mm256_andnot_si256(b, a); }
+#elif defined(__SSE2__)
+	__m128i operator()(__m128i a, __m128i b) const noexcept { return _mm_andnot_si128(b, a); }
+#endif
+};
+
+} // namespace detail
+
+// \class DynamicBitset
+// Bitset with the size chosen at runtime, stored in 64-bit words. Whole set
+// operations and counting are vectorized, set bits are visited with
+// count-trailing-zeros so sparse sets are iterated quickly.
+class DynamicBitset {
+public:
+	typedef std::uint64_t word_type;
+
+	// Number of bits in a storage word
+	static const std::size_t word_bits = 64;
+
+	// Returned by find functions when no set bit is found
+	static const std::size_t npos = static_cast<std::size_t>(-1);
+
+	// Construct bitset with all bits set to the value
+	//
+	// \param[in] size  size_t Number of bits
+	// \param[in] value bool   Initial value of the bits
+	explicit DynamicBitset(std::size_t size = 0, bool value = false)
+			: m_words(word_count(size), value ? ~word_type(0) : 0), m_size(size) {
+		clear_unused();
+	}
+
+	// Get number of bits
+	//
+	// \return size_t
+	std::size_t size() const noexcept {
+		return m_size;
+	}
+
+	// Get the storage words, bits past size() are zero
+	//
+	// \return const std::vector<word_type>&
+	const std::vector<word_type>& words() const noexcept {
+		return m_words;
+	}
+
+	// Change number of bits
+	//
+	// \param[in] size  size_t Number of bits
+	// \param[in] value bool   Value of the added bits
+	void resize(std::size_t size, bool value = false) {
+		std::size_t old_size = m_size;
+		m_words.resize(word_count(size), value ? ~word_type(0) : 0);
+		m_size = size;
+		if (value && size > old_size && old_size % word_bits != 0) {
+			m_words[old_size / word_bits] |= ~word_type(0) << (old_size % word_bits);
+		}
+		clear_unused();
+	}
+
+	// Check if the bit is set, no bounds checking
+	//
+	// \param[in] pos size_t Index of the bit
+	//
+	// \return bool
+	bool operator[](std::size_t pos) const noexcept {
+		return (m_words[pos / word_bits] >> (pos % word_bits)) & 1;
+	}
+
+	// Check if the bit is set
+	//
+	// \param[in] pos size_t Index of the bit
+	//
+	// \return bool
+	// \throws std::out_of_range if pos is not less than size()
+	bool test(std::size_t pos) const {
+		check(pos);
+		return (*this)[pos];
+	}
+
+	// Set the bit
+	//
+	// \param[in] pos   size_t Index of the bit
+	// \param[in] value bool   Value to set
+	//
+	// \return DynamicBitset& This bitset
+	// \throws std::out_of_range if pos is not less than size()
+	DynamicBitset& set(std::size_t pos, bool value = true) {
+		check(pos);
+		word_type bit = word_type(1) << (pos % word_bits);
+		word_type& word = m_words[pos / word_bits];
+		word = value ? word | bit : word & ~bit;
+		return *this;
+	}
+
+	// Clear the bit
+	//
+	// \param[in] pos size_t Index of the bit
+	//
+	// \return DynamicBitset& This bitset
+	// \throws std::out_of_range if pos is not less than size()
+	DynamicBitset& reset(std::size_t pos) {
+		return set(pos, false);
+	}
+
+	// Toggle the bit
+	//
+	// \param[in] pos size_t Index of the bit
+	//
+	// \return DynamicBitset& This bitset
+	// \throws std::out_of_range if pos is not less than size()
+	DynamicBitset& flip(std::size_t pos) {
+		check(pos);
+		m_words[pos / word_bits] ^= word_type(1) << (pos % word_bits);
+		return *this;
+	}
+
+	// Set all bits
+	//
+	// \return DynamicBitset& This bitset
+	DynamicBitset& set() noexcept {
+		std::fill(m_words.begin(), m_words.end(), ~word_type(0));
+		clear_unused();
+		return *this;
+	}
+
+	// Clear all bits
+	//
+	// \return DynamicBitset& This bitset
+	DynamicBitset& reset() noexcept {
+		std::fill(m_words.begin(), m_words.end(), word_type(0));
+		return *this;
+	}
+
+	// Toggle all bits
+	//
+	// \return DynamicBitset& This bitset
+	DynamicBitset& flip() noexcept {
+		for (word_type& word : m_words) {
+			word = ~word;
+		}
+		clear_unused();
+		return *this;
+	}
+
+	// Count set bits
+	//
+	// \return size_t
+	std::size_t count() const noexcept {
+		return detail::popcount_words(m_words.data(), m_words.size());
+	}
+
+	// Check if any bit is set
+	//
+	// \return bool
+	bool any() const noexcept {
+		return find_first() != npos;
+	}
+
+	// Check if no bit is set
+	//
+	// \return bool
+	bool none() const noexcept {
+		return !any();
+	}
+
+	// Check if all bits are set
+	//
+	// \return bool
+	bool all() const noexcept {
+		return count() == m_size;
+	}
+
+	// Find the first set bit
+	//
+	// \return size_t Index of the bit or npos
+	std::size_t find_first() const noexcept {
+		return find_from(0);
+	}
+
+	// Find the next set bit after the position
+	//
+	// \param[in] pos size_t Position to search after
+	//
+	// \return size_t Index of the bit or npos
+	std::size_t find_next(std::size_t pos) const noexcept {
+		return pos + 1 >= m_size ? npos : find_from(pos + 1);
+	}
+
+	// Call function with the index of every set bit in increasing order
+	//
+	// \param[in] fn Function taking size_t
+	template<typename Fn>
+	void for_each_set(Fn fn) const {
+		for (std::size_t i = 0; i < m_words.size(); i++) {
+			word_type word = m_words[i];
+			while (word != 0) {
+				fn(i * word_bits + detail::ctz(word));
+				word &= word - 1;
+			}
+		}
+	}
+
+	// Keep bits that are also set in other
+	//
+	// \param[in] other DynamicBitset Bitset of the same size
+	//
+	// \return DynamicBitset& This bitset
+	// \throws std::invalid_argument if the sizes differ
+	DynamicBitset& operator&=(const DynamicBitset& other) {
+		return combine(other, detail::and_op());
+	}
+
+	// Set bits that are set in other
+	//
+	// \param[in] other DynamicBitset Bitset of the same size
+	//
+	// \return DynamicBitset& This bitset
+	// \throws std::invalid_argument if the sizes differ
+	DynamicBitset& operator|=(const DynamicBitset& other) {
+		return combine(other, detail::or_op());
+	}
+
+	// Toggle bits that are set in other
+	//
+	// \param[in] other DynamicBitset Bitset of the same size
+	//
+	// \return DynamicBitset& This bitset
+	// \throws std::invalid_argument if the sizes differ
+	DynamicBitset& operator^=(const DynamicBitset& other) {
+		return combine(other, detail::xor_op());
+	}
+
+	// Clear bits that are set in other
+	//
+	// \param[in] other DynamicBitset Bitset of the same size
+	//
+	// \return DynamicBitset& This bitset
+	// \throws std::invalid_argument if the sizes differ
+	DynamicBitset& and_not(const DynamicBitset& other) {
+		return combine(other, detail::and_not_op());
+	}
+
+	friend DynamicBitset operator&(DynamicBitset a, const DynamicBitset& b) {
+		return a &= b;
+	}
+
+	friend DynamicBitset operator|(DynamicBitset a, const DynamicBitset& b) {
+		return a |= b;
+	}
+
+	friend DynamicBitset operator^(DynamicBitset a, const DynamicBitset& b) {
+		return a ^= b;
+	}
+
+	DynamicBitset operator~() const {
+		DynamicBitset ret(*this);
+		return ret.flip();
+	}
+
+	friend bool operator==(const DynamicBitset& a, const DynamicBitset& b) noexcept {
+		return a.m_size == b.m_size && a.m_words == b.m_words;
+	}
+
+	friend bool operator!=(const DynamicBitset& a, const DynamicBitset& b) noexcept {
+		return !(a == b);
+	}
+
+private:
+	static std::size_t word_count(std::size_t bits) noexcept {
+		return (bits + word_bits - 1) / word_bits;
+	}
+
+	void check(std::size_t pos) const {
+		if (pos >= m_size) {
+			throw std::out_of_range("Bit position is out of range");
+		}
+	}
+
+	// Keep the bits past size() zero so counting and comparing can use whole words
+	void clear_unused() noexcept {
+		if (m_size % word_bits != 0) {
+			m_words.back() &= ~(~word_type(0) << (m_size % word_bits));
+		}
+	}
+
+	std::size_t find_from(std::size_t pos) const noexcept {
+		std::size_t i = pos / word_bits;
+		if (i >= m_words.size()) {
+			return npos;
+		}
+		word_type word = m_words[i] & (~word_type(0) << (pos % word_bits));
+		while (word == 0) {
+			if (++i == m_words.size()) {
+				return npos;
+			}
+			word = m_words[i];
+		}
+		return i * word_bits + detail::ctz(word);
+	}
+
+	template<class Op>
+	DynamicBitset& combine(const DynamicBitset& other, Op op) {
+		if (other.m_size != m_size) {
+			throw std::invalid_argument("Bitsets must have the same size");
+		}
+		detail::combine_words(m_words.data(), other.m_words.data(), m_words.size(), op);
+		return *this;
+	}
+
+	std::vector<word_type> m_words;
+	std::size_t m_size;
+};
+
+// \class RankSelect
+// Succinct index over a DynamicBitset for constant time rank queries and
+// fast select queries. Uses about 25% of the bitset size: for every 512 bits
+// an absolute count and seven packed 9-bit counts relative to it (rank9).
+// The index must be rebuilt after the bitset is modified.
+class RankSelect {
+public:
+	// Build index over the bitset, which must outlive the index
+	//
+	// \param[in] bits DynamicBitset Bitset to index
+	explicit RankSelect(const DynamicBitset& bits)
+			: m_bits(&bits), m_ones(0) {
+		const std::vector<std::uint64_t>& words = bits.words();
+		std::size_t blocks = (words.size() + block_words - 1) / block_words;
+		m_counts.resize(2 * blocks + 2);
+		std::uint64_t total = 0;
+		for (std::size_t b = 0; b < blocks; b++) {
+			m_counts[2 * b] = total;
+			std::uint64_t relative = 0;
+			std::uint64_t packed = 0;
+			for (std::size_t w = 0; w < block_words; w++) {
+				if (w > 0) {
+					packed |= relative << (9 * (w - 1));
+				}
+				std::size_t index = b * block_words + w;
+				relative += index < words.size() ? detail::popcount(words[index]) : 0;
+			}
+			m_counts[2 * b + 1] = packed;
+			total += relative;
+			if (total / select_sample > m_samples.size()) {
+				// Sample the block of every select_sample:th set bit
+				while (m_samples.size() < total / select_sample) {
+					m_samples.push_back(static_cast<std::uint32_t>(b));
+				}
+			}
+		}
+		m_counts[2 * blocks] = total;
+		m_ones = static_cast<std::size_t>(total);
+	}
+
+	// Get number of set bits
+	//
+	// \return size_t
+	std::size_t ones() const noexcept {
+		return m_ones;
+	}
+
+	// Count set bits before the position
+	//
+	// \param[in] pos size_t Position, up to the size of the bitset
+	//
+	// \return size_t
+	std::size_t rank(std::size_t pos) const noexcept {
+		std::size_t word = pos / DynamicBitset::word_bits;
+		std::size_t block = word / block_words;
+		std::size_t offset = word % block_words;
+		std::uint64_t ret = m_counts[2 * block];
+		if (offset > 0) {
+			ret += (m_counts[2 * block + 1] >> (9 * (offset - 1))) & 0x1ff;
+		}
+		std::size_t bit = pos % DynamicBitset::word_bits;
+		if (bit > 0) {
+			ret += detail::popcount(m_bits->words()[word] & ~(~std::uint64_t(0) << bit));
+		}
+		return static_cast<std::size_t>(ret);
+	}
+
+	// Find the position of the k:th set bit
+	//
+	// \param[in] k size_t Zero based index of the set bit
+	//
+	// \return size_t Position of the bit or DynamicBitset::npos if there are
+	//                not enough set bits
+	std::size_t select(std::size_t k) const noexcept {
+		if (k >= m_ones) {
+			return DynamicBitset::npos;
+		}
+		// Narrow the block range with the samples and binary search the rest
+		std::size_t sample = k / select_sample;
+		std::size_t low = sample == 0 ? 0 : m_samples[sample - 1];
+		std::size_t high = sample < m_samples.size() ? m_samples[sample] + 1 : (m_counts.size() - 2) / 2;
+		while (high - low > 1) {
+			std::size_t mid = low + (high - low) / 2;
+			if (m_counts[2 * mid] <= k) {
+				low = mid;
+			} else {
+				high = mid;
+			}
+		}
+		std::size_t block = low;
+		std::uint64_t remaining = k - m_counts[2 * block];
+		std::uint64_t packed = m_counts[2 * block + 1];
+		std::size_t offset = 0;
+		while (offset + 1 < block_words && ((packed >> (9 * offset)) & 0x1ff) <= remaining) {
+			++offset;
+		}
+		if (offset > 0) {
+			remaining -= (packed >> (9 * (offset - 1))) & 0x1ff;
+		}
+		std::size_t word = block * block_words + offset;
+		return word * DynamicBitset::word_bits +
+				detail::select64(m_bits->words()[word], static_cast<unsigned>(remaining));
+	}
+
+private:
+	// Words per block with one absolute count
+	static const std::size_t block_words = 8;
+
+	// Every this many set bits the containing block is sampled for select
+	static const std::size_t select_sample = 512;
+
+	const DynamicBitset* m_bits;
+	std::vector<std::uint64_t> m_counts;
+	std::vector<std::uint32_t> m_samples;
+	std::size_t m_ones;
+};
+
+} // namespace dynamic_bitset
+} // namespace general
+} // namespace drodil
+
+#endif // OPERATORS_DYNAMIC_BITSET_HPP_
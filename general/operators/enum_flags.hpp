@@ -0,0 +1,306 @@
+// enum_flags.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OPERATORS_ENUM_FLAGS_HPP_
+#define OPERATORS_ENUM_FLAGS_HPP_
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace drodil {
+namespace general {
+namespace enum_flags {
+
+namespace detail {
+
+// Sum of bits in every byte of partial popcount, moved to the top byte
+constexpr unsigned long long popcount_bytes(unsigned long long nibbles) noexcept {
+	return (((nibbles + (nibbles >> 4)) & 0x0f0f0f0f0f0f0f0full) * 0x0101010101010101ull) >> 56;
+}
+
+// Sum of bits in every nibble of partial popcount
+constexpr unsigned long long popcount_nibbles(unsigned long long pairs) noexcept {
+	return (pairs & 0x3333333333333333ull) + ((pairs >> 2) & 0x3333333333333333ull);
+}
+
+// Number of set bits, usable in constant expressions
+//
+// \param[in] mask unsigned long long Bits to count
+//
+// \return unsigned
+constexpr unsigned popcount(unsigned long long mask) noexcept {
+#if defined(__POPCNT__) || defined(__ARM_NEON)
+	return static_cast<unsigned>(__builtin_popcountll(mask));
+#else
+	// Without a popcount instruction the builtin is a library call
+	return static_cast<unsigned>(popcount_bytes(popcount_nibbles(mask - ((mask >> 1) & 0x5555555555555555ull))));
+#endif
+}
+
+// Number of trailing zero bits, mask must not be zero
+//
+// \param[in] mask unsigned long long Non-zero bits
+//
+// \return unsigned
+constexpr unsigned ctz(unsigned long long mask) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+	return (mask & 1) ? 0 : 1 + ctz(mask >> 1);
+#endif
+}
+
+} // namespace detail
+
+// \class EnumFlags
+// Type safe set of flags of a single enum type whose enumerators are
+// distinct bits. All operations compile down to plain integer operations.
+//
+// \code
+// enum class Mode { Read = 1 << 0, Write = 1 << 1, Exec = 1 << 2 };
+// ENUM_FLAGS_OPERATORS(Mode)
+//
+// constexpr EnumFlags<Mode> rw = Mode::Read | Mode::Write;
+// static_assert(rw.test(Mode::Write), "");
+// for (Mode m : rw) { ... }
+// \endcode
+template<class Enum>
+class EnumFlags {
+	static_assert(std::is_enum<Enum>::value, "EnumFlags requires an enum type");
+
+public:
+	typedef typename std::make_unsigned<typename std::underlying_type<Enum>::type>::type mask_type;
+
+	// Forward iterator over the set flags, lowest bit first
+	class iterator {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Enum value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const Enum* pointer;
+		typedef Enum reference;
+
+		constexpr iterator() noexcept : m_mask(0) {}
+		constexpr explicit iterator(mask_type mask) noexcept : m_mask(mask) {}
+
+		// Lowest remaining flag
+		constexpr Enum operator*() const noexcept {
+			return static_cast<Enum>(static_cast<mask_type>(1) << detail::ctz(m_mask));
+		}
+
+		iterator& operator++() noexcept {
+			// Clear the lowest set bit
+			m_mask &= static_cast<mask_type>(m_mask - 1);
+			return *this;
+		}
+
+		iterator operator++(int) noexcept {
+			iterator ret = *this;
+			++*this;
+			return ret;
+		}
+
+		constexpr bool operator==(iterator other) const noexcept { return m_mask == other.m_mask; }
+		constexpr bool operator!=(iterator other) const noexcept { return m_mask != other.m_mask; }
+
+	private:
+		mask_type m_mask;
+	};
+
+	// Construct empty set
+	constexpr EnumFlags() noexcept : m_mask(0) {}
+
+	// Construct set of one flag, implicit so that flags can be passed directly
+	//
+	// \param[in] flag Enum Flag to set
+	constexpr EnumFlags(Enum flag) noexcept : m_mask(static_cast<mask_type>(flag)) {}
+
+	// Construct set from raw bits
+	//
+	// \param[in] mask mask_type Bits of the flags
+	//
+	// \return EnumFlags
+	static constexpr EnumFlags from_mask(mask_type mask) noexcept { return EnumFlags(mask, 0); }
+
+	// Get the raw bits
+	//
+	// \return mask_type
+	constexpr mask_type mask() const noexcept { return m_mask; }
+
+	// Check if all bits of the flag are set
+	//
+	// \param[in] flag Enum Flag to test
+	//
+	// \return bool
+	constexpr bool test(Enum flag) const noexcept {
+		return (m_mask & static_cast<mask_type>(flag)) == static_cast<mask_type>(flag);
+	}
+
+	// Check if any of the given flags is set
+	//
+	// \param[in] flags EnumFlags Flags to test
+	//
+	// \return bool
+	constexpr bool any_of(EnumFlags flags) const noexcept { return (m_mask & flags.m_mask) != 0; }
+
+	// Check if all of the given flags are set
+	//
+	// \param[in] flags EnumFlags Flags to test
+	//
+	// \return bool
+	constexpr bool all_of(EnumFlags flags) const noexcept { return (m_mask & flags.m_mask) == flags.m_mask; }
+
+	// Check if any flag is set
+	//
+	// \return bool
+	constexpr bool any() const noexcept { return m_mask != 0; }
+
+	// Check if no flag is set
+	//
+	// \return bool
+	constexpr bool none() const noexcept { return m_mask == 0; }
+
+	// Get number of set bits
+	//
+	// \return unsigned
+	constexpr unsigned count() const noexcept { return detail::popcount(m_mask); }
+
+	// Copy with the flags set
+	//
+	// \param[in] flags EnumFlags Flags to set
+	//
+	// \return EnumFlags
+	constexpr EnumFlags with(EnumFlags flags) const noexcept { return from_mask(m_mask | flags.m_mask); }
+
+	// Copy with the flags cleared
+	//
+	// \param[in] flags EnumFlags Flags to clear
+	//
+	// \return EnumFlags
+	constexpr EnumFlags without(EnumFlags flags) const noexcept {
+		return from_mask(static_cast<mask_type>(m_mask & ~flags.m_mask));
+	}
+
+	// Copy with the flags toggled
+	//
+	// \param[in] flags EnumFlags Flags to toggle
+	//
+	// \return EnumFlags
+	constexpr EnumFlags toggled(EnumFlags flags) const noexcept { return from_mask(m_mask ^ flags.m_mask); }
+
+	// Set the flags
+	//
+	// \param[in] flags EnumFlags Flags to set
+	//
+	// \return EnumFlags& This set
+	EnumFlags& set(EnumFlags flags) noexcept {
+		m_mask |= flags.m_mask;
+		return *this;
+	}
+
+	// Set or clear the flags
+	//
+	// \param[in] flags EnumFlags Flags to change
+	// \param[in] value bool      True to set, false to clear
+	//
+	// \return EnumFlags& This set
+	EnumFlags& set(EnumFlags flags, bool value) noexcept { return value ? set(flags) : clear(flags); }
+
+	// Clear the flags
+	//
+	// \param[in] flags EnumFlags Flags to clear
+	//
+	// \return EnumFlags& This set
+	EnumFlags& clear(EnumFlags flags) noexcept {
+		m_mask &= static_cast<mask_type>(~flags.m_mask);
+		return *this;
+	}
+
+	// Clear all flags
+	//
+	// \return EnumFlags& This set
+	EnumFlags& reset() noexcept {
+		m_mask = 0;
+		return *this;
+	}
+
+	// Toggle the flags
+	//
+	// \param[in] flags EnumFlags Flags to toggle
+	//
+	// \return EnumFlags& This set
+	EnumFlags& toggle(EnumFlags flags) noexcept {
+		m_mask ^= flags.m_mask;
+		return *this;
+	}
+
+	constexpr iterator begin() const noexcept { return iterator(m_mask); }
+	constexpr iterator end() const noexcept { return iterator(); }
+
+	constexpr explicit operator bool() const noexcept { return m_mask != 0; }
+
+	constexpr EnumFlags operator~() const noexcept { return from_mask(static_cast<mask_type>(~m_mask)); }
+
+	// Friends so that a plain flag is accepted on either side
+	friend constexpr EnumFlags operator|(EnumFlags a, EnumFlags b) noexcept { return from_mask(a.m_mask | b.m_mask); }
+	friend constexpr EnumFlags operator&(EnumFlags a, EnumFlags b) noexcept { return from_mask(a.m_mask & b.m_mask); }
+	friend constexpr EnumFlags operator^(EnumFlags a, EnumFlags b) noexcept { return from_mask(a.m_mask ^ b.m_mask); }
+	friend constexpr bool operator==(EnumFlags a, EnumFlags b) noexcept { return a.m_mask == b.m_mask; }
+	friend constexpr bool operator!=(EnumFlags a, EnumFlags b) noexcept { return a.m_mask != b.m_mask; }
+
+	EnumFlags& operator|=(EnumFlags other) noexcept { return set(other); }
+	EnumFlags& operator^=(EnumFlags other) noexcept { return toggle(other); }
+	EnumFlags& operator&=(EnumFlags other) noexcept {
+		m_mask &= other.m_mask;
+		return *this;
+	}
+
+private:
+	constexpr EnumFlags(mask_type mask, int) noexcept : m_mask(mask) {}
+
+	mask_type m_mask;
+};
+
+} // namespace enum_flags
+} // namespace general
+} // namespace drodil
+
+// Opt in an enum to combine its enumerators into EnumFlags with | & ^ and ~.
+// Use in the namespace of the enum so the operators are found by lookup.
+#define ENUM_FLAGS_OPERATORS(Enum)                                                                            \
+	constexpr ::drodil::general::enum_flags::EnumFlags<Enum> operator|(Enum a, Enum b) noexcept {              \
+		return ::drodil::general::enum_flags::EnumFlags<Enum>(a) | b;                                          \
+	}                                                                                                          \
+	constexpr ::drodil::general::enum_flags::EnumFlags<Enum> operator&(Enum a, Enum b) noexcept {              \
+		return ::drodil::general::enum_flags::EnumFlags<Enum>(a) & b;                                          \
+	}                                                                                                          \
+	constexpr ::drodil::general::enum_flags::EnumFlags<Enum> operator^(Enum a, Enum b) noexcept {              \
+		return ::drodil::general::enum_flags::EnumFlags<Enum>(a) ^ b;                                          \
+	}                                                                                                          \
+	constexpr ::drodil::general::enum_flags::EnumFlags<Enum> operator~(Enum a) noexcept {                      \
+		return ~::drodil::general::enum_flags::EnumFlags<Enum>(a);                                             \
+	}
+
+#endif // OPERATORS_ENUM_FLAGS_HPP_
@@ -0,0 +1,416 @@
+// enum_names.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OPERATORS_ENUM_NAMES_HPP_
+#define OPERATORS_ENUM_NAMES_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include "../string/string_view.hpp"
+#include "enum_flags.hpp"
+
+namespace drodil {
+namespace general {
+namespace enum_flags {
+
+using drodil::general::string::string_view;
+
+// Number of low bits of Enum that are reflected, all bits of the underlying
+// type by default. Specialize to reduce the template instantiations, e.g.
+//
+// \code
+// template<> struct enum_flag_bits<Mode> : std::integral_constant<unsigned, 3> {};
+// \endcode
+template<class Enum>
+struct enum_flag_bits
+		: std::integral_constant<unsigned,
+				std::numeric_limits<typename EnumFlags<Enum>::mask_type>::digits> {
+};
+
+namespace detail {
+
+// Function whose signature the compiler spells with the enumerator name of V
+template<class Enum, Enum V>
+const char* enum_signature() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+	return __FUNCSIG__;
+#elif defined(__GNUC__) || defined(__clang__)
+	return __PRETTY_FUNCTION__;
+#else
+	return "";
+#endif
+}
+
+// Enum value with only the given bit set
+template<class Enum>
+constexpr Enum flag_bit(unsigned bit) noexcept {
+	return static_cast<Enum>(static_cast<typename std::underlying_type<Enum>::type>(
+			static_cast<typename EnumFlags<Enum>::mask_type>(1) << bit));
+}
+
+// Collects the signatures of bits [Bit, Count)
+template<class Enum, unsigned Bit, unsigned Count>
+struct enum_signatures {
+	static void fill(const char** signatures) noexcept {
+		signatures[Bit] = enum_signature<Enum, flag_bit<Enum>(Bit)>();
+		enum_signatures<Enum, Bit + 1, Count>::fill(signatures);
+	}
+};
+
+template<class Enum, unsigned Count>
+struct enum_signatures<Enum, Count, Count> {
+	static void fill(const char**) noexcept {
+	}
+};
+
+// Extract the enumerator name from a signature of enum_signature
+//
+// \param[in] signature const char* Signature of the function
+//
+// \return string_view Enumerator name without scope, empty if the value has no name
+inline string_view enumerator_name(const char* signature) noexcept {
+	string_view sig(signature);
+#if defined(_MSC_VER) && !defined(__clang__)
+	// ... enum_signature<enum ns::Mode,ns::Mode::Read>(void)
+	const char open = ',';
+	const char close = '>';
+#else
+	// ... enum_signature() [with Enum = ns::Mode; Enum V = ns::Mode::Read]
+	const char open = ' ';
+	const char close = ']';
+#endif
+	std::size_t last = sig.size();
+	while (last > 0 && sig[last - 1] != close) {
+		--last;
+	}
+	if (last == 0) {
+		return string_view();
+	}
+	--last;
+	std::size_t first = last;
+	while (first > 0 && sig[first - 1] != open) {
+		--first;
+	}
+	// Values without a name are printed as casts, e.g. (ns::Mode)8
+	if (first == last || sig[first] == '(' || sig[first] == '-' || (sig[first] >= '0' && sig[first] <= '9')) {
+		return string_view();
+	}
+	std::size_t name = last;
+	while (name > first && sig[name - 1] != ':') {
+		--name;
+	}
+	return sig.substr(name, last - name);
+}
+
+// FNV-1a hash of the string mixed with a seed, reduced to the given number of bits
+inline std::uint32_t name_hash(string_view str, std::uint32_t seed, unsigned bits) noexcept {
+	std::uint32_t h = 2166136261u ^ seed;
+	for (std::size_t i = 0; i < str.size(); i++) {
+		h = (h ^ static_cast<unsigned char>(str[i])) * 16777619u;
+	}
+	return (h * 0x9e3779b1u) >> (32 - bits);
+}
+
+} // namespace detail
+
+// \class EnumNames
+// Names of the single bit flags of an enum, read from the compiler generated
+// function signatures so no hand-written tables are needed. The enum must be
+// an enum class or have a fixed underlying type.
+//
+// The table is built once on first use. Names point to static strings of
+// the program and lookups by name use a perfect hash, nothing is allocated.
+template<class Enum>
+class EnumNames {
+public:
+	typedef EnumFlags<Enum> flags_type;
+	typedef typename flags_type::mask_type mask_type;
+
+	// Number of reflected bits
+	static const unsigned bit_count = enum_flag_bits<Enum>::value;
+
+	// Get the table of the enum, built on the first call
+	//
+	// \return const EnumNames&
+	static const EnumNames& instance() {
+		static const EnumNames names;
+		return names;
+	}
+
+	// Get name of a single bit flag
+	//
+	// \param[in] flag Enum Flag with one bit set
+	//
+	// \return string_view Name, or empty if the flag has no name
+	string_view name(Enum flag) const noexcept {
+		mask_type mask = static_cast<mask_type>(flag);
+		if (mask == 0 || (mask & (mask - 1)) != 0) {
+			return string_view();
+		}
+		unsigned bit = detail::ctz(mask);
+		return bit < bit_count ? m_names[bit] : string_view();
+	}
+
+	// Find flag by name
+	//
+	// \param[in]  name string_view Name of the flag
+	// \param[out] flag Enum        Set to the flag if found
+	//
+	// \return bool True if the name was found
+	bool find(string_view name, Enum& flag) const noexcept {
+		if (m_hash_bits == 0) {
+			// Perfect hash was not found, fall back to linear search
+			for (unsigned bit = 0; bit < bit_count; bit++) {
+				if (!m_names[bit].empty() && m_names[bit] == name) {
+					flag = detail::flag_bit<Enum>(bit);
+					return true;
+				}
+			}
+			return false;
+		}
+		unsigned char slot = m_slots[detail::name_hash(name, m_seed, m_hash_bits)];
+		if (slot == empty_slot || m_names[slot] != name) {
+			return false;
+		}
+		flag = detail::flag_bit<Enum>(slot);
+		return true;
+	}
+
+	// Format flags as names separated by the separator, e.g. "Read|Exec".
+	// Bits without a name are written as one hexadecimal number.
+	//
+	// \param[in] flags     flags_type Flags to format
+	// \param[in] separator char       Separator between the names
+	//
+	// \return std::string
+	std::string format(flags_type flags, char separator = '|') const {
+		char hex[2 + 2 * sizeof(mask_type)];
+		std::size_t hex_length = 0;
+		std::size_t length = 0;
+		mask_type unnamed = 0;
+		for (Enum flag : flags) {
+			string_view n = name(flag);
+			if (n.empty()) {
+				unnamed |= static_cast<mask_type>(flag);
+			} else {
+				length += n.size() + 1;
+			}
+		}
+		if (unnamed != 0) {
+			hex_length = format_hex(unnamed, hex);
+			length += hex_length + 1;
+		}
+
+		std::string ret;
+		ret.reserve(length);
+		for (Enum flag : flags) {
+			string_view n = name(flag);
+			if (!n.empty()) {
+				if (!ret.empty()) {
+					ret += separator;
+				}
+				ret.append(n.data(), n.size());
+			}
+		}
+		if (unnamed != 0) {
+			if (!ret.empty()) {
+				ret += separator;
+			}
+			ret.append(hex, hex_length);
+		}
+		return ret;
+	}
+
+	// Parse flags formatted by format(). Whitespace around the names is
+	// ignored and hexadecimal numbers starting with 0x are accepted.
+	//
+	// \param[in]  text      string_view Text to parse
+	// \param[out] flags     flags_type  Set to the parsed flags on success
+	// \param[in]  separator char        Separator between the names
+	//
+	// \return bool True if every name was known
+	bool parse(string_view text, flags_type& flags, char separator = '|') const noexcept {
+		mask_type mask = 0;
+		std::size_t pos = 0;
+		while (true) {
+			std::size_t end = pos;
+			while (end < text.size() && text[end] != separator) {
+				++end;
+			}
+			std::size_t first = pos;
+			std::size_t last = end;
+			while (first < last && (text[first] == ' ' || text[first] == '\t')) {
+				++first;
+			}
+			while (last > first && (text[last - 1] == ' ' || text[last - 1] == '\t')) {
+				--last;
+			}
+			string_view token = text.substr(first, last - first);
+			Enum flag = Enum();
+			if (token.empty()) {
+				// Blank text means no flags, but every name between separators is required
+				if (pos != 0 || end != text.size()) {
+					return false;
+				}
+			} else if (find(token, flag)) {
+				mask |= static_cast<mask_type>(flag);
+			} else if (!parse_hex(token, mask)) {
+				return false;
+			}
+			if (end == text.size()) {
+				break;
+			}
+			pos = end + 1;
+		}
+		flags = flags_type::from_mask(mask);
+		return true;
+	}
+
+private:
+	static const unsigned char empty_slot = 0xff;
+	static const unsigned max_hash_bits = 9;
+
+	EnumNames() : m_seed(0), m_hash_bits(0) {
+		const char* signatures[bit_count ? bit_count : 1];
+		detail::enum_signatures<Enum, 0, bit_count>::fill(signatures);
+		unsigned count = 0;
+		for (unsigned bit = 0; bit < bit_count; bit++) {
+			m_names[bit] = detail::enumerator_name(signatures[bit]);
+			count += m_names[bit].empty() ? 0 : 1;
+		}
+		build_hash(count);
+	}
+
+	// Search seed that maps every name to its own slot, with at least twice
+	// as many slots as names a seed is usually found within a few attempts
+	void build_hash(unsigned count) noexcept {
+		unsigned bits = 1;
+		while ((1u << bits) < 2 * count) {
+			++bits;
+		}
+		for (; bits <= max_hash_bits; bits++) {
+			for (std::uint32_t seed = 0; seed < 1000; seed++) {
+				std::memset(m_slots, empty_slot, sizeof(m_slots));
+				bool collision = false;
+				for (unsigned bit = 0; bit < bit_count && !collision; bit++) {
+					if (m_names[bit].empty()) {
+						continue;
+					}
+					unsigned char& slot = m_slots[detail::name_hash(m_names[bit], seed, bits)];
+					collision = slot != empty_slot;
+					slot = static_cast<unsigned char>(bit);
+				}
+				if (!collision) {
+					m_seed = seed;
+					m_hash_bits = bits;
+					return;
+				}
+			}
+		}
+	}
+
+	static std::size_t format_hex(mask_type mask, char* out) noexcept {
+		static const char digits[] = "0123456789abcdef";
+		char tmp[2 * sizeof(mask_type)];
+		std::size_t n = 0;
+		do {
+			tmp[n++] = digits[mask & 0xf];
+			mask = static_cast<mask_type>(mask >> 4);
+		} while (mask != 0);
+		out[0] = '0';
+		out[1] = 'x';
+		for (std::size_t i = 0; i < n; i++) {
+			out[2 + i] = tmp[n - 1 - i];
+		}
+		return n + 2;
+	}
+
+	static bool parse_hex(string_view token, mask_type& mask) noexcept {
+		if (token.size() < 3 || token.size() > 2 + 2 * sizeof(mask_type) || token[0] != '0' ||
+				(token[1] != 'x' && token[1] != 'X')) {
+			return false;
+		}
+		mask_type value = 0;
+		for (std::size_t i = 2; i < token.size(); i++) {
+			char c = token[i];
+			unsigned digit;
+			if (c >= '0' && c <= '9') {
+				digit = static_cast<unsigned>(c - '0');
+			} else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+				digit = static_cast<unsigned>((c | 0x20) - 'a' + 10);
+			} else {
+				return false;
+			}
+			value = static_cast<mask_type>((value << 4) | digit);
+		}
+		mask |= value;
+		return true;
+	}
+
+	string_view m_names[bit_count ? bit_count : 1];
+	unsigned char m_slots[1u << max_hash_bits];
+	std::uint32_t m_seed;
+	unsigned m_hash_bits;
+};
+
+// Get name of a single bit flag
+//
+// \param[in] flag Enum Flag with one bit set
+//
+// \return string_view Name, or empty if the flag has no name
+template<class Enum>
+string_view flag_name(Enum flag) {
+	return EnumNames<Enum>::instance().name(flag);
+}
+
+// Format flags as names separated by '|', e.g. "Read|Exec"
+//
+// \param[in] flags EnumFlags Flags to format
+//
+// \return std::string
+template<class Enum>
+std::string to_string(EnumFlags<Enum> flags) {
+	return EnumNames<Enum>::instance().format(flags);
+}
+
+// Parse flags formatted with to_string
+//
+// \param[in]  text  string_view Text to parse
+// \param[out] flags EnumFlags   Set to the parsed flags on success
+//
+// \return bool True if every name was known
+template<class Enum>
+bool parse(string_view text, EnumFlags<Enum>& flags) {
+	return EnumNames<Enum>::instance().parse(text, flags);
+}
+
+} // namespace enum_flags
+} // namespace general
+} // namespace drodil
+
+#endif // OPERATORS_ENUM_NAMES_HPP_
@@ -22,16 +22,88 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "atomic_enum_flags.hpp"
+#include "binary_buffer.hpp"
 #include "binary_operators.hpp"
+#include "dynamic_bitset.hpp"
+#include "enum_flags.hpp"
+#include "enum_names.hpp"
 #include <iostream>
 #include <bitset>
+#include <thread>
+#include <vector>
 
 using namespace drodil::general::binary_operators;
+using namespace drodil::general::binary_buffer;
+using drodil::general::dynamic_bitset::DynamicBitset;
+using drodil::general::dynamic_bitset::RankSelect;
+using drodil::general::enum_flags::AtomicEnumFlags;
+using drodil::general::enum_flags::EnumFlags;
 
 enum class TestEnum {
 	None = 0, First = 1 << 1, Second = 1 << 2, Third = 1 << 3
 };
 
+enum class Permission : unsigned char {
+	Read = 1 << 0, Write = 1 << 1, Execute = 1 << 2
+};
+ENUM_FLAGS_OPERATORS(Permission)
+
+// Everything is resolved at compile time
+constexpr EnumFlags<Permission> read_write = Permission::Read | Permission::Write;
+static_assert(read_write.test(Permission::Write), "Write should be set");
+static_assert(!read_write.test(Permission::Execute), "Execute should not be set");
+static_assert(read_write.count() == 2, "Two flags should be set");
+static_assert(read_write.toggled(Permission::Read) == Permission::Write, "Only Write should be left");
+static_assert(read_write.without(Permission::Write).with(Permission::Execute).mask() == 5, "Read and Execute");
+static_assert(sizeof(EnumFlags<Permission>) == 1, "Flags should take the size of the enum");
+
+enum class Connection : unsigned {
+	Open = 1 << 0, Closing = 1 << 1, Closed = 1 << 2, Worker = 1 << 3
+};
+ENUM_FLAGS_OPERATORS(Connection)
+
+// Many threads race to close the same connections, exactly one must win
+// every time and the per-thread bits must come back to zero
+bool connection_stress_test() {
+	const unsigned thread_count = 8;
+	const unsigned rounds = 20000;
+	std::vector<AtomicEnumFlags<Connection>> connections(rounds);
+	for (auto& connection : connections) {
+		connection.store(Connection::Open);
+	}
+	AtomicEnumFlags<Connection> workers;
+	std::vector<unsigned> wins(thread_count);
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t < thread_count; t++) {
+		threads.emplace_back([&, t] {
+			const EnumFlags<Connection> mine = EnumFlags<Connection>::from_mask(1u << (8 + t));
+			for (auto& connection : connections) {
+				workers.fetch_toggle(mine, std::memory_order_relaxed);
+				if (connection.transition(Connection::Open, Connection::Closing, Connection::Closing, {},
+						std::memory_order_acq_rel)) {
+					connection.fetch_set(Connection::Closed, std::memory_order_release);
+					connection.fetch_clear(Connection::Open | Connection::Closing, std::memory_order_release);
+					wins[t]++;
+				}
+				workers.fetch_toggle(mine, std::memory_order_relaxed);
+			}
+		});
+	}
+	unsigned total = 0;
+	for (unsigned t = 0; t < thread_count; t++) {
+		threads[t].join();
+		total += wins[t];
+	}
+	for (auto& connection : connections) {
+		if (connection.load() != Connection::Closed) {
+			return false;
+		}
+	}
+	return total == rounds && workers.load().none();
+}
+
+
 int main() {
 	std::bitset<8> firstComplement(static_cast<int>(~TestEnum::First));
 	std::cout << "First ones complement: " << firstComplement << std::endl;
@@ -40,5 +112,67 @@ int main() {
 			static_cast<int>(TestEnum::First | TestEnum::Second));
 	std::cout << "First | Second: " << firstAndSecond << std::endl;
 
+	TestEnum toggled = TestEnum::First | TestEnum::Third;
+	toggled ^= TestEnum::First;
+	std::cout << "(First | Third) ^= First: " << std::bitset<8>(static_cast<int>(toggled)) << std::endl;
+
+	EnumFlags<Permission> permissions = read_write;
+	permissions.toggle(Permission::Write).set(Permission::Execute);
+	std::cout << "Permissions (" << permissions.count() << "):";
+	for (Permission permission : permissions) {
+		std::cout << " " << drodil::general::enum_flags::flag_name(permission);
+	}
+	std::cout << std::endl;
+
+	std::cout << "Formatted: " << drodil::general::enum_flags::to_string(permissions) << std::endl;
+	EnumFlags<Permission> parsed;
+	if (drodil::general::enum_flags::parse("Write | Execute", parsed)) {
+		std::cout << "Parsed 'Write | Execute': " << std::bitset<8>(parsed.mask()) << std::endl;
+	}
+
+	AtomicEnumFlags<Permission> shared(Permission::Read);
+	std::cout << "Set Write only if Read is set: "
+			<< shared.transition(Permission::Read, {}, Permission::Write) << std::endl;
+	std::cout << "Set Execute only if Execute is clear, first: " << shared.test_and_set(Permission::Execute)
+			<< ", second: " << shared.test_and_set(Permission::Execute) << std::endl;
+	DynamicBitset primes(100, true);
+	primes.reset(0).reset(1);
+	for (std::size_t i = 2; i * i < primes.size(); i++) {
+		if (primes[i]) {
+			for (std::size_t j = i * i; j < primes.size(); j += i) {
+				primes.reset(j);
+			}
+		}
+	}
+	DynamicBitset odd(100);
+	for (std::size_t i = 1; i < odd.size(); i += 2) {
+		odd.set(i);
+	}
+	DynamicBitset even_primes(primes);
+	even_primes.and_not(odd);
+	RankSelect prime_index(primes);
+	std::cout << "Primes below 100: " << primes.count() << ", even ones: " << even_primes.count()
+			<< ", 10th prime: " << prime_index.select(9) << ", primes below 50: " << prime_index.rank(50)
+			<< std::endl;
+
+	// Record with big endian magic, varint length and 4-bit packed values
+	BinaryWriter writer;
+	writer.write<std::uint32_t>(0x89504e47, Endian::big);
+	writer.write_uleb128(300);
+	const std::uint32_t nibbles[] = {1, 2, 3, 4, 5, 6, 7};
+	writer.write_packed(nibbles, 7, 4);
+	BinaryReader reader(writer.data(), writer.size());
+	std::cout << "Record of " << writer.size() << " bytes, magic: " << std::hex << reader.read<std::uint32_t>(Endian::big)
+			<< std::dec << ", length: " << reader.read_uleb128() << ", values:";
+	std::uint32_t unpacked[7];
+	reader.read_packed(unpacked, 7, 4);
+	for (std::uint32_t value : unpacked) {
+		std::cout << " " << value;
+	}
+	std::cout << std::endl;
+
+	std::cout << "Atomic flags lock-free: " << shared.is_lock_free() << ", stress test passed: "
+			<< connection_stress_test() << std::endl;
+
 	return 1;
 }
@@ -0,0 +1,626 @@
+// benchmark.cpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "string_utils.hpp"
+#include "encoding.hpp"
+#include "fuzzy.hpp"
+#include "hash.hpp"
+#include "interner.hpp"
+#include "number.hpp"
+#include "multi_matcher.hpp"
+#include "string_builder.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace drodil::general::string;
+
+// Heap allocations made by the process, counted to report allocations per operation.
+// The replacements are kept out of line so GCC does not pair the inlined
+// malloc/free with new/delete expressions and warn about a mismatch.
+static std::atomic<std::size_t> g_allocations(0);
+
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](std::size_t size) { return ::operator new(size); }
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Prevents the compiler from optimizing away benchmarked results
+volatile std::size_t g_sink = 0;
+
+enum class Format { text, csv, json };
+
+// Output format and name filter given on the command line
+Format g_format = Format::text;
+const char* g_filter = nullptr;
+std::size_t g_reported = 0;
+
+// Check if benchmark with the given name passes the filter
+bool selected(const char* name) { return g_filter == nullptr || std::strstr(name, g_filter) != nullptr; }
+
+// Run fn ops times and report time per operation, throughput and allocations per operation
+template<typename Fn>
+void run(const char* name, std::size_t ops, std::size_t bytes_per_op, Fn fn) {
+    if (!selected(name)) {
+        return;
+    }
+    std::size_t allocations = g_allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < ops; i++) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    double ns_per_op = ns / ops;
+    double bytes_per_s = (static_cast<double>(bytes_per_op) * ops) / (ns / 1e9);
+    double allocs_per_op = static_cast<double>(allocations) / ops;
+    switch (g_format) {
+    case Format::text:
+        std::printf("%-40s %12.1f ns/op %10.1f MB/s %8.2f allocs/op\n", name, ns_per_op, bytes_per_s / (1024 * 1024),
+                    allocs_per_op);
+        break;
+    case Format::csv:
+        std::printf("%s,%zu,%.1f,%.0f,%.3f\n", name, ops, ns_per_op, bytes_per_s, allocs_per_op);
+        break;
+    case Format::json:
+        std::printf("%s\n    {\"name\": \"%s\", \"ops\": %zu, \"ns_per_op\": %.1f, \"bytes_per_s\": %.0f, "
+                    "\"allocs_per_op\": %.3f}",
+                    g_reported > 0 ? "," : "", name, ops, ns_per_op, bytes_per_s, allocs_per_op);
+        break;
+    }
+    ++g_reported;
+}
+
+// Deterministic text of about length bytes with delim after words of about spacing bytes
+std::string make_text(FastRandom& rng, std::size_t length, std::size_t spacing, const std::string& delim,
+                      bool utf8) {
+    static const char* const pieces[] = {"a", "e", "k", "s", "t", "\xc3\xa4", "\xc3\xb6", "\xe2\x82\xac",
+                                         "\xe6\x97\xa5"};
+    std::string ret;
+    ret.reserve(length + spacing + delim.size());
+    while (ret.size() < length) {
+        std::size_t word = ret.size() + 1 + rng() % (2 * spacing);
+        while (ret.size() < word) {
+            ret += pieces[rng() % (utf8 ? 9 : 5)];
+        }
+        ret += delim;
+    }
+    return ret;
+}
+
+// Random alphanumeric text from a fixed seed so runs are reproducible
+std::string seeded_text(std::size_t length) {
+    FastRandom rng(42);
+    std::string ret(length, '\0');
+    fill_random(&ret[0], length, rng);
+    return ret;
+}
+
+// The previous random_string implementation for comparison
+std::string mt19937_random_string(std::size_t length) {
+    static auto& chrs = "0123456789"
+                        "abcdefghijklmnopqrstuvwxyz"
+                        "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    thread_local static std::mt19937 rg{std::random_device{}()};
+    thread_local static std::uniform_int_distribution<std::string::size_type> pick(0, sizeof(chrs) - 2);
+    std::string ret;
+    ret.reserve(length);
+    while (length > 0) {
+        ret += chrs[pick(rg)];
+        --length;
+    }
+    return ret;
+}
+
+void bench_random() {
+    const std::size_t ops = 1000000;
+    run("random_string/mt19937/16", ops, 16, [] { g_sink += mt19937_random_string(16).size(); });
+    run("random_string/fast/16", ops, 16, [] { g_sink += random_string(16).size(); });
+    run("random_string/secure/16", ops / 10, 16, [] { g_sink += secure_random_string(16).size(); });
+    run("random_string/mt19937/256", ops / 10, 256, [] { g_sink += mt19937_random_string(256).size(); });
+    run("random_string/fast/256", ops / 10, 256, [] { g_sink += random_string(256).size(); });
+    run("random_strings/bulk/16x1000", ops / 1000, 16 * 1000,
+        [] { g_sink += random_strings(1000, 16).size(); });
+
+    FastRandom rng(42);
+    char buf[4096];
+    run("fill_random/4096", ops / 100, sizeof(buf), [&] {
+        fill_random(buf, sizeof(buf), rng);
+        g_sink += static_cast<unsigned char>(buf[0]);
+    });
+}
+
+void bench_split() {
+    FastRandom rng(42);
+    struct Input {
+        const char* name;
+        std::string text;
+        std::string delim;
+    };
+    const std::vector<Input> inputs{
+            {"split/short/few", make_text(rng, 32, 12, ",", false), ","},
+            {"split/short/many", make_text(rng, 32, 2, ",", false), ","},
+            {"split/long/few", make_text(rng, 64 * 1024, 256, ",", false), ","},
+            {"split/long/many", make_text(rng, 64 * 1024, 4, ",", false), ","},
+            {"split/long/utf8", make_text(rng, 64 * 1024, 16, "\xe3\x80\x81", true), "\xe3\x80\x81"},
+    };
+    for (const Input& input : inputs) {
+        std::size_t ops = std::max<std::size_t>(10, (64 * 1024 * 1024) / (input.text.size() * 64));
+        run(input.name, ops, input.text.size(), [&] { g_sink += split(input.text, input.delim).size(); });
+    }
+}
+
+void bench_trim() {
+    FastRandom rng(42);
+    const std::string ascii_pad = " \t  ";
+    const std::string utf8_pad = "\xe3\x80\x80 \xc2\xa0";
+    struct Input {
+        const char* name;
+        std::string text;
+    };
+    const std::vector<Input> inputs{
+            {"trim/short/ascii", ascii_pad + make_text(rng, 8, 8, "", false) + ascii_pad},
+            {"trim/short/utf8", utf8_pad + make_text(rng, 8, 8, "", true) + utf8_pad},
+            {"trim/short/none", make_text(rng, 12, 12, "", false)},
+            {"trim/long/ascii", ascii_pad + make_text(rng, 4096, 32, " ", false) + "x" + ascii_pad},
+            {"trim/long/utf8", utf8_pad + make_text(rng, 4096, 32, " ", true) + "x" + utf8_pad},
+    };
+    // Trimming is done in place, so every operation includes copying the input
+    // into a buffer that is reused to keep allocations out of the measurement
+    std::string str;
+    for (const Input& input : inputs) {
+        str.reserve(input.text.size());
+        run(input.name, 1000000 / (1 + input.text.size() / 64), input.text.size(), [&] {
+            str.assign(input.text);
+            g_sink += trim(str).size();
+        });
+    }
+}
+
+void bench_implode() {
+    FastRandom rng(42);
+    struct Input {
+        const char* name;
+        std::vector<std::string> elems;
+    };
+    std::vector<Input> inputs{{"implode/10x8", {}}, {"implode/1000x8", {}}, {"implode/100x1k/utf8", {}}};
+    for (std::size_t i = 0; i < 10; i++) {
+        inputs[0].elems.push_back(make_text(rng, 8, 8, "", false));
+    }
+    for (std::size_t i = 0; i < 1000; i++) {
+        inputs[1].elems.push_back(make_text(rng, 8, 8, "", false));
+    }
+    for (std::size_t i = 0; i < 100; i++) {
+        inputs[2].elems.push_back(make_text(rng, 1024, 1024, "", true));
+    }
+    for (const Input& input : inputs) {
+        std::size_t bytes = 0;
+        for (const std::string& elem : input.elems) {
+            bytes += elem.size() + 2;
+        }
+        run(input.name, std::max<std::size_t>(100, 100000000 / (bytes * 100)), bytes,
+            [&] { g_sink += implode(input.elems, ", ").size(); });
+    }
+}
+
+void bench_interner() {
+    // Token stream with many repeats, like hostnames after splitting log lines
+    std::vector<std::string> tokens;
+    for (std::size_t i = 0; i < 100000; i++) {
+        tokens.push_back("host-" + std::to_string(i % 1000) + ".example.com");
+    }
+
+    std::size_t i = 0;
+    run("intern/repeated", tokens.size() * 10, 24, [&] {
+        static StringInterner interner;
+        g_sink += interner.intern(tokens[i++ % tokens.size()]).id;
+    });
+
+    StringInterner shared;
+    const std::size_t thread_count = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4;
+    run("intern/concurrent", 1, tokens.size() * thread_count * 24, [&] {
+        std::vector<std::thread> threads;
+        std::vector<std::size_t> sums(thread_count);
+        for (std::size_t t = 0; t < thread_count; t++) {
+            threads.emplace_back([&, t] {
+                for (const auto& token : tokens) {
+                    sums[t] += shared.intern(token).id;
+                }
+            });
+        }
+        for (std::size_t t = 0; t < thread_count; t++) {
+            threads[t].join();
+            g_sink += sums[t];
+        }
+    });
+    if (g_format == Format::text && selected("intern/memory")) {
+        std::printf("%-40s %12zu unique %10zu bytes (copies would take %zu bytes)\n", "intern/memory", shared.size(),
+                    shared.memory_usage(), tokens.size() * sizeof(std::string) + tokens.size() * 24);
+    }
+}
+
+void bench_number() {
+    FastRandom rng(42);
+    std::vector<std::string> ints;
+    std::vector<std::string> doubles;
+    for (std::size_t i = 0; i < 10000; i++) {
+        char buf[32];
+        ints.push_back(std::string(buf, to_chars(buf, buf + sizeof(buf), static_cast<std::int64_t>(rng())).ptr));
+        double d = static_cast<double>(rng() >> 11) / (1ull << 53) * 1e6;
+        doubles.push_back(std::string(buf, to_chars(buf, buf + sizeof(buf), d).ptr));
+    }
+
+    const std::size_t ops = 1000000;
+    std::size_t i = 0;
+    run("parse/int64/istringstream", ops / 10, 20, [&] {
+        std::istringstream iss(ints[i++ % ints.size()]);
+        std::int64_t v = 0;
+        iss >> v;
+        g_sink += static_cast<std::size_t>(v);
+    });
+    run("parse/int64/strtoll", ops, 20, [&] {
+        g_sink += static_cast<std::size_t>(std::strtoll(ints[i++ % ints.size()].c_str(), nullptr, 10));
+    });
+    run("parse/int64/from_chars", ops, 20, [&] {
+        const std::string& str = ints[i++ % ints.size()];
+        std::int64_t v = 0;
+        from_chars(str.data(), str.data() + str.size(), v);
+        g_sink += static_cast<std::size_t>(v);
+    });
+    run("parse/double/istringstream", ops / 10, 17, [&] {
+        std::istringstream iss(doubles[i++ % doubles.size()]);
+        double v = 0;
+        iss >> v;
+        g_sink += static_cast<std::size_t>(v);
+    });
+    run("parse/double/strtod", ops, 17, [&] {
+        g_sink += static_cast<std::size_t>(std::strtod(doubles[i++ % doubles.size()].c_str(), nullptr));
+    });
+    run("parse/double/from_chars", ops, 17, [&] {
+        const std::string& str = doubles[i++ % doubles.size()];
+        double v = 0;
+        from_chars(str.data(), str.data() + str.size(), v);
+        g_sink += static_cast<std::size_t>(v);
+    });
+
+    char buf[32];
+    run("format/int64/ostringstream", ops / 10, 20, [&] {
+        std::ostringstream oss;
+        oss << static_cast<std::int64_t>(i++ * 2654435761u);
+        g_sink += oss.str().size();
+    });
+    run("format/int64/to_chars", ops, 20, [&] {
+        g_sink += to_chars(buf, buf + sizeof(buf), static_cast<std::int64_t>(i++ * 2654435761u)).ptr - buf;
+    });
+    run("format/double/snprintf", ops, 17, [&] {
+        g_sink += std::snprintf(buf, sizeof(buf), "%.17g", i++ * 0.1);
+    });
+    run("format/double/to_chars", ops, 17, [&] {
+        g_sink += to_chars(buf, buf + sizeof(buf), i++ * 0.1).ptr - buf;
+    });
+}
+
+void bench_multi_matcher() {
+    std::vector<std::string> keywords;
+    std::vector<std::string> replacements;
+    for (std::size_t i = 0; i < 50; i++) {
+        keywords.push_back("keyword" + std::to_string(i * 7919));
+        replacements.push_back("kw" + std::to_string(i));
+    }
+
+    FastRandom rng(42);
+    std::string text = seeded_text(1024 * 1024);
+    for (std::size_t i = 0; i < 2000; i++) {
+        const std::string& keyword = keywords[rng() % keywords.size()];
+        text.replace(rng() % (text.size() - keyword.size()), keyword.size(), keyword);
+    }
+
+    MultiMatcher matcher(keywords);
+    run("multi_matcher/find_all/50x1MB", 20, text.size(), [&] { g_sink += matcher.find_all(text).size(); });
+    run("multi_matcher/replace_all/50x1MB", 20, text.size(),
+        [&] { g_sink += matcher.replace_all(text, replacements).size(); });
+    run("std::string::find/50x1MB", 20, text.size(), [&] {
+        for (const auto& keyword : keywords) {
+            for (std::size_t pos = text.find(keyword); pos != std::string::npos; pos = text.find(keyword, pos + 1)) {
+                ++g_sink;
+            }
+        }
+    });
+}
+
+void bench_case() {
+    std::string ascii = seeded_text(4096);
+    std::string utf8 = ascii;
+    for (std::size_t i = 0; i < utf8.size(); i += 64) {
+        utf8.replace(i, 2, "\xc3\x84");
+    }
+    std::string copy;
+
+    run("case/std::transform(tolower)/4096", 10000, ascii.size(), [&] {
+        copy = ascii;
+        std::transform(copy.begin(), copy.end(), copy.begin(), ::tolower);
+        g_sink += static_cast<unsigned char>(copy[0]);
+    });
+    run("case/to_lower/ascii/4096", 10000, ascii.size(), [&] {
+        copy = ascii;
+        g_sink += static_cast<unsigned char>(to_lower(copy)[0]);
+    });
+    run("case/to_lower/utf8/4096", 10000, utf8.size(), [&] {
+        copy = utf8;
+        g_sink += static_cast<unsigned char>(to_lower(copy)[0]);
+    });
+
+    std::string upper = to_upper_copy(ascii);
+    run("case/iequals/ascii/4096", 10000, ascii.size(), [&] { g_sink += iequals(ascii, upper); });
+    run("case/ifind/ascii/4096", 10000, ascii.size(), [&] { g_sink += ifind(ascii, "not-in-haystack"); });
+}
+
+void bench_utf8() {
+    std::string ascii = seeded_text(1024 * 1024);
+    std::string mixed = ascii;
+    for (std::size_t i = 0; i < mixed.size(); i += 16) {
+        mixed.replace(i, 3, "\xe4\xb8\xad");
+    }
+    run("utf8/valid_prefix/ascii/1MB", 200, ascii.size(),
+        [&] { g_sink += utf8::valid_prefix(ascii.data(), ascii.size()); });
+    run("utf8/valid_prefix/mixed/1MB", 200, mixed.size(),
+        [&] { g_sink += utf8::valid_prefix(mixed.data(), mixed.size()); });
+
+    const std::string padded = "\xe3\x80\x80  \t some value with spaces \xc2\xa0\n";
+    run("trim/unicode", 1000000, padded.size(), [&] {
+        std::string copy = padded;
+        g_sink += trim(copy).size();
+    });
+}
+
+void bench_hash() {
+    std::hash<std::string> std_hash;
+    for (std::size_t size : {8, 32, 256, 4096, 1024 * 1024}) {
+        std::string data = seeded_text(size);
+        std::size_t ops = size > 4096 ? 200 : 1000000;
+        std::string label = std::to_string(size);
+        run(("hash/std::hash/" + label).c_str(), ops, size, [&] { g_sink += std_hash(data); });
+        run(("hash/hash64/" + label).c_str(), ops, size, [&] { g_sink += hash64(data); });
+        run(("hash/Hasher/" + label).c_str(), ops, size, [&] {
+            Hasher hasher;
+            g_sink += hasher.update(data).digest();
+        });
+    }
+
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < 10000; i++) {
+        keys.push_back("key-" + std::to_string(i));
+    }
+    std::unordered_map<std::string, std::size_t> std_map;
+    std::unordered_map<string_view, std::size_t, StringHash, StringEqual> view_map;
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        std_map[keys[i]] = i;
+        view_map[keys[i]] = i;
+    }
+    const char* probe = "key-1234 trailing";
+    run("hash/unordered_map<std::string>/lookup", 1000000, 8,
+        [&] { g_sink += std_map.find(std::string(probe, 8))->second; });
+    run("hash/unordered_map<string_view>/lookup", 1000000, 8,
+        [&] { g_sink += view_map.find(string_view(probe, 8))->second; });
+}
+
+void bench_encoding() {
+    const std::string data = seeded_text(1024 * 1024);
+    std::vector<char> out(base64_encoded_size(data.size()) + hex_encoded_size(data.size()));
+    std::vector<char> back(data.size());
+
+    run("encoding/hex/stringstream/64", 100000, 64, [&] {
+        std::stringstream ss;
+        for (std::size_t i = 0; i < 64; i++) {
+            ss << std::hex << std::setfill('0') << std::setw(2) << static_cast<int>(data[i] & 0xff);
+        }
+        g_sink += ss.str().size();
+    });
+    run("encoding/hex_encode/64", 100000, 64, [&] { g_sink += hex_encode(data.data(), 64, out.data()) - out.data(); });
+    run("encoding/hex_encode/1MB", 200, data.size(),
+        [&] { g_sink += hex_encode(data.data(), data.size(), out.data()) - out.data(); });
+    std::string hex = hex_encode(data);
+    run("encoding/hex_decode/1MB", 200, hex.size(), [&] { g_sink += hex_decode(hex.data(), hex.size(), back.data()); });
+    run("encoding/base64_encode/1MB", 200, data.size(),
+        [&] { g_sink += base64_encode(data.data(), data.size(), out.data()) - out.data(); });
+    std::string b64 = base64_encode(data);
+    run("encoding/base64_decode/1MB", 200, b64.size(),
+        [&] { g_sink += base64_decode(b64.data(), b64.size(), back.data()); });
+}
+
+// Classic dynamic programming distance for comparison
+std::size_t naive_levenshtein(const std::string& a, const std::string& b) {
+    std::vector<std::size_t> row(b.size() + 1);
+    for (std::size_t j = 0; j <= b.size(); j++) {
+        row[j] = j;
+    }
+    for (std::size_t i = 1; i <= a.size(); i++) {
+        std::size_t diagonal = row[0];
+        row[0] = i;
+        for (std::size_t j = 1; j <= b.size(); j++) {
+            std::size_t up = row[j];
+            row[j] = std::min(std::min(row[j] + 1, row[j - 1] + 1), diagonal + (a[i - 1] != b[j - 1]));
+            diagonal = up;
+        }
+    }
+    return row[b.size()];
+}
+
+void bench_fuzzy() {
+    FastRandom rng(42);
+    std::vector<std::string> vocabulary;
+    for (std::size_t i = 0; i < 100000; i++) {
+        std::string word(4 + rng() % 12, '\0');
+        fill_random(&word[0], word.size(), rng);
+        vocabulary.push_back(word);
+    }
+    const std::string query = vocabulary[500].substr(1) + "x";
+
+    run("fuzzy/naive/100k", 1, vocabulary.size() * query.size(), [&] {
+        for (const auto& word : vocabulary) {
+            g_sink += naive_levenshtein(query, word);
+        }
+    });
+    run("fuzzy/levenshtein/100k", 10, vocabulary.size() * query.size(), [&] {
+        for (const auto& word : vocabulary) {
+            g_sink += levenshtein(query, word);
+        }
+    });
+    FuzzyMatcher matcher(query);
+    run("fuzzy/FuzzyMatcher::find/100k/max2", 10, vocabulary.size() * query.size(),
+        [&] { g_sink += matcher.find(vocabulary, 2).size(); });
+    run("fuzzy/FuzzyMatcher::find/100k/top5", 10, vocabulary.size() * query.size(),
+        [&] { g_sink += matcher.find(vocabulary, FuzzyMatcher::npos, 5).size(); });
+
+    const std::string long_a = seeded_text(1000);
+    std::string long_b = long_a;
+    long_b[500] = '#';
+    run("fuzzy/levenshtein/1000x1000", 1000, long_a.size(), [&] { g_sink += levenshtein(long_a, long_b); });
+}
+
+void bench_string_builder() {
+    // Report style output of about 16MB built from short lines
+    const std::size_t lines = 400000;
+    const std::string line = "\n| " + seeded_text(32) + " | value: ";
+    const std::size_t bytes = lines * (line.size() + 7);
+
+    run("builder/std::string+=/16MB", 5, bytes, [&] {
+        std::string out;
+        for (std::size_t i = 0; i < lines; i++) {
+            out += line;
+            out += std::to_string(i % 1000000);
+        }
+        g_sink += out.size();
+    });
+    run("builder/std::ostringstream/16MB", 5, bytes, [&] {
+        std::ostringstream out;
+        for (std::size_t i = 0; i < lines; i++) {
+            out << line << i % 1000000;
+        }
+        g_sink += out.str().size();
+    });
+    run("builder/StringBuilder/16MB", 5, bytes, [&] {
+        StringBuilder out;
+        for (std::size_t i = 0; i < lines; i++) {
+            out << line << i % 1000000;
+        }
+        g_sink += out.size();
+    });
+
+    StringBuilder builder;
+    std::string flat;
+    for (std::size_t i = 0; i < lines; i++) {
+        builder << line << i % 1000000;
+    }
+    flat = builder.to_string();
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open("/dev/null", O_WRONLY);
+    if (fd >= 0) {
+        run("builder/to_string+write/16MB", 5, flat.size(), [&] {
+            std::string out = builder.to_string();
+            g_sink += static_cast<std::size_t>(::write(fd, out.data(), out.size()));
+        });
+        run("builder/writev/16MB", 5, flat.size(), [&] { builder.write_to(fd); });
+        ::close(fd);
+    }
+#endif
+
+    run("builder/insert/middle/1k", 1000, line.size(), [&] { builder.insert(builder.size() / 2, line); });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            g_format = Format::csv;
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            g_format = Format::json;
+        } else if (argv[i][0] == '-') {
+            std::fprintf(stderr, "Usage: %s [--csv|--json] [name filter]\n", argv[0]);
+            return 1;
+        } else {
+            g_filter = argv[i];
+        }
+    }
+    if (g_format == Format::csv) {
+        std::printf("name,ops,ns_per_op,bytes_per_s,allocs_per_op\n");
+    } else if (g_format == Format::json) {
+#if defined(__VERSION__)
+        const char* compiler = __VERSION__;
+#else
+        const char* compiler = "unknown";
+#endif
+        std::printf("{\n  \"compiler\": \"%s\",\n  \"benchmarks\": [", compiler);
+    }
+
+    bench_split();
+    bench_trim();
+    bench_implode();
+    bench_random();
+    bench_interner();
+    bench_number();
+    bench_multi_matcher();
+    bench_case();
+    bench_utf8();
+    bench_hash();
+    bench_encoding();
+    bench_fuzzy();
+    bench_string_builder();
+
+    if (g_format == Format::json) {
+        std::printf("\n  ]\n}\n");
+    }
+    return 0;
+}
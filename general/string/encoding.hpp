@@ -0,0 +1,472 @@
+// encoding.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_ENCODING_HPP_
+#define STRING_ENCODING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "string_view.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace drodil {
+namespace general {
+namespace string {
+
+/// \brief Base64 alphabet variants
+enum class Base64Alphabet {
+    /// RFC 4648 section 4, '+' and '/'
+    standard,
+    /// RFC 4648 section 5, '-' and '_'
+    url_safe
+};
+
+namespace detail {
+
+static const char hex_lower[] = "0123456789abcdef";
+static const char hex_upper[] = "0123456789ABCDEF";
+
+/// \brief Value of hex digit or -1
+static inline int hex_value(char c) noexcept {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = static_cast<char>(c | 0x20);
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+#if defined(__SSE2__)
+/// \brief Convert 16 nibbles to hex digit characters
+static inline __m128i hex_nibbles_to_chars(__m128i nibbles, bool uppercase) noexcept {
+    const __m128i letter_gap = _mm_set1_epi8(uppercase ? 'A' - '0' - 10 : 'a' - '0' - 10);
+    __m128i is_letter = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), _mm_and_si128(is_letter, letter_gap));
+}
+
+/// \brief Convert 16 hex characters to nibbles
+///
+/// \return bool False if any character isn't a hex digit
+static inline bool hex_chars_to_nibbles(__m128i v, __m128i& nibbles) noexcept {
+    __m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i alpha = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+    __m128i is_alpha =
+        _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xFFFF) {
+        return false;
+    }
+    nibbles = _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_and_si128(is_alpha, alpha));
+    return true;
+}
+#endif
+
+/// \brief Base64 characters of an alphabet
+static inline const char* base64_chars(Base64Alphabet alphabet) noexcept {
+    return alphabet == Base64Alphabet::standard
+               ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+               : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+}
+
+/// \brief Lookup table from 12 bits to two base64 characters
+struct Base64PairTable {
+    explicit Base64PairTable(Base64Alphabet alphabet) {
+        const char* chars = base64_chars(alphabet);
+        for (unsigned i = 0; i < 4096; i++) {
+            pairs[i * 2] = chars[i >> 6];
+            pairs[i * 2 + 1] = chars[i & 63];
+        }
+    }
+    char pairs[4096 * 2];
+};
+
+/// \brief Pair table for alphabet, built on first use
+static inline const char* base64_pairs(Base64Alphabet alphabet) {
+    static const Base64PairTable standard(Base64Alphabet::standard);
+    static const Base64PairTable url_safe(Base64Alphabet::url_safe);
+    return alphabet == Base64Alphabet::standard ? standard.pairs : url_safe.pairs;
+}
+
+/// \brief Lookup table from character to 6-bit value, 0xFF for invalid
+struct Base64DecodeTable {
+    explicit Base64DecodeTable(Base64Alphabet alphabet) {
+        std::memset(values, 0xFF, sizeof(values));
+        const char* chars = base64_chars(alphabet);
+        for (unsigned i = 0; i < 64; i++) {
+            values[static_cast<unsigned char>(chars[i])] = static_cast<unsigned char>(i);
+        }
+    }
+    unsigned char values[256];
+};
+
+/// \brief Decode table for alphabet, built on first use
+static inline const unsigned char* base64_values(Base64Alphabet alphabet) {
+    static const Base64DecodeTable standard(Base64Alphabet::standard);
+    static const Base64DecodeTable url_safe(Base64Alphabet::url_safe);
+    return alphabet == Base64Alphabet::standard ? standard.values : url_safe.values;
+}
+
+#if defined(__SSSE3__)
+/// \brief Encode 12 bytes of in to 16 base64 characters (Mula's method)
+static inline __m128i base64_encode_block(__m128i in, Base64Alphabet alphabet) noexcept {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    __m128i indices = _mm_or_si128(t1, t3);
+
+    __m128i shift = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    shift = _mm_or_si128(shift, _mm_and_si128(less, _mm_set1_epi8(13)));
+    const char c62 = alphabet == Base64Alphabet::standard ? '+' : '-';
+    const char c63 = alphabet == Base64Alphabet::standard ? '/' : '_';
+    const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                            '0' - 52, '0' - 52, '0' - 52, '0' - 52, static_cast<char>(c62 - 62),
+                                            static_cast<char>(c63 - 63), 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(shift_lut, shift), indices);
+}
+#endif
+
+} // namespace detail
+
+/// \brief Size of hex encoding of n bytes
+///
+/// \param[in] n size_t Number of bytes
+///
+/// \return size_t
+static inline std::size_t hex_encoded_size(std::size_t n) noexcept { return n * 2; }
+
+/// \brief Hex encode bytes into caller buffer
+///
+/// Encodes 32 (AVX2) or 16 (SSE2) bytes per step.
+///
+/// \param[in]  src       Bytes to encode
+/// \param[in]  n         size_t Number of bytes
+/// \param[out] out       Buffer of at least hex_encoded_size(n) characters
+/// \param[in]  uppercase bool Use A-F instead of a-f
+///
+/// \return char* End of the written characters
+static inline char* hex_encode(const void* src, std::size_t n, char* out, bool uppercase = false) noexcept {
+    const unsigned char* in = static_cast<const unsigned char*>(src);
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i mask256 = _mm256_set1_epi8(0x0F);
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i zero_char = _mm256_set1_epi8('0');
+    const __m256i letter_gap = _mm256_set1_epi8(uppercase ? 'A' - '0' - 10 : 'a' - '0' - 10);
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask256);
+        __m256i lo = _mm256_and_si256(v, mask256);
+        hi = _mm256_add_epi8(_mm256_add_epi8(hi, zero_char), _mm256_and_si256(_mm256_cmpgt_epi8(hi, nine), letter_gap));
+        lo = _mm256_add_epi8(_mm256_add_epi8(lo, zero_char), _mm256_and_si256(_mm256_cmpgt_epi8(lo, nine), letter_gap));
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(a, b, 0x31));
+        out += 64;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i hi = detail::hex_nibbles_to_chars(_mm_and_si128(_mm_srli_epi16(v, 4), mask), uppercase);
+        __m128i lo = detail::hex_nibbles_to_chars(_mm_and_si128(v, mask), uppercase);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+        out += 32;
+    }
+#endif
+    const char* digits = uppercase ? detail::hex_upper : detail::hex_lower;
+    for (; i < n; i++) {
+        *out++ = digits[in[i] >> 4];
+        *out++ = digits[in[i] & 0x0F];
+    }
+    return out;
+}
+
+/// \brief Hex encode bytes to string
+///
+/// \param[in] data      string_view Bytes to encode
+/// \param[in] uppercase bool Use A-F instead of a-f
+///
+/// \return std::string
+static inline std::string hex_encode(string_view data, bool uppercase = false) {
+    std::string ret(hex_encoded_size(data.size()), '\0');
+    if (!ret.empty()) {
+        hex_encode(data.data(), data.size(), &ret[0], uppercase);
+    }
+    return ret;
+}
+
+/// \brief Size of decoded hex string
+///
+/// \param[in] n size_t Number of hex characters
+///
+/// \return size_t
+static inline std::size_t hex_decoded_size(std::size_t n) noexcept { return n / 2; }
+
+/// \brief Decode hex characters into caller buffer
+///
+/// Accepts upper and lower case digits, decodes 16 bytes per SSE2 step.
+///
+/// \param[in]  src Hex characters
+/// \param[in]  n   size_t Number of characters
+/// \param[out] out Buffer of at least hex_decoded_size(n) bytes
+///
+/// \return bool False if the length is odd or a character isn't a hex digit
+static inline bool hex_decode(const char* src, std::size_t n, void* out) noexcept {
+    if (n % 2 != 0) {
+        return false;
+    }
+    unsigned char* dst = static_cast<unsigned char*>(out);
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 32 <= n; i += 32) {
+        __m128i a, b;
+        if (!detail::hex_chars_to_nibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), a) ||
+            !detail::hex_chars_to_nibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16)), b)) {
+            return false;
+        }
+        // Each 16-bit lane holds high nibble in the low byte, low nibble in the high byte
+        const __m128i low_byte = _mm_set1_epi16(0x00FF);
+        a = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(a, low_byte), 4), _mm_srli_epi16(a, 8));
+        b = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b, low_byte), 4), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(a, b));
+        dst += 16;
+    }
+#endif
+    for (; i < n; i += 2) {
+        int hi = detail::hex_value(src[i]);
+        int lo = detail::hex_value(src[i + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        *dst++ = static_cast<unsigned char>((hi << 4) | lo);
+    }
+    return true;
+}
+
+/// \brief Decode hex string
+///
+/// \param[in]  hex string_view Hex characters
+/// \param[out] out std::string Decoded bytes, untouched on error
+///
+/// \return bool False on invalid input
+static inline bool hex_decode(string_view hex, std::string& out) {
+    std::string decoded(hex_decoded_size(hex.size()), '\0');
+    if (!hex_decode(hex.data(), hex.size(), decoded.empty() ? nullptr : &decoded[0])) {
+        return false;
+    }
+    out.swap(decoded);
+    return true;
+}
+
+/// \brief Size of base64 encoding of n bytes
+///
+/// \param[in] n       size_t Number of bytes
+/// \param[in] padding bool   Pad with '=' to multiple of four characters
+///
+/// \return size_t
+static inline std::size_t base64_encoded_size(std::size_t n, bool padding = true) noexcept {
+    return padding ? (n + 2) / 3 * 4 : (n * 4 + 2) / 3;
+}
+
+/// \brief Base64 encode bytes into caller buffer
+///
+/// Uses a 12-bit to two character lookup table, and encodes 12 bytes per
+/// step with SSSE3 when available.
+///
+/// \param[in]  src      Bytes to encode
+/// \param[in]  n        size_t Number of bytes
+/// \param[out] out      Buffer of at least base64_encoded_size(n, padding) characters
+/// \param[in]  alphabet Base64Alphabet Alphabet to use
+/// \param[in]  padding  bool Pad with '=' to multiple of four characters
+///
+/// \return char* End of the written characters
+static inline char* base64_encode(const void* src, std::size_t n, char* out,
+                                  Base64Alphabet alphabet = Base64Alphabet::standard, bool padding = true) {
+    const unsigned char* in = static_cast<const unsigned char*>(src);
+    std::size_t i = 0;
+#if defined(__SSSE3__)
+    for (; i + 16 <= n; i += 12) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), detail::base64_encode_block(v, alphabet));
+        out += 16;
+    }
+#endif
+    const char* pairs = detail::base64_pairs(alphabet);
+    for (; i + 3 <= n; i += 3) {
+        std::uint32_t v = (static_cast<std::uint32_t>(in[i]) << 16) | (static_cast<std::uint32_t>(in[i + 1]) << 8) | in[i + 2];
+        std::memcpy(out, pairs + (v >> 12) * 2, 2);
+        std::memcpy(out + 2, pairs + (v & 0xFFF) * 2, 2);
+        out += 4;
+    }
+
+    const char* chars = detail::base64_chars(alphabet);
+    if (n - i == 1) {
+        *out++ = chars[in[i] >> 2];
+        *out++ = chars[(in[i] & 0x03) << 4];
+        if (padding) {
+            *out++ = '=';
+            *out++ = '=';
+        }
+    } else if (n - i == 2) {
+        *out++ = chars[in[i] >> 2];
+        *out++ = chars[((in[i] & 0x03) << 4) | (in[i + 1] >> 4)];
+        *out++ = chars[(in[i + 1] & 0x0F) << 2];
+        if (padding) {
+            *out++ = '=';
+        }
+    }
+    return out;
+}
+
+/// \brief Base64 encode bytes to string
+///
+/// \param[in] data     string_view Bytes to encode
+/// \param[in] alphabet Base64Alphabet Alphabet to use
+/// \param[in] padding  bool Pad with '=' to multiple of four characters
+///
+/// \return std::string
+static inline std::string base64_encode(string_view data, Base64Alphabet alphabet = Base64Alphabet::standard,
+                                        bool padding = true) {
+    std::string ret(base64_encoded_size(data.size(), padding), '\0');
+    if (!ret.empty()) {
+        base64_encode(data.data(), data.size(), &ret[0], alphabet, padding);
+    }
+    return ret;
+}
+
+/// \brief Exact size of decoded base64 input
+///
+/// \param[in] src Base64 characters, padded or not
+/// \param[in] n   size_t Number of characters
+///
+/// \return size_t
+static inline std::size_t base64_decoded_size(const char* src, std::size_t n) noexcept {
+    if (n >= 1 && src[n - 1] == '=') {
+        --n;
+    }
+    if (n >= 1 && src[n - 1] == '=') {
+        --n;
+    }
+    return n / 4 * 3 + (n % 4 ? n % 4 - 1 : 0);
+}
+
+/// \brief Decode base64 into caller buffer
+///
+/// Padding is optional but, if present, must complete the last group.
+///
+/// \param[in]  src      Base64 characters
+/// \param[in]  n        size_t Number of characters
+/// \param[out] out      Buffer of at least base64_decoded_size(src, n) bytes
+/// \param[in]  alphabet Base64Alphabet Alphabet to use
+///
+/// \return bool False on characters outside the alphabet or invalid length
+static inline bool base64_decode(const char* src, std::size_t n, void* out,
+                                 Base64Alphabet alphabet = Base64Alphabet::standard) {
+    std::size_t data_len = n;
+    if (data_len >= 1 && src[data_len - 1] == '=') {
+        --data_len;
+        if (data_len >= 1 && src[data_len - 1] == '=') {
+            --data_len;
+        }
+        if (n % 4 != 0) {
+            return false;
+        }
+    }
+    if (data_len % 4 == 1) {
+        return false;
+    }
+
+    const unsigned char* values = detail::base64_values(alphabet);
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+    unsigned char* dst = static_cast<unsigned char*>(out);
+    std::size_t i = 0;
+    for (; i + 4 <= data_len; i += 4) {
+        unsigned a = values[in[i]], b = values[in[i + 1]], c = values[in[i + 2]], d = values[in[i + 3]];
+        // Invalid characters map to 0xFF, any of them sets the high bit
+        if ((a | b | c | d) & 0x80) {
+            return false;
+        }
+        std::uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+        dst[0] = static_cast<unsigned char>(v >> 16);
+        dst[1] = static_cast<unsigned char>(v >> 8);
+        dst[2] = static_cast<unsigned char>(v);
+        dst += 3;
+    }
+
+    std::size_t rest = data_len - i;
+    if (rest >= 2) {
+        unsigned a = values[in[i]], b = values[in[i + 1]];
+        unsigned c = rest == 3 ? values[in[i + 2]] : 0;
+        if ((a | b | c) & 0x80) {
+            return false;
+        }
+        *dst++ = static_cast<unsigned char>((a << 2) | (b >> 4));
+        if (rest == 3) {
+            *dst++ = static_cast<unsigned char>((b << 4) | (c >> 2));
+        }
+    }
+    return true;
+}
+
+/// \brief Decode base64 string
+///
+/// \param[in]  data     string_view Base64 characters
+/// \param[out] out      std::string Decoded bytes, untouched on error
+/// \param[in]  alphabet Base64Alphabet Alphabet to use
+///
+/// \return bool False on invalid input
+static inline bool base64_decode(string_view data, std::string& out,
+                                 Base64Alphabet alphabet = Base64Alphabet::standard) {
+    std::string decoded(base64_decoded_size(data.data(), data.size()), '\0');
+    if (!base64_decode(data.data(), data.size(), decoded.empty() ? nullptr : &decoded[0], alphabet)) {
+        return false;
+    }
+    out.swap(decoded);
+    return true;
+}
+
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_ENCODING_HPP_
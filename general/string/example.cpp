@@ -23,10 +23,131 @@
 // SOFTWARE.
 
 #include "string_utils.hpp"
+#include "encoding.hpp"
+#include "fuzzy.hpp"
+#include "hash.hpp"
+#include "interner.hpp"
+#include "number.hpp"
+#include "multi_matcher.hpp"
+#include "string_builder.hpp"
 #include <iostream>
+#include <random>
+#include <vector>
 
 using namespace drodil::general::string;
 
+namespace {
+
+/// \brief Scalar reference of to_lower/to_upper decoding every code point
+template <typename Map> std::string reference_case(std::string str, Map map) {
+    std::size_t i = 0;
+    while (i < str.size()) {
+        std::uint32_t cp;
+        std::size_t len = utf8::decode(&str[i], str.size() - i, cp);
+        if (cp != utf8::invalid_code_point) {
+            utf8::encode(map(cp), &str[i]);
+        }
+        i += len;
+    }
+    return str;
+}
+
+/// \brief Scalar reference of the case-insensitive prefix match
+bool reference_iequal_prefix(const std::string& a, std::size_t i, const std::string& b, std::size_t& consumed) {
+    std::size_t j = 0;
+    while (j < b.size()) {
+        if (i == a.size()) {
+            return false;
+        }
+        std::uint32_t ca, cb;
+        std::size_t la = utf8::decode(&a[i], a.size() - i, ca);
+        std::size_t lb = utf8::decode(&b[j], b.size() - j, cb);
+        if (ca == utf8::invalid_code_point || cb == utf8::invalid_code_point) {
+            if (la != lb || a[i] != b[j]) {
+                return false;
+            }
+        } else if (utf8::fold_case(ca) != utf8::fold_case(cb)) {
+            return false;
+        }
+        i += la;
+        j += lb;
+    }
+    consumed = i;
+    return true;
+}
+
+bool reference_iequals(const std::string& a, const std::string& b) {
+    std::size_t consumed = 0;
+    return reference_iequal_prefix(a, 0, b, consumed) && consumed == a.size();
+}
+
+std::size_t reference_ifind(const std::string& haystack, const std::string& needle, std::size_t pos) {
+    if (pos > haystack.size()) {
+        return std::string::npos;
+    }
+    if (needle.empty()) {
+        return pos;
+    }
+    for (std::size_t i = pos; i < haystack.size(); i++) {
+        std::size_t consumed;
+        if ((static_cast<unsigned char>(haystack[i]) & 0xC0) != 0x80 &&
+            reference_iequal_prefix(haystack, i, needle, consumed)) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+/// \brief Compare the vectorized case functions against the scalar reference
+///
+/// Strings of every length from 0 to 80 bytes cover the SIMD blocks and
+/// their tails. They mix ASCII, multi-byte UTF-8 and malformed bytes, and
+/// cutting them to length also leaves truncated sequences.
+bool case_sweep_test() {
+    static const char* const pieces[] = {"a", "Z", "q", "M", "0", " ", "@", "[", "`", "{", "\xc3\xa4", "\xc3\x84",
+                                         "\xc3\x9f", "\xce\xa3", "\xcf\x83", "\xd0\x96", "\xd0\xb6",
+                                         "\xef\xbc\xa1", "\xef\xbd\x81", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+                                         "\x80", "\xc3", "\xff", "\xe2\x82", "\xc0\xaf", "\xed\xa0\x80"};
+    const std::size_t piece_count = sizeof(pieces) / sizeof(pieces[0]);
+    std::mt19937 rng(30);
+    for (std::size_t length = 0; length <= 80; length++) {
+        for (int round = 0; round < 50; round++) {
+            // Mostly ASCII so the vectorized runs are exercised
+            std::string a;
+            while (a.size() < length) {
+                a += pieces[rng() % 4 == 0 ? rng() % piece_count : rng() % 10];
+            }
+            a.resize(length);
+
+            std::string lower = a, upper = a;
+            if (to_lower(lower) != reference_case(a, utf8::to_lower) ||
+                to_upper(upper) != reference_case(a, utf8::to_upper)) {
+                return false;
+            }
+
+            // Same text in other cases, sometimes with one byte changed
+            std::string b = rng() % 2 == 0 ? upper : lower;
+            if (rng() % 4 == 0 && !b.empty()) {
+                b[rng() % b.size()] ^= static_cast<char>(1 << (rng() % 8));
+            }
+            if (iequals(a, b) != reference_iequals(a, b) || iequals(b, a) != reference_iequals(b, a)) {
+                return false;
+            }
+
+            std::size_t start = length == 0 ? 0 : rng() % length;
+            std::string needle = b.substr(start, rng() % 12);
+            std::size_t pos = rng() % (length + 2);
+            if (ifind(a, needle, pos) != reference_ifind(a, needle, pos) ||
+                ifind(b, needle, 0) != reference_ifind(b, needle, 0)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
 int main() {
     std::string splitted = "Hello World From Oulu Finland";
     std::cout << "Splitting string: " << splitted << std::endl;
@@ -48,9 +169,89 @@ int main() {
     std::cout << "trim for '" << lr << "' -> ";
     std::cout << "'" << trim(lr) << "'" << std::endl;
 
+    std::string unicode = "\xe3\x80\x80\xc2\xa0Unicode spaces\xe2\x80\xaf\xe3\x80\x80";
+    std::cout << "trim with ideographic space, NBSP and narrow NBSP -> ";
+    std::cout << "'" << trim(unicode) << "'" << std::endl;
+
+    std::string invalid = "valid \xc3\xa4 then \xc3\x28 invalid";
+    std::cout << "UTF-8 valid: " << std::boolalpha << utf8::is_valid(invalid.data(), invalid.size())
+              << ", first invalid byte at " << utf8::valid_prefix(invalid.data(), invalid.size()) << std::endl;
+
     std::cout << "Random string of 5 characters: " << random_string(5) << std::endl;
     std::cout << "Random string of 50 characters: " << random_string(50) << std::endl;
+    std::cout << "Three random strings of 8 characters in one buffer: " << random_strings(3, 8) << std::endl;
+    std::cout << "Secure random token: " << secure_random_string(32) << std::endl;
+
+    std::string mixed = "Hello World, Grüße aus Oulu";
+    std::cout << "to_lower_copy: " << to_lower_copy(mixed) << std::endl;
+    std::cout << "to_upper_copy: " << to_upper_copy(mixed) << std::endl;
+    std::cout << "iequals(\"GRÜSSE\", \"grüsse\"): " << std::boolalpha << iequals("GRÜSSE", "grüsse") << std::endl;
+    std::cout << "ifind(\"" << mixed << "\", \"OULU\"): " << ifind(mixed, "OULU") << std::endl;
+    std::cout << "Case functions match scalar reference for lengths 0..80: " << case_sweep_test() << std::endl;
 
     std::vector<std::string> elems{"elem1", "elem2", "elem3"};
     std::cout << "Imploded: " << drodil::general::string::implode(elems, "#") << std::endl;
+
+    const std::string raw = "\x89PNG\r\n\x1a\n";
+    std::string decoded;
+    std::cout << "hex_encode(PNG magic): " << hex_encode(raw, true) << std::endl;
+    std::cout << "base64_encode(\"Hello?>\"): " << base64_encode("Hello?>")
+              << ", url safe without padding: " << base64_encode("Hello?>", Base64Alphabet::url_safe, false) << std::endl;
+    if (base64_decode("SGVsbG8/Pg==", decoded)) {
+        std::cout << "base64_decode(\"SGVsbG8/Pg==\"): " << decoded << std::endl;
+    }
+    std::cout << "hex_decode(\"zz\") valid: " << std::boolalpha << hex_decode("zz", decoded) << std::endl;
+
+    Hasher hasher;
+    hasher.update("Hello ").update("World");
+    std::cout << "hash64(\"Hello World\") = " << std::hex << hash64("Hello World") << ", incremental = " << hasher.digest()
+              << std::dec << std::endl;
+
+    StringInterner interner;
+    Symbol host1 = interner.intern("example.com");
+    Symbol host2 = interner.intern(std::string("example.") + "com");
+    Symbol host3 = interner.intern("example.org");
+    std::cout << "Interned '" << interner.view(host1) << "' twice, same symbol: " << std::boolalpha
+              << (host1 == host2) << ", differs from '" << interner.view(host3) << "': " << (host1 != host3)
+              << std::endl;
+
+    const std::string number = "-12345.678e-2";
+    double d = 0;
+    from_chars_result parsed = from_chars(number.data(), number.data() + number.size(), d);
+    char formatted[32];
+    to_chars_result written = to_chars(formatted, formatted + sizeof(formatted), d);
+    std::cout << "Parsed '" << number << "' consuming " << (parsed.ptr - number.data()) << " characters, formatted back: "
+              << std::string(formatted, written.ptr) << std::endl;
+
+    const std::string too_large = "300";
+    unsigned char byte = 0;
+    if (from_chars(too_large.data(), too_large.data() + too_large.size(), byte).ec == std::errc::result_out_of_range) {
+        std::cout << "'" << too_large << "' does not fit into unsigned char" << std::endl;
+    }
+
+    MultiMatcher matcher({"he", "she", "his", "hers"});
+    std::string searched = "ushers and his hens";
+    std::cout << "Keywords found in '" << searched << "':";
+    for (const Match& match : matcher.find_all(searched)) {
+        std::cout << " " << searched.substr(match.position, match.length) << "@" << match.position;
+    }
+    std::cout << std::endl;
+    std::cout << "Replaced: " << matcher.replace_all(searched, {"HE", "SHE", "HIS", "HERS"}) << std::endl;
+
+    std::vector<std::string> commands{"install", "uninstall", "update", "upgrade", "list", "search"};
+    std::cout << "levenshtein(\"kitten\", \"sitting\"): " << levenshtein("kitten", "sitting") << std::endl;
+    std::cout << "'upgarde' did you mean:";
+    for (const FuzzyMatch& match : FuzzyMatcher("upgarde").find(commands, 3, 2)) {
+        std::cout << " " << commands[match.index] << " (" << match.distance << ")";
+    }
+    std::cout << std::endl;
+
+    StringBuilder report(16);
+    report << "Lines: " << 3 << "\n";
+    for (int line = 1; line <= 3; line++) {
+        report << "  line " << line << " of the report\n";
+    }
+    report.insert(0, "== Report ==\n");
+    std::cout << "Built " << report.size() << " bytes in " << report.chunk_count() << " chunks:" << std::endl
+              << report;
 }
@@ -0,0 +1,263 @@
+// fuzzy.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_FUZZY_HPP_
+#define STRING_FUZZY_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "string_view.hpp"
+
+namespace drodil {
+namespace general {
+namespace string {
+
+namespace detail {
+
+/// \brief Myers' algorithm for patterns of 1 to 64 bytes
+///
+/// \param[in] peq          Match bit vector of the pattern for each byte value
+/// \param[in] m            size_t Pattern length
+/// \param[in] text         string_view Text to compare the pattern with
+/// \param[in] max_distance size_t Upper bound of interest
+///
+/// \return size_t Distance, or max_distance + 1 if it's larger than max_distance
+static inline std::size_t myers_distance(const std::uint64_t* peq, std::size_t m, string_view text,
+                                         std::size_t max_distance) noexcept {
+    const std::uint64_t last = std::uint64_t(1) << (m - 1);
+    std::uint64_t pv = ~std::uint64_t(0);
+    std::uint64_t mv = 0;
+    std::size_t score = m;
+    const std::size_t n = text.size();
+    for (std::size_t j = 0; j < n; j++) {
+        std::uint64_t eq = peq[static_cast<unsigned char>(text[j])];
+        std::uint64_t xv = eq | mv;
+        std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        std::uint64_t ph = mv | ~(xh | pv);
+        std::uint64_t mh = pv & xh;
+        if (ph & last) {
+            ++score;
+        } else if (mh & last) {
+            --score;
+        }
+        // Row zero of the matrix grows by one per column
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        // Each remaining column lowers the score by at most one
+        if (score > max_distance && score - max_distance > n - j - 1) {
+            return max_distance + 1;
+        }
+    }
+    return score;
+}
+
+} // namespace detail
+
+/// \brief Candidate found by FuzzyMatcher::find
+struct FuzzyMatch {
+    /// Index of the candidate
+    std::size_t index;
+    /// Levenshtein distance to the query
+    std::size_t distance;
+};
+
+/// \brief Levenshtein distance of a fixed query against many candidates
+///
+/// Uses Myers' bit-parallel algorithm with Hyyro's block extension, so one
+/// candidate character updates 64 rows of the dynamic programming matrix at
+/// once. The match bit vectors of the query are built once and reused for
+/// every candidate. Distances are counted in bytes.
+class FuzzyMatcher {
+public:
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// \brief Precompute match vectors for query
+    ///
+    /// \param[in] query string_view String to compare candidates against
+    explicit FuzzyMatcher(string_view query)
+        : m_length(query.size()), m_blocks((query.size() + 63) / 64), m_peq(256 * m_blocks, 0) {
+        for (std::size_t i = 0; i < query.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(query[i]);
+            m_peq[c * m_blocks + i / 64] |= std::uint64_t(1) << (i % 64);
+        }
+    }
+
+    /// \brief Levenshtein distance between query and candidate
+    ///
+    /// With a bound the computation stops as soon as the distance is known to
+    /// exceed it.
+    ///
+    /// \param[in] candidate    string_view String to compare
+    /// \param[in] max_distance size_t      Upper bound of interest
+    ///
+    /// \return size_t Distance, or max_distance + 1 if it's larger than max_distance
+    std::size_t distance(string_view candidate, std::size_t max_distance = npos) const {
+        const std::size_t n = candidate.size();
+        const std::size_t diff = n > m_length ? n - m_length : m_length - n;
+        if (diff > max_distance) {
+            return max_distance + 1;
+        }
+        if (m_length == 0) {
+            return n;
+        }
+        if (m_blocks == 1) {
+            return detail::myers_distance(m_peq.data(), m_length, candidate, max_distance);
+        }
+        return distance_blocks(candidate, max_distance);
+    }
+
+    /// \brief Score all candidates against the query
+    ///
+    /// With a limit only the best limit candidates are kept, and the bound
+    /// tightens to the worst of them as better candidates are found.
+    ///
+    /// \param[in] candidates   std::vector<std::string> Strings to compare
+    /// \param[in] max_distance size_t Largest distance to report
+    /// \param[in] limit        size_t Maximum number of results, 0 for all
+    ///
+    /// \return std::vector<FuzzyMatch> Sorted by distance, then index
+    std::vector<FuzzyMatch> find(const std::vector<std::string>& candidates, std::size_t max_distance,
+                                 std::size_t limit = 0) const {
+        std::vector<FuzzyMatch> ret;
+        auto worse = [](const FuzzyMatch& a, const FuzzyMatch& b) {
+            return a.distance != b.distance ? a.distance < b.distance : a.index < b.index;
+        };
+        std::size_t bound = max_distance;
+        for (std::size_t i = 0; i < candidates.size(); i++) {
+            std::size_t d = distance(candidates[i], bound);
+            if (d > bound) {
+                continue;
+            }
+            FuzzyMatch match = {i, d};
+            if (limit == 0) {
+                ret.push_back(match);
+                continue;
+            }
+            // Max heap of the best limit matches
+            if (ret.size() == limit) {
+                if (d >= ret.front().distance) {
+                    continue;
+                }
+                std::pop_heap(ret.begin(), ret.end(), worse);
+                ret.pop_back();
+            }
+            ret.push_back(match);
+            std::push_heap(ret.begin(), ret.end(), worse);
+            if (ret.size() == limit) {
+                bound = ret.front().distance;
+            }
+        }
+        std::sort(ret.begin(), ret.end(), worse);
+        return ret;
+    }
+
+private:
+    /// \brief Block based algorithm for queries longer than 64 bytes
+    std::size_t distance_blocks(string_view text, std::size_t max_distance) const {
+        std::vector<std::uint64_t> pv(m_blocks, ~std::uint64_t(0));
+        std::vector<std::uint64_t> mv(m_blocks, 0);
+        const std::uint64_t high = std::uint64_t(1) << 63;
+        const std::uint64_t last = std::uint64_t(1) << ((m_length - 1) % 64);
+        std::size_t score = m_length;
+        const std::size_t n = text.size();
+        for (std::size_t j = 0; j < n; j++) {
+            const std::uint64_t* peq = &m_peq[static_cast<unsigned char>(text[j]) * m_blocks];
+            int hin = 1;
+            for (std::size_t b = 0; b < m_blocks; b++) {
+                std::uint64_t eq = peq[b];
+                std::uint64_t p = pv[b];
+                std::uint64_t m = mv[b];
+                std::uint64_t xv = eq | m;
+                // A negative horizontal delta coming in acts like a match in the first row
+                if (hin < 0) {
+                    eq |= 1;
+                }
+                std::uint64_t xh = (((eq & p) + p) ^ p) | eq;
+                std::uint64_t ph = m | ~(xh | p);
+                std::uint64_t mh = p & xh;
+                std::uint64_t out_bit = b + 1 == m_blocks ? last : high;
+                int hout = (ph & out_bit) ? 1 : ((mh & out_bit) ? -1 : 0);
+                ph <<= 1;
+                mh <<= 1;
+                if (hin < 0) {
+                    mh |= 1;
+                } else if (hin > 0) {
+                    ph |= 1;
+                }
+                pv[b] = mh | ~(xv | ph);
+                mv[b] = ph & xv;
+                hin = hout;
+            }
+            score += hin;
+            if (score > max_distance && score - max_distance > n - j - 1) {
+                return max_distance + 1;
+            }
+        }
+        return score;
+    }
+
+    std::size_t m_length;
+    std::size_t m_blocks;
+    // Match bit vectors, m_blocks words per byte value
+    std::vector<std::uint64_t> m_peq;
+};
+
+/// \brief Levenshtein distance between two strings in bytes
+///
+/// \param[in] a            string_view First string
+/// \param[in] b            string_view Second string
+/// \param[in] max_distance size_t      Upper bound of interest
+///
+/// \return size_t Distance, or max_distance + 1 if it's larger than max_distance
+static inline std::size_t levenshtein(string_view a, string_view b,
+                                      std::size_t max_distance = FuzzyMatcher::npos) {
+    // Shorter string as the pattern needs fewer blocks
+    if (a.size() > b.size()) {
+        std::swap(a, b);
+    }
+    if (a.empty() || a.size() > 64) {
+        return FuzzyMatcher(a).distance(b, max_distance);
+    }
+    if (b.size() - a.size() > max_distance) {
+        return max_distance + 1;
+    }
+    // Single word patterns keep the match vectors on the stack
+    std::uint64_t peq[256] = {0};
+    for (std::size_t i = 0; i < a.size(); i++) {
+        peq[static_cast<unsigned char>(a[i])] |= std::uint64_t(1) << i;
+    }
+    return detail::myers_distance(peq, a.size(), b, max_distance);
+}
+
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_FUZZY_HPP_
@@ -0,0 +1,262 @@
+// hash.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_HASH_HPP_
+#define STRING_HASH_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "random.hpp"
+#include "string_view.hpp"
+
+namespace drodil {
+namespace general {
+namespace string {
+
+namespace detail {
+
+/// Mixing constants of the hash
+static const std::uint64_t hash_secret[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull,
+                                             0x4d5a2da51de1aa47ull};
+
+/// \brief Multiply and fold 128-bit product
+static inline std::uint64_t hash_mix(std::uint64_t a, std::uint64_t b) noexcept {
+    std::uint64_t lo;
+    std::uint64_t hi = mul128(a, b, lo);
+    return lo ^ hi;
+}
+
+/// \brief Read 64-bit little endian value
+static inline std::uint64_t read_le64(const unsigned char* p) noexcept {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+/// \brief Read 32-bit little endian value
+static inline std::uint64_t read_le32(const unsigned char* p) noexcept {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+/// \brief Initial state for seed
+static inline std::uint64_t hash_init(std::uint64_t seed) noexcept {
+    return seed ^ hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+}
+
+/// \brief Process one 48 byte stripe in three independent lanes
+static inline void hash_stripe(const unsigned char* p, std::uint64_t& seed, std::uint64_t& see1,
+                               std::uint64_t& see2) noexcept {
+    seed = hash_mix(read_le64(p) ^ hash_secret[1], read_le64(p + 8) ^ seed);
+    see1 = hash_mix(read_le64(p + 16) ^ hash_secret[2], read_le64(p + 24) ^ see1);
+    see2 = hash_mix(read_le64(p + 32) ^ hash_secret[3], read_le64(p + 40) ^ see2);
+}
+
+/// \brief Hash the last at most 48 bytes and finalize
+///
+/// For inputs over 16 bytes the 16 bytes before p must be readable.
+static inline std::uint64_t hash_tail(const unsigned char* p, std::size_t remaining, std::uint64_t seed,
+                                      std::uint64_t total) noexcept {
+    std::uint64_t a, b;
+    if (total <= 16) {
+        if (total >= 4) {
+            std::size_t shift = (total >> 3) << 2;
+            a = (read_le32(p) << 32) | read_le32(p + shift);
+            b = (read_le32(p + total - 4) << 32) | read_le32(p + total - 4 - shift);
+        } else if (total > 0) {
+            a = (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[total >> 1]) << 8) |
+                p[total - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        while (remaining > 16) {
+            seed = hash_mix(read_le64(p) ^ hash_secret[1], read_le64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        a = read_le64(p + remaining - 16);
+        b = read_le64(p + remaining - 8);
+    }
+    a ^= hash_secret[1];
+    b ^= seed;
+    std::uint64_t lo;
+    std::uint64_t hi = mul128(a, b, lo);
+    return hash_mix(lo ^ hash_secret[0] ^ total, hi ^ hash_secret[1]);
+}
+
+} // namespace detail
+
+/// \brief Fast non-cryptographic 64-bit hash (wyhash family)
+///
+/// Output is identical on all platforms and builds for the same input and
+/// seed. Inputs longer than 48 bytes are consumed in stripes of three
+/// independent multiply lanes so the CPU can overlap the multiplications.
+///
+/// \param[in] data Bytes to hash
+/// \param[in] len  size_t Number of bytes
+/// \param[in] seed std::uint64_t Seed
+///
+/// \return std::uint64_t
+static inline std::uint64_t hash64(const void* data, std::size_t len, std::uint64_t seed = 0) noexcept {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::uint64_t state = detail::hash_init(seed);
+    std::size_t remaining = len;
+    if (len > 48) {
+        std::uint64_t see1 = state, see2 = state;
+        do {
+            detail::hash_stripe(p, state, see1, see2);
+            p += 48;
+            remaining -= 48;
+        } while (remaining > 48);
+        state ^= see1 ^ see2;
+    }
+    return detail::hash_tail(p, remaining, state, len);
+}
+
+/// \brief Hash string view
+///
+/// \param[in] str  string_view String to hash
+/// \param[in] seed std::uint64_t Seed
+///
+/// \return std::uint64_t
+static inline std::uint64_t hash64(string_view str, std::uint64_t seed = 0) noexcept {
+    return hash64(str.data(), str.size(), seed);
+}
+
+/// \brief Incremental version of hash64
+///
+/// Feeding the same bytes in any number of update() calls gives the same
+/// digest as hash64() over the concatenation.
+class Hasher {
+public:
+    /// \brief Construct hasher
+    ///
+    /// \param[in] seed std::uint64_t Seed
+    explicit Hasher(std::uint64_t seed = 0) noexcept
+        : m_seed(detail::hash_init(seed)), m_see1(m_seed), m_see2(m_seed), m_total(0), m_pending(0) {}
+
+    /// \brief Add bytes to the hash
+    ///
+    /// \param[in] data Bytes to add
+    /// \param[in] len  size_t Number of bytes
+    ///
+    /// \return Hasher
+    Hasher& update(const void* data, std::size_t len) noexcept {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        m_total += len;
+        while (len > 0) {
+            if (m_pending == 48) {
+                // More input follows, so the buffered stripe can be consumed
+                const unsigned char* stripe = m_buffer + history;
+                detail::hash_stripe(stripe, m_seed, m_see1, m_see2);
+                std::memcpy(m_buffer, stripe + 48 - history, history);
+                m_pending = 0;
+            }
+            if (m_pending == 0 && len > 48) {
+                // Consume stripes straight from the input
+                do {
+                    detail::hash_stripe(p, m_seed, m_see1, m_see2);
+                    p += 48;
+                    len -= 48;
+                } while (len > 48);
+                std::memcpy(m_buffer, p - history, history);
+            }
+            std::size_t take = std::min<std::size_t>(len, 48 - m_pending);
+            std::memcpy(m_buffer + history + m_pending, p, take);
+            m_pending += take;
+            p += take;
+            len -= take;
+        }
+        return *this;
+    }
+
+    /// \brief Add string to the hash
+    ///
+    /// \param[in] str string_view String to add
+    ///
+    /// \return Hasher
+    Hasher& update(string_view str) noexcept { return update(str.data(), str.size()); }
+
+    /// \brief Hash of everything added so far
+    ///
+    /// \return std::uint64_t
+    std::uint64_t digest() const noexcept {
+        std::uint64_t seed = m_seed;
+        if (m_total > 48) {
+            seed ^= m_see1 ^ m_see2;
+        }
+        return detail::hash_tail(m_buffer + history, m_pending, seed, m_total);
+    }
+
+private:
+    // The tail may read back into the 16 bytes before the pending ones
+    static const std::size_t history = 16;
+
+    std::uint64_t m_seed;
+    std::uint64_t m_see1;
+    std::uint64_t m_see2;
+    std::uint64_t m_total;
+    std::size_t m_pending;
+    unsigned char m_buffer[history + 48];
+};
+
+/// \brief Hash functor for std::unordered_map and friends
+///
+/// Accepts std::string, string_view and C strings with the same result, so
+/// e.g. std::unordered_map<string_view, T, StringHash> can be queried without
+/// building std::string keys. Marked transparent for heterogeneous lookup
+/// where the standard library supports it.
+struct StringHash {
+    typedef void is_transparent;
+
+    std::size_t operator()(string_view str) const noexcept { return static_cast<std::size_t>(hash64(str)); }
+    std::size_t operator()(const std::string& str) const noexcept { return (*this)(string_view(str)); }
+    std::size_t operator()(const char* str) const noexcept { return (*this)(string_view(str)); }
+};
+
+/// \brief Equality functor matching StringHash
+struct StringEqual {
+    typedef void is_transparent;
+
+    bool operator()(string_view a, string_view b) const noexcept { return a == b; }
+};
+
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_HASH_HPP_
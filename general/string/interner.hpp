@@ -0,0 +1,313 @@
+// interner.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_INTERNER_HPP_
+#define STRING_INTERNER_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "hash.hpp"
+#include "string_view.hpp"
+
+namespace drodil {
+namespace general {
+namespace string {
+
+/// \brief Handle to a string stored in StringInterner
+///
+/// Two symbols from the same interner are equal only if the strings are equal.
+struct Symbol {
+    std::uint32_t id;
+
+    friend bool operator==(Symbol a, Symbol b) noexcept { return a.id == b.id; }
+    friend bool operator!=(Symbol a, Symbol b) noexcept { return a.id != b.id; }
+    friend bool operator<(Symbol a, Symbol b) noexcept { return a.id < b.id; }
+};
+
+/// \brief Thread safe string interner
+///
+/// Stores every unique string once in arena blocks and hands out small
+/// Symbol handles and views that stay valid for the lifetime of the interner.
+/// The table is split into independently locked shards so concurrent inserts
+/// and lookups of different strings rarely contend.
+class StringInterner {
+public:
+    /// \brief Construct empty interner
+    StringInterner() : m_shards(new Shard[shard_count]) {}
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    /// \brief Intern string, inserting it if it's not yet known
+    ///
+    /// \param[in] str string_view String to intern
+    ///
+    /// \return Symbol
+    /// \throws std::length_error if the interner is full
+    Symbol intern(string_view str) {
+        std::uint64_t h = hash64(str);
+        Shard& shard = m_shards[h & (shard_count - 1)];
+        std::uint32_t tag = static_cast<std::uint32_t>(h >> 32);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::uint32_t index;
+        if (shard.find(str, tag, index)) {
+            return make_symbol(h, index);
+        }
+        return make_symbol(h, shard.insert(str, tag));
+    }
+
+    /// \brief Intern string and return the stored view
+    ///
+    /// Views of equal strings have the same data pointer.
+    ///
+    /// \param[in] str string_view String to intern
+    ///
+    /// \return string_view
+    string_view intern_view(string_view str) { return view(intern(str)); }
+
+    /// \brief Look up string without inserting it
+    ///
+    /// \param[in]  str    string_view String to look up
+    /// \param[out] symbol Symbol      Set to the symbol of the string if found
+    ///
+    /// \return bool True if the string has been interned
+    bool find(string_view str, Symbol& symbol) const {
+        std::uint64_t h = hash64(str);
+        Shard& shard = m_shards[h & (shard_count - 1)];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::uint32_t index;
+        if (!shard.find(str, static_cast<std::uint32_t>(h >> 32), index)) {
+            return false;
+        }
+        symbol = make_symbol(h, index);
+        return true;
+    }
+
+    /// \brief Return interned string for symbol
+    ///
+    /// Lock free; the symbol must come from this interner.
+    ///
+    /// \param[in] symbol Symbol Symbol to resolve
+    ///
+    /// \return string_view
+    string_view view(Symbol symbol) const noexcept {
+        const Shard& shard = m_shards[symbol.id & (shard_count - 1)];
+        return shard.entry(symbol.id >> shard_bits).str;
+    }
+
+    /// \brief Number of unique strings
+    ///
+    /// \return size_t
+    std::size_t size() const {
+        std::size_t ret = 0;
+        for (std::size_t i = 0; i < shard_count; i++) {
+            std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+            ret += m_shards[i].count;
+        }
+        return ret;
+    }
+
+    /// \brief Bytes allocated for string storage and tables
+    ///
+    /// \return size_t
+    std::size_t memory_usage() const {
+        std::size_t ret = 0;
+        for (std::size_t i = 0; i < shard_count; i++) {
+            std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+            ret += m_shards[i].memory_usage();
+        }
+        return ret;
+    }
+
+private:
+    static const std::uint32_t shard_bits = 6;
+    static const std::uint32_t shard_count = 1u << shard_bits;
+    static const std::uint32_t max_index = 1u << (32 - shard_bits);
+    // Entry pages double in size, the first one holds 2^first_page_bits entries
+    static const std::uint32_t first_page_bits = 8;
+    static const std::uint32_t max_pages = 32 - shard_bits - first_page_bits + 1;
+    static const std::size_t block_size = 16 * 1024;
+
+    /// Stored string with its hash tag to avoid comparing unrelated strings
+    struct Entry {
+        string_view str;
+        std::uint32_t tag;
+    };
+
+    /// One independently locked part of the interner
+    struct Shard {
+        Shard() : count(0), arena(nullptr), arena_pos(0), arena_end(0) {}
+
+        /// Look up string, expects mutex to be held
+        bool find(string_view str, std::uint32_t tag, std::uint32_t& index) const noexcept {
+            if (slots.empty()) {
+                return false;
+            }
+            std::size_t mask = slots.size() - 1;
+            for (std::size_t i = tag & mask;; i = (i + 1) & mask) {
+                std::uint32_t slot = slots[i];
+                if (slot == 0) {
+                    return false;
+                }
+                const Entry& e = entry(slot - 1);
+                if (e.tag == tag && e.str == str) {
+                    index = slot - 1;
+                    return true;
+                }
+            }
+        }
+
+        /// Insert string that is not yet in the shard, expects mutex to be held
+        std::uint32_t insert(string_view str, std::uint32_t tag) {
+            if (count == max_index - 1) {
+                throw std::length_error("StringInterner is full");
+            }
+            if ((count + 1) * 2 > slots.size()) {
+                grow();
+            }
+
+            std::uint32_t index = count;
+            std::uint32_t page, offset;
+            locate(index, page, offset);
+            if (offset == 0) {
+                pages[page].reset(new Entry[std::size_t(1) << (page + first_page_bits)]);
+            }
+            Entry& e = pages[page][offset];
+            e.str = string_view(store(str), str.size());
+            e.tag = tag;
+            ++count;
+
+            place(index, tag);
+            return index;
+        }
+
+        /// Map entry index to page and offset within the page
+        static void locate(std::uint32_t index, std::uint32_t& page, std::uint32_t& offset) noexcept {
+            std::uint32_t j = index + (1u << first_page_bits);
+            std::uint32_t bit = 31;
+            while ((j >> bit) == 0) {
+                --bit;
+            }
+            page = bit - first_page_bits;
+            offset = j - (1u << bit);
+        }
+
+        const Entry& entry(std::uint32_t index) const noexcept {
+            std::uint32_t page, offset;
+            locate(index, page, offset);
+            return pages[page][offset];
+        }
+
+        std::size_t memory_usage() const noexcept {
+            std::size_t ret = slots.size() * sizeof(std::uint32_t);
+            for (std::uint32_t i = 0; i < max_pages && pages[i]; i++) {
+                ret += (std::size_t(1) << (i + first_page_bits)) * sizeof(Entry);
+            }
+            for (const auto& block : blocks) {
+                ret += block.second;
+            }
+            return ret;
+        }
+
+        /// Copy string to the arena, keeps a terminating NUL for C APIs
+        const char* store(string_view str) {
+            std::size_t needed = str.size() + 1;
+            char* dst;
+            if (needed > block_size / 4) {
+                // Dedicated block for large strings, keep filling the current one
+                blocks.emplace_back(std::unique_ptr<char[]>(new char[needed]), needed);
+                dst = blocks.back().first.get();
+            } else {
+                if (arena_end - arena_pos < needed) {
+                    std::size_t size = block_size;
+                    blocks.emplace_back(std::unique_ptr<char[]>(new char[size]), size);
+                    arena = blocks.back().first.get();
+                    arena_pos = 0;
+                    arena_end = size;
+                }
+                dst = arena + arena_pos;
+                arena_pos += needed;
+            }
+            if (!str.empty()) {
+                std::memcpy(dst, str.data(), str.size());
+            }
+            dst[str.size()] = '\0';
+            return dst;
+        }
+
+        /// Put index into the slot table
+        void place(std::uint32_t index, std::uint32_t tag) noexcept {
+            std::size_t mask = slots.size() - 1;
+            std::size_t i = tag & mask;
+            while (slots[i] != 0) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = index + 1;
+        }
+
+        /// Double the slot table and rehash
+        void grow() {
+            std::vector<std::uint32_t> old;
+            old.swap(slots);
+            slots.assign(old.empty() ? 16 : old.size() * 2, 0);
+            for (std::uint32_t slot : old) {
+                if (slot != 0) {
+                    place(slot - 1, entry(slot - 1).tag);
+                }
+            }
+        }
+
+        mutable std::mutex mutex;
+        std::uint32_t count;
+        char* arena;
+        std::size_t arena_pos;
+        std::size_t arena_end;
+        // Slot table with entry index + 1, zero marks empty slot
+        std::vector<std::uint32_t> slots;
+        // Entry pages never move so view() can read them without locking
+        std::unique_ptr<Entry[]> pages[max_pages];
+        std::vector<std::pair<std::unique_ptr<char[]>, std::size_t>> blocks;
+    };
+
+    static Symbol make_symbol(std::uint64_t h, std::uint32_t index) noexcept {
+        Symbol s;
+        s.id = (index << shard_bits) | static_cast<std::uint32_t>(h & (shard_count - 1));
+        return s;
+    }
+
+    std::unique_ptr<Shard[]> m_shards;
+};
+
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_INTERNER_HPP_
@@ -0,0 +1,323 @@
+// multi_matcher.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_MULTI_MATCHER_HPP_
+#define STRING_MULTI_MATCHER_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "string_view.hpp"
+
+namespace drodil {
+namespace general {
+namespace string {
+
+/// \brief Pattern occurrence found by MultiMatcher
+struct Match {
+    /// Start position in the searched text
+    std::size_t position;
+    /// Length of the matched pattern
+    std::size_t length;
+    /// Index of the matched pattern
+    std::size_t pattern;
+};
+
+/// \brief Compiled Aho-Corasick matcher for searching many patterns at once
+///
+/// The automaton is a dense DFA: bytes are first mapped to equivalence
+/// classes (bytes that don't occur in any pattern share one class) and every
+/// state has one row of next states indexed by class, so each input byte
+/// costs two table lookups regardless of the number of patterns.
+class MultiMatcher {
+public:
+    /// \brief Compile matcher for given patterns
+    ///
+    /// \param[in] patterns std::vector<std::string> Patterns to search for
+    ///
+    /// \throws std::invalid_argument if a pattern is empty
+    explicit MultiMatcher(const std::vector<std::string>& patterns) : m_classes(1), m_max_length(0) {
+        build(patterns);
+    }
+
+    /// \brief Number of compiled patterns
+    ///
+    /// \return size_t
+    std::size_t size() const noexcept { return m_lengths.size(); }
+
+    /// \brief Call fn with every, possibly overlapping, match in text
+    ///
+    /// Matches are reported in order of their end position; for the same end
+    /// position longer matches come first.
+    ///
+    /// \param[in] text string_view Text to search
+    /// \param[in] fn   Callable    Called as fn(const Match&), returning false stops the scan
+    ///
+    /// \return void
+    template <typename Fn> void scan(string_view text, Fn fn) const {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+        std::uint32_t state = 0;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            state = m_delta[state * m_classes + m_class[p[i]]];
+            for (std::uint32_t out = m_output[state]; out != 0; out = m_output_next[out]) {
+                std::uint32_t pattern = m_pattern[out];
+                Match match = {i + 1 - m_lengths[pattern], m_lengths[pattern], pattern};
+                if (!fn(match)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    /// \brief Find all, possibly overlapping, matches in text
+    ///
+    /// \param[in] text string_view Text to search
+    ///
+    /// \return std::vector<Match>
+    std::vector<Match> find_all(string_view text) const {
+        std::vector<Match> ret;
+        scan(text, [&ret](const Match& match) {
+            ret.push_back(match);
+            return true;
+        });
+        return ret;
+    }
+
+    /// \brief Find the match that ends first in text
+    ///
+    /// \param[in]  text  string_view Text to search
+    /// \param[out] match Match       Set to the found match
+    ///
+    /// \return bool True if any pattern was found
+    bool find_first(string_view text, Match& match) const {
+        bool found = false;
+        scan(text, [&](const Match& m) {
+            match = m;
+            found = true;
+            return false;
+        });
+        return found;
+    }
+
+    /// \brief Call fn with leftmost-longest non-overlapping matches
+    ///
+    /// Selection runs in the same single pass as the automaton and keeps only
+    /// a window of the longest pattern length in memory.
+    ///
+    /// \param[in] text string_view Text to search
+    /// \param[in] fn   Callable    Called as fn(const Match&) in text order
+    ///
+    /// \return void
+    template <typename Fn> void for_each_non_overlapping(string_view text, Fn fn) const {
+        if (m_max_length == 0) {
+            return;
+        }
+        // Longest pattern index + 1 starting at each position in the window
+        std::size_t window = 1;
+        while (window <= m_max_length) {
+            window <<= 1;
+        }
+        std::vector<std::uint32_t> best(window, 0);
+        const std::size_t mask = window - 1;
+        std::size_t next = 0;
+
+        auto decide = [&](std::size_t until) {
+            while (next < until) {
+                std::uint32_t pattern = best[next & mask];
+                if (pattern == 0) {
+                    ++next;
+                    continue;
+                }
+                Match match = {next, m_lengths[pattern - 1], pattern - 1};
+                for (std::size_t i = 0; i < match.length; i++) {
+                    best[(next + i) & mask] = 0;
+                }
+                next += match.length;
+                fn(match);
+            }
+        };
+
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+        std::uint32_t state = 0;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            // Every match starting before i + 1 - max_length is known by now
+            if (i + 1 > m_max_length) {
+                decide(i + 1 - m_max_length);
+            }
+            state = m_delta[state * m_classes + m_class[p[i]]];
+            for (std::uint32_t out = m_output[state]; out != 0; out = m_output_next[out]) {
+                std::uint32_t pattern = m_pattern[out];
+                std::size_t start = i + 1 - m_lengths[pattern];
+                if (start < next) {
+                    continue;
+                }
+                std::uint32_t& slot = best[start & mask];
+                if (slot == 0 || m_lengths[slot - 1] < m_lengths[pattern]) {
+                    slot = pattern + 1;
+                }
+            }
+        }
+        decide(text.size());
+    }
+
+    /// \brief Replace leftmost-longest matches with replacement of the pattern
+    ///
+    /// Matches are found in a single scan and the output is allocated once
+    /// with its exact final size.
+    ///
+    /// \param[in] text         string_view              Text to replace in
+    /// \param[in] replacements std::vector<std::string> Replacement for each pattern
+    ///
+    /// \return std::string
+    /// \throws std::invalid_argument if there isn't a replacement for each pattern
+    std::string replace_all(string_view text, const std::vector<std::string>& replacements) const {
+        if (replacements.size() != m_lengths.size()) {
+            throw std::invalid_argument("Replacement count does not match pattern count");
+        }
+
+        std::vector<Match> matches;
+        std::size_t size = text.size();
+        for_each_non_overlapping(text, [&](const Match& match) {
+            matches.push_back(match);
+            size = size - match.length + replacements[match.pattern].size();
+        });
+
+        std::string ret(size, '\0');
+        char* out = &ret[0];
+        std::size_t pos = 0;
+        for (const Match& match : matches) {
+            std::memcpy(out, text.data() + pos, match.position - pos);
+            out += match.position - pos;
+            const std::string& replacement = replacements[match.pattern];
+            std::memcpy(out, replacement.data(), replacement.size());
+            out += replacement.size();
+            pos = match.position + match.length;
+        }
+        std::memcpy(out, text.data() + pos, text.size() - pos);
+        return ret;
+    }
+
+private:
+    /// \brief Build byte classes, trie and the DFA
+    void build(const std::vector<std::string>& patterns) {
+        std::memset(m_class, 0, sizeof(m_class));
+        for (const auto& pattern : patterns) {
+            if (pattern.empty()) {
+                throw std::invalid_argument("Empty pattern");
+            }
+            for (unsigned char c : pattern) {
+                if (m_class[c] == 0) {
+                    m_class[c] = static_cast<std::uint16_t>(m_classes++);
+                }
+            }
+        }
+
+        // Trie with missing transitions marked as no_state
+        const std::uint32_t no_state = ~static_cast<std::uint32_t>(0);
+        m_delta.assign(m_classes, no_state);
+        m_pattern.assign(1, 0);
+        std::vector<bool> terminal(1, false);
+        for (std::size_t i = 0; i < patterns.size(); i++) {
+            std::uint32_t state = 0;
+            for (unsigned char c : patterns[i]) {
+                std::size_t idx = state * m_classes + m_class[c];
+                if (m_delta[idx] == no_state) {
+                    m_delta[idx] = static_cast<std::uint32_t>(m_pattern.size());
+                    m_pattern.push_back(0);
+                    terminal.push_back(false);
+                    m_delta.resize(m_delta.size() + m_classes, no_state);
+                }
+                state = m_delta[idx];
+            }
+            // Duplicate patterns report the first index
+            if (!terminal[state]) {
+                terminal[state] = true;
+                m_pattern[state] = static_cast<std::uint32_t>(i);
+            }
+            m_lengths.push_back(patterns[i].size());
+            if (patterns[i].size() > m_max_length) {
+                m_max_length = patterns[i].size();
+            }
+        }
+
+        // Breadth first over the trie: resolve failure links into full DFA
+        // rows and link each state to the nearest terminal on its fail chain
+        const std::size_t states = m_pattern.size();
+        std::vector<std::uint32_t> fail(states, 0);
+        m_output.assign(states, 0);
+        m_output_next.assign(states, 0);
+        std::vector<std::uint32_t> queue;
+        queue.reserve(states);
+        for (std::uint32_t c = 0; c < m_classes; c++) {
+            std::uint32_t& next = m_delta[c];
+            if (next == no_state) {
+                next = 0;
+            } else {
+                queue.push_back(next);
+            }
+        }
+        for (std::size_t head = 0; head < queue.size(); head++) {
+            std::uint32_t state = queue[head];
+            std::uint32_t suffix = m_output[fail[state]];
+            if (terminal[state]) {
+                m_output[state] = state;
+                m_output_next[state] = suffix;
+            } else {
+                m_output[state] = suffix;
+            }
+            for (std::uint32_t c = 0; c < m_classes; c++) {
+                std::uint32_t& next = m_delta[state * m_classes + c];
+                std::uint32_t fallback = m_delta[fail[state] * m_classes + c];
+                if (next == no_state) {
+                    next = fallback;
+                } else {
+                    fail[next] = fallback;
+                    queue.push_back(next);
+                }
+            }
+        }
+    }
+
+    std::uint16_t m_class[256];
+    std::uint32_t m_classes;
+    std::size_t m_max_length;
+    // Next state for each state and byte class
+    std::vector<std::uint32_t> m_delta;
+    // Pattern index of terminal states
+    std::vector<std::uint32_t> m_pattern;
+    // First terminal state reachable through the fail chain, 0 if none
+    std::vector<std::uint32_t> m_output;
+    // Next terminal state in the fail chain of a terminal state
+    std::vector<std::uint32_t> m_output_next;
+    std::vector<std::size_t> m_lengths;
+};
+
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_MULTI_MATCHER_HPP_
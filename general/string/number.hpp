@@ -0,0 +1,586 @@
+// number.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_NUMBER_HPP_
+#define STRING_NUMBER_HPP_
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+
+namespace drodil {
+namespace general {
+namespace string {
+
+/// \brief Result of from_chars, ec is std::errc() on success
+struct from_chars_result {
+    const char* ptr;
+    std::errc ec;
+};
+
+/// \brief Result of to_chars, ec is std::errc() on success
+struct to_chars_result {
+    char* ptr;
+    std::errc ec;
+};
+
+namespace detail {
+
+/// Two digit lookup table for base 10 formatting
+static const char digit_pairs[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
+
+/// Digits for bases up to 36
+static const char digit_chars[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+/// Exactly representable powers of ten
+static const double exact_powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                             1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                             1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/// Significant digits kept for the correctly rounded slow path. Decimal
+/// expansions of doubles never need more than 767 digits to round correctly.
+static const std::size_t max_float_digits = 768;
+
+/// \brief Value of digit character or 255 if not a digit in any base
+static inline unsigned digit_value(char c) noexcept {
+    if (c >= '0' && c <= '9') {
+        return static_cast<unsigned>(c - '0');
+    }
+    c = static_cast<char>(c | 0x20);
+    if (c >= 'a' && c <= 'z') {
+        return static_cast<unsigned>(c - 'a' + 10);
+    }
+    return 255;
+}
+
+/// \brief Case insensitive prefix match against lower case literal
+static inline bool match_literal(const char* first, const char* last, const char* literal) noexcept {
+    for (; *literal; ++literal, ++first) {
+        if (first == last || (*first | 0x20) != *literal) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// \brief Number of base 10 digits in value
+template <typename U> static inline unsigned count_digits(U value) noexcept {
+    unsigned n = 1;
+    for (;;) {
+        if (value < 10) {
+            return n;
+        }
+        if (value < 100) {
+            return n + 1;
+        }
+        if (value < 1000) {
+            return n + 2;
+        }
+        if (value < 10000) {
+            return n + 3;
+        }
+        value /= 10000u;
+        n += 4;
+    }
+}
+
+/// \brief Format unsigned value in base 10, caller ensures space
+template <typename U> static inline char* write_decimal(char* first, U value, unsigned digits) noexcept {
+    char* p = first + digits;
+    while (value >= 100) {
+        unsigned idx = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[idx + 1];
+        *--p = digit_pairs[idx];
+    }
+    if (value >= 10) {
+        unsigned idx = static_cast<unsigned>(value) * 2;
+        *--p = digit_pairs[idx + 1];
+        *--p = digit_pairs[idx];
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    return first + digits;
+}
+
+/// \brief Format decimal digits d1.d2d3... * 10^exp
+///
+/// Uses fixed notation for exponents -4..16 and otherwise scientific
+/// notation with a signed exponent of at least two digits, e.g. 1.5e+20.
+///
+/// \return char* End of the written characters
+static inline char* write_float(char* out, bool negative, const char* digits, int count, int exp) noexcept {
+    if (negative) {
+        *out++ = '-';
+    }
+    if (exp >= 0 && exp < 17) {
+        int int_digits = exp + 1;
+        for (int i = 0; i < int_digits; i++) {
+            *out++ = i < count ? digits[i] : '0';
+        }
+        if (count > int_digits) {
+            *out++ = '.';
+            std::memcpy(out, digits + int_digits, count - int_digits);
+            out += count - int_digits;
+        }
+        return out;
+    }
+    if (exp < 0 && exp >= -4) {
+        *out++ = '0';
+        *out++ = '.';
+        for (int i = -1; i > exp; i--) {
+            *out++ = '0';
+        }
+        std::memcpy(out, digits, count);
+        return out + count;
+    }
+    *out++ = digits[0];
+    if (count > 1) {
+        *out++ = '.';
+        std::memcpy(out, digits + 1, count - 1);
+        out += count - 1;
+    }
+    *out++ = 'e';
+    *out++ = exp < 0 ? '-' : '+';
+    unsigned uexp = static_cast<unsigned>(exp < 0 ? -exp : exp);
+    if (uexp < 10) {
+        *out++ = '0';
+    }
+    return write_decimal(out, uexp, count_digits(uexp));
+}
+
+/// \brief Sign check that doesn't warn for unsigned types
+template <typename T> static inline bool is_negative(T value, std::true_type) noexcept { return value < 0; }
+template <typename T> static inline bool is_negative(T, std::false_type) noexcept { return false; }
+
+} // namespace detail
+
+/// \brief Parse integer from character range
+///
+/// Accepts an optional '-' for signed types followed by digits in the given
+/// base. No whitespace or '+' is skipped, like std::from_chars.
+///
+/// \param[in]  first Start of the range
+/// \param[in]  last  End of the range
+/// \param[out] value Parsed value, untouched on error
+/// \param[in]  base  int Base between 2 and 36
+///
+/// \return from_chars_result ptr points past the parsed characters, ec is
+///         std::errc::invalid_argument if there were no digits or the base
+///         is out of range and std::errc::result_out_of_range if the value
+///         doesn't fit T
+template <typename T>
+static inline typename std::enable_if<std::is_integral<T>::value, from_chars_result>::type
+from_chars(const char* first, const char* last, T& value, int base = 10) noexcept {
+    typedef typename std::make_unsigned<T>::type U;
+    from_chars_result ret = {first, std::errc::invalid_argument};
+    if (base < 2 || base > 36) {
+        return ret;
+    }
+
+    const char* p = first;
+    bool negative = false;
+    if (std::is_signed<T>::value && p != last && *p == '-') {
+        negative = true;
+        ++p;
+    }
+
+    U limit = negative ? static_cast<U>(static_cast<U>(std::numeric_limits<T>::max()) + 1)
+                       : static_cast<U>(std::numeric_limits<T>::max());
+    U ubase = static_cast<U>(base);
+    U acc = 0;
+    bool overflow = false;
+    const char* digits_start = p;
+    for (; p != last; ++p) {
+        unsigned d = detail::digit_value(*p);
+        if (d >= static_cast<unsigned>(base)) {
+            break;
+        }
+        if (acc > (limit - d) / ubase) {
+            overflow = true;
+        } else {
+            acc = static_cast<U>(acc * ubase + d);
+        }
+    }
+
+    if (p == digits_start) {
+        return ret;
+    }
+    ret.ptr = p;
+    if (overflow) {
+        ret.ec = std::errc::result_out_of_range;
+        return ret;
+    }
+    value = negative ? static_cast<T>(0 - acc) : static_cast<T>(acc);
+    ret.ec = std::errc();
+    return ret;
+}
+
+/// \brief Parse double from character range
+///
+/// Accepts [-]digits[.digits][(e|E)[+|-]digits], "inf", "infinity" and "nan"
+/// independent of the current locale. The result is correctly rounded: short
+/// inputs are converted exactly with double arithmetic, longer ones are
+/// normalized on the stack and handed to strtod.
+///
+/// \param[in]  first Start of the range
+/// \param[in]  last  End of the range
+/// \param[out] value Parsed value, untouched on error
+///
+/// \return from_chars_result ptr points past the parsed characters, ec is
+///         std::errc::invalid_argument if no number was found and
+///         std::errc::result_out_of_range on overflow or underflow to zero
+static inline from_chars_result from_chars(const char* first, const char* last, double& value) noexcept {
+    from_chars_result ret = {first, std::errc::invalid_argument};
+
+    const char* p = first;
+    bool negative = false;
+    if (p != last && *p == '-') {
+        negative = true;
+        ++p;
+    }
+
+    if (p != last && (*p | 0x20) == 'i') {
+        if (!detail::match_literal(p, last, "inf")) {
+            return ret;
+        }
+        p += detail::match_literal(p, last, "infinity") ? 8 : 3;
+        value = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        ret.ptr = p;
+        ret.ec = std::errc();
+        return ret;
+    }
+    if (p != last && (*p | 0x20) == 'n') {
+        if (!detail::match_literal(p, last, "nan")) {
+            return ret;
+        }
+        value = negative ? -std::numeric_limits<double>::quiet_NaN() : std::numeric_limits<double>::quiet_NaN();
+        ret.ptr = p + 3;
+        ret.ec = std::errc();
+        return ret;
+    }
+
+    // Significant digits without leading zeros, decimal point position
+    // is folded into the exponent
+    char digits[detail::max_float_digits + 1];
+    std::size_t digit_count = 0;
+    bool truncated = false;
+    bool any_digit = false;
+    std::uint64_t mantissa = 0;
+    long exponent = 0;
+
+    for (; p != last && *p >= '0' && *p <= '9'; ++p) {
+        any_digit = true;
+        if (digit_count == 0 && *p == '0') {
+            continue;
+        }
+        if (digit_count < detail::max_float_digits) {
+            digits[digit_count++] = *p;
+        } else {
+            truncated |= *p != '0';
+            ++exponent;
+        }
+    }
+    if (p != last && *p == '.') {
+        ++p;
+        for (; p != last && *p >= '0' && *p <= '9'; ++p) {
+            any_digit = true;
+            if (digit_count == 0 && *p == '0') {
+                --exponent;
+                continue;
+            }
+            if (digit_count < detail::max_float_digits) {
+                digits[digit_count++] = *p;
+                --exponent;
+            } else {
+                truncated |= *p != '0';
+            }
+        }
+    }
+    if (!any_digit) {
+        return ret;
+    }
+
+    if (p != last && (*p | 0x20) == 'e') {
+        const char* e = p + 1;
+        bool exp_negative = false;
+        if (e != last && (*e == '-' || *e == '+')) {
+            exp_negative = *e == '-';
+            ++e;
+        }
+        if (e != last && *e >= '0' && *e <= '9') {
+            long exp = 0;
+            for (; e != last && *e >= '0' && *e <= '9'; ++e) {
+                // Saturate, anything this large is out of range anyway
+                if (exp < 100000) {
+                    exp = exp * 10 + (*e - '0');
+                }
+            }
+            exponent += exp_negative ? -exp : exp;
+            p = e;
+        }
+    }
+    ret.ptr = p;
+
+    if (digit_count == 0) {
+        value = negative ? -0.0 : 0.0;
+        ret.ec = std::errc();
+        return ret;
+    }
+
+    // Drop trailing zeros so more inputs qualify for the fast path
+    while (digit_count > 1 && digits[digit_count - 1] == '0' && !truncated) {
+        --digit_count;
+        ++exponent;
+    }
+
+    // Clinger's fast path: mantissa and power of ten are both exact doubles
+    if (!truncated && digit_count <= 19) {
+        for (std::size_t i = 0; i < digit_count; i++) {
+            mantissa = mantissa * 10 + static_cast<unsigned>(digits[i] - '0');
+        }
+        if (mantissa <= (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22 + 15) {
+            double d = static_cast<double>(mantissa);
+            bool exact = true;
+            if (exponent < 0) {
+                d /= detail::exact_powers_of_ten[-exponent];
+            } else if (exponent <= 22) {
+                d *= detail::exact_powers_of_ten[exponent];
+            } else {
+                // Shift part of the exponent into the mantissa if it stays exact
+                d *= detail::exact_powers_of_ten[exponent - 22];
+                exact = d <= 9007199254740992.0;
+                d *= detail::exact_powers_of_ten[22];
+            }
+            if (exact) {
+                value = negative ? -d : d;
+                ret.ec = std::errc();
+                return ret;
+            }
+        }
+    }
+
+    // Slow path: normalized "<sign><digits>e<exp>" has no decimal point and
+    // thus can't be misread by a non-C locale
+    char buffer[detail::max_float_digits + 32];
+    char* b = buffer;
+    if (negative) {
+        *b++ = '-';
+    }
+    std::memcpy(b, digits, digit_count);
+    b += digit_count;
+    if (truncated) {
+        // Sticky digit keeps halfway cases rounding in the right direction
+        *b++ = '1';
+        --exponent;
+    }
+    *b++ = 'e';
+    if (exponent < 0) {
+        *b++ = '-';
+        exponent = -exponent;
+    }
+    unsigned long uexp = static_cast<unsigned long>(exponent);
+    b = detail::write_decimal(b, uexp, detail::count_digits(uexp));
+    *b = '\0';
+
+    int saved_errno = errno;
+    errno = 0;
+    double d = std::strtod(buffer, nullptr);
+    bool range_error = errno == ERANGE && (d == 0.0 || std::isinf(d));
+    errno = saved_errno;
+    if (range_error) {
+        ret.ec = std::errc::result_out_of_range;
+        return ret;
+    }
+    value = d;
+    ret.ec = std::errc();
+    return ret;
+}
+
+/// \brief Format integer into character range
+///
+/// \param[in] first Start of the output range
+/// \param[in] last  End of the output range
+/// \param[in] value Value to format
+/// \param[in] base  int Base between 2 and 36
+///
+/// \return to_chars_result ptr points past the written characters, ec is
+///         std::errc::value_too_large if the range is too small and
+///         std::errc::invalid_argument if the base is out of range
+template <typename T>
+static inline typename std::enable_if<std::is_integral<T>::value, to_chars_result>::type
+to_chars(char* first, char* last, T value, int base = 10) noexcept {
+    typedef typename std::make_unsigned<T>::type U;
+    to_chars_result ret = {last, std::errc::value_too_large};
+    if (base < 2 || base > 36) {
+        ret.ec = std::errc::invalid_argument;
+        return ret;
+    }
+
+    U uvalue = static_cast<U>(value);
+    if (detail::is_negative(value, std::is_signed<T>())) {
+        if (first == last) {
+            return ret;
+        }
+        *first++ = '-';
+        uvalue = static_cast<U>(0 - uvalue);
+    }
+
+    if (base == 10) {
+        unsigned digits = detail::count_digits(uvalue);
+        if (static_cast<std::size_t>(last - first) < digits) {
+            return ret;
+        }
+        ret.ptr = detail::write_decimal(first, uvalue, digits);
+        ret.ec = std::errc();
+        return ret;
+    }
+
+    U ubase = static_cast<U>(base);
+    unsigned digits = 1;
+    for (U v = uvalue; v >= ubase; v /= ubase) {
+        ++digits;
+    }
+    if (static_cast<std::size_t>(last - first) < digits) {
+        return ret;
+    }
+    char* p = first + digits;
+    do {
+        *--p = detail::digit_chars[uvalue % ubase];
+        uvalue /= ubase;
+    } while (uvalue != 0);
+    ret.ptr = first + digits;
+    ret.ec = std::errc();
+    return ret;
+}
+
+/// \brief Format double into character range
+///
+/// Writes the shortest representation with at most 17 significant digits
+/// that parses back to exactly the same value, always using '.' as decimal
+/// point. Integral values below 2^53 are written as integers, e.g. 1e15 as
+/// 1000000000000000. Other values use fixed notation for decimal exponents
+/// -4..16 and scientific notation like 1.5e+20 otherwise.
+///
+/// \param[in] first Start of the output range
+/// \param[in] last  End of the output range
+/// \param[in] value Value to format
+///
+/// \return to_chars_result ptr points past the written characters, ec is
+///         std::errc::value_too_large if the range is too small
+static inline to_chars_result to_chars(char* first, char* last, double value) noexcept {
+    to_chars_result ret = {last, std::errc::value_too_large};
+
+    if (std::isnan(value) || std::isinf(value)) {
+        const char* str = std::isnan(value) ? (std::signbit(value) ? "-nan" : "nan")
+                                            : (value < 0 ? "-inf" : "inf");
+        std::size_t len = std::strlen(str);
+        if (static_cast<std::size_t>(last - first) < len) {
+            return ret;
+        }
+        std::memcpy(first, str, len);
+        ret.ptr = first + len;
+        ret.ec = std::errc();
+        return ret;
+    }
+
+    if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0 && !(value == 0 && std::signbit(value))) {
+        return to_chars(first, last, static_cast<std::int64_t>(value));
+    }
+
+    // All 17 significant digits once, the locale only affects the point
+    char sci[40];
+    std::snprintf(sci, sizeof(sci), "%.16e", std::fabs(value));
+    char digits[17];
+    const char* p = sci;
+    int count = 0;
+    for (; *p != 'e'; ++p) {
+        if (*p >= '0' && *p <= '9') {
+            digits[count++] = *p;
+        }
+    }
+    int exp = std::atoi(p + 1);
+
+    // Shortest rounding of those digits that parses back to the same value
+    char buffer[32];
+    int len = 0;
+    // Any normal double with a shorter form already gets it from rounding to
+    // 15 digits and dropping zeros, subnormals have less precision than that
+    int min_precision = std::fabs(value) < std::numeric_limits<double>::min() ? 1 : 15;
+    for (int precision = min_precision; precision <= 17; precision++) {
+        char rounded[17];
+        int rounded_exp = exp;
+        std::memcpy(rounded, digits, precision);
+        if (precision < 17 && digits[precision] >= '5') {
+            int i = precision - 1;
+            while (i >= 0 && rounded[i] == '9') {
+                rounded[i--] = '0';
+            }
+            if (i >= 0) {
+                ++rounded[i];
+            } else {
+                rounded[0] = '1';
+                ++rounded_exp;
+            }
+        }
+        int rounded_count = precision;
+        while (rounded_count > 1 && rounded[rounded_count - 1] == '0') {
+            --rounded_count;
+        }
+        len = static_cast<int>(detail::write_float(buffer, std::signbit(value), rounded, rounded_count, rounded_exp) - buffer);
+        double parsed;
+        if (precision == 17 || (from_chars(buffer, buffer + len, parsed).ec == std::errc() && parsed == value)) {
+            break;
+        }
+    }
+
+    if (last - first < len) {
+        return ret;
+    }
+    std::memcpy(first, buffer, len);
+    ret.ptr = first + len;
+    ret.ec = std::errc();
+    return ret;
+}
+
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_NUMBER_HPP_
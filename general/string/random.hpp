@@ -0,0 +1,282 @@
+// random.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_RANDOM_HPP_
+#define STRING_RANDOM_HPP_
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace drodil {
+namespace general {
+namespace string {
+
+namespace detail {
+
+/// Alphabet used by the random string generators
+static const char random_alphabet[] = "0123456789"
+                                      "abcdefghijklmnopqrstuvwxyz"
+                                      "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/// Number of characters in the random string alphabet
+static const std::uint64_t random_alphabet_size = sizeof(random_alphabet) - 1;
+
+/// Characters extracted from a single 64-bit draw. Every extraction consumes
+/// log2(62) bits of the fraction, eight keeps the bias below 1e-5.
+static const std::size_t random_chars_per_draw = 8;
+
+/// \brief Full 64x64 -> 128 bit multiplication
+///
+/// \param[in]  a  First factor
+/// \param[in]  b  Second factor
+/// \param[out] lo Lower 64 bits of the product
+///
+/// \return std::uint64_t Upper 64 bits of the product
+static inline std::uint64_t mul128(std::uint64_t a, std::uint64_t b, std::uint64_t& lo) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 r = static_cast<uint128>(a) * b;
+    lo = static_cast<std::uint64_t>(r);
+    return static_cast<std::uint64_t>(r >> 64);
+#else
+    std::uint64_t a_lo = a & 0xffffffffu, a_hi = a >> 32;
+    std::uint64_t b_lo = b & 0xffffffffu, b_hi = b >> 32;
+    std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    std::uint64_t mid = (ll >> 32) + (lh & 0xffffffffu) + (hl & 0xffffffffu);
+    lo = (mid << 32) | (ll & 0xffffffffu);
+    return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+/// \brief Seed from the non-deterministic std::random_device
+///
+/// \return std::uint64_t
+static inline std::uint64_t random_seed() {
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+}
+
+} // namespace detail
+
+/// \brief Fast non-cryptographic 64-bit generator (wyrand)
+///
+/// Satisfies UniformRandomBitGenerator so it can also be used with the
+/// distributions from <random>. Not suitable for secrets, see SecureRandom.
+class FastRandom {
+public:
+    typedef std::uint64_t result_type;
+
+    /// \brief Construct generator seeded from std::random_device
+    FastRandom() : m_state(detail::random_seed()) {}
+
+    /// \brief Construct generator with fixed seed for reproducible sequences
+    ///
+    /// \param[in] seed std::uint64_t Initial state
+    explicit FastRandom(std::uint64_t seed) noexcept : m_state(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~static_cast<result_type>(0); }
+
+    /// \brief Draw next 64-bit value
+    ///
+    /// \return std::uint64_t
+    result_type operator()() noexcept {
+        m_state += 0xa0761d6478bd642full;
+        std::uint64_t lo;
+        std::uint64_t hi = detail::mul128(m_state, m_state ^ 0xe7037ed1a0b428dbull, lo);
+        return hi ^ lo;
+    }
+
+private:
+    std::uint64_t m_state;
+};
+
+/// \brief Cryptographically secure generator backed by the kernel CSPRNG
+///
+/// Uses getrandom() on Linux and /dev/urandom elsewhere. Bytes are fetched
+/// in blocks to amortize the system call cost.
+class SecureRandom {
+public:
+    typedef std::uint64_t result_type;
+
+    SecureRandom() : m_pos(sizeof(m_buffer)) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~static_cast<result_type>(0); }
+
+    /// \brief Draw next secure byte
+    ///
+    /// \return unsigned char
+    /// \throws std::runtime_error if the system entropy source fails
+    unsigned char next_byte() {
+        if (m_pos == sizeof(m_buffer)) {
+            refill();
+        }
+        return m_buffer[m_pos++];
+    }
+
+    /// \brief Draw next secure 64-bit value
+    ///
+    /// \return std::uint64_t
+    /// \throws std::runtime_error if the system entropy source fails
+    result_type operator()() {
+        result_type ret = 0;
+        for (int i = 0; i < 8; i++) {
+            ret = (ret << 8) | next_byte();
+        }
+        return ret;
+    }
+
+private:
+    /// \brief Fill the byte buffer from the system entropy source
+    ///
+    /// \throws std::runtime_error on failure
+    void refill() {
+        std::size_t filled = 0;
+#if defined(__linux__) && defined(SYS_getrandom)
+        while (filled < sizeof(m_buffer)) {
+            long r = syscall(SYS_getrandom, m_buffer + filled, sizeof(m_buffer) - filled, 0);
+            if (r < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            filled += static_cast<std::size_t>(r);
+        }
+#endif
+        if (filled < sizeof(m_buffer)) {
+            std::FILE* f = std::fopen("/dev/urandom", "rb");
+            if (f != nullptr) {
+                filled += std::fread(m_buffer + filled, 1, sizeof(m_buffer) - filled, f);
+                std::fclose(f);
+            }
+        }
+        if (filled < sizeof(m_buffer)) {
+            throw std::runtime_error("Could not read from system entropy source");
+        }
+        m_pos = 0;
+    }
+
+    unsigned char m_buffer[256];
+    std::size_t m_pos;
+};
+
+/// \brief Fill buffer with random alphanumeric characters
+///
+/// Extracts eight characters from every 64-bit draw by multiplying the draw
+/// as a fixed point fraction with the alphabet size, so no draws are rejected.
+///
+/// \param[out]    out    Buffer to write at least length characters to
+/// \param[in]     length size_t Number of characters to write
+/// \param[in|out] rng    FastRandom Generator to draw from
+///
+/// \return void
+static inline void fill_random(char* out, std::size_t length, FastRandom& rng) noexcept {
+    while (length > 0) {
+        std::uint64_t frac = rng();
+        std::size_t n = length < detail::random_chars_per_draw ? length : detail::random_chars_per_draw;
+        for (std::size_t i = 0; i < n; i++) {
+            std::uint64_t idx = detail::mul128(frac, detail::random_alphabet_size, frac);
+            out[i] = detail::random_alphabet[idx];
+        }
+        out += n;
+        length -= n;
+    }
+}
+
+/// \brief Fill buffer with secure random alphanumeric characters
+///
+/// Uses rejection sampling on single bytes so every character is unbiased.
+///
+/// \param[out]    out    Buffer to write at least length characters to
+/// \param[in]     length size_t Number of characters to write
+/// \param[in|out] rng    SecureRandom Generator to draw from
+///
+/// \return void
+/// \throws std::runtime_error if the system entropy source fails
+static inline void fill_random(char* out, std::size_t length, SecureRandom& rng) {
+    // Largest multiple of the alphabet size that fits into a byte
+    static const unsigned limit = 256 - (256 % detail::random_alphabet_size);
+    while (length > 0) {
+        unsigned char b = rng.next_byte();
+        if (b >= limit) {
+            continue;
+        }
+        *out++ = detail::random_alphabet[b % detail::random_alphabet_size];
+        --length;
+    }
+}
+
+/// \brief Generate many random strings into one contiguous buffer
+///
+/// String i starts at offset i * length of the returned buffer.
+///
+/// \param[in] count  size_t Number of strings to generate
+/// \param[in] length size_t Size of every string
+///
+/// \return std::string
+/// \throws std::length_error if the total size does not fit into a string
+static inline std::string random_strings(std::size_t count, std::size_t length) {
+    thread_local static FastRandom rng;
+    if (length != 0 && count > std::string().max_size() / length) {
+        throw std::length_error("Random strings do not fit into a string");
+    }
+    std::string ret(count * length, '\0');
+    if (!ret.empty()) {
+        fill_random(&ret[0], ret.size(), rng);
+    }
+    return ret;
+}
+
+/// \brief Generate cryptographically secure random string, e.g. for tokens
+///
+/// \param[in] length size_t Size of the generated string
+///
+/// \return std::string
+/// \throws std::runtime_error if the system entropy source fails
+static inline std::string secure_random_string(std::size_t length) {
+    thread_local static SecureRandom rng;
+    std::string ret(length, '\0');
+    if (length > 0) {
+        fill_random(&ret[0], length, rng);
+    }
+    return ret;
+}
+
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_RANDOM_HPP_
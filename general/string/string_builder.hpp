@@ -0,0 +1,395 @@
+// string_builder.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_STRING_BUILDER_HPP_
+#define STRING_STRING_BUILDER_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "number.hpp"
+#include "string_view.hpp"
+
+namespace drodil {
+namespace general {
+namespace string {
+
+/// \brief Chunked builder for large strings
+///
+/// Appends go into a list of fixed size blocks, so growing the output never
+/// reallocates or copies already written data. The content is consumed chunk
+/// by chunk, e.g. with a single writev() call, without being concatenated.
+class StringBuilder {
+public:
+    /// Default size of a single block
+    static const std::size_t default_block_size = 64 * 1024;
+
+    /// \brief Construct empty builder
+    ///
+    /// \param[in] block_size size_t Size of the blocks to allocate
+    explicit StringBuilder(std::size_t block_size = default_block_size)
+            : m_block_size(block_size > 0 ? block_size : 1), m_size(0) {}
+
+    StringBuilder(StringBuilder&&) = default;
+    StringBuilder& operator=(StringBuilder&&) = default;
+    StringBuilder(const StringBuilder&) = delete;
+    StringBuilder& operator=(const StringBuilder&) = delete;
+
+    /// \brief Get number of characters in the builder
+    ///
+    /// \return size_t
+    std::size_t size() const noexcept { return m_size; }
+
+    /// \brief Check if the builder is empty
+    ///
+    /// \return bool
+    bool empty() const noexcept { return m_size == 0; }
+
+    /// \brief Get number of allocated blocks
+    ///
+    /// \return size_t
+    std::size_t chunk_count() const noexcept { return m_blocks.size(); }
+
+    /// \brief Get number of bytes allocated for blocks
+    ///
+    /// \return size_t
+    std::size_t capacity() const noexcept {
+        std::size_t ret = 0;
+        for (const Block& block : m_blocks) {
+            ret += block.capacity;
+        }
+        return ret;
+    }
+
+    /// \brief Make sure appending up to the given total size needs no further allocations
+    ///
+    /// \param[in] size size_t Total size to reserve for
+    ///
+    /// \return void
+    void reserve(std::size_t size) {
+        if (size <= m_size) {
+            return;
+        }
+        std::size_t needed = size - m_size;
+        if (m_blocks.empty() || m_blocks.back().free() < needed) {
+            add_block(needed);
+        }
+    }
+
+    /// \brief Append characters
+    ///
+    /// \param[in] data   Characters to append
+    /// \param[in] length size_t Number of characters
+    ///
+    /// \return StringBuilder& This builder
+    StringBuilder& append(const char* data, std::size_t length) {
+        while (length > 0) {
+            if (m_blocks.empty() || m_blocks.back().free() == 0) {
+                add_block(length);
+            }
+            Block& block = m_blocks.back();
+            std::size_t n = std::min(length, block.free());
+            std::memcpy(block.data.get() + block.size, data, n);
+            block.size += n;
+            m_size += n;
+            data += n;
+            length -= n;
+        }
+        return *this;
+    }
+
+    /// \brief Append string
+    ///
+    /// \param[in] str string_view String to append
+    ///
+    /// \return StringBuilder& This builder
+    StringBuilder& append(string_view str) { return append(str.data(), str.size()); }
+
+    /// \brief Append character repeatedly
+    ///
+    /// \param[in] count size_t Number of characters
+    /// \param[in] c     char Character to append
+    ///
+    /// \return StringBuilder& This builder
+    StringBuilder& append(std::size_t count, char c) {
+        while (count > 0) {
+            if (m_blocks.empty() || m_blocks.back().free() == 0) {
+                add_block(count);
+            }
+            Block& block = m_blocks.back();
+            std::size_t n = std::min(count, block.free());
+            std::memset(block.data.get() + block.size, c, n);
+            block.size += n;
+            m_size += n;
+            count -= n;
+        }
+        return *this;
+    }
+
+    /// \brief Append single character
+    ///
+    /// \param[in] c char Character to append
+    ///
+    /// \return void
+    void push_back(char c) {
+        *tail(1) = c;
+        commit(1);
+    }
+
+    StringBuilder& operator<<(string_view str) { return append(str.data(), str.size()); }
+    StringBuilder& operator<<(const std::string& str) { return append(str.data(), str.size()); }
+    StringBuilder& operator<<(const char* str) { return append(str, std::strlen(str)); }
+
+    StringBuilder& operator<<(char c) {
+        push_back(c);
+        return *this;
+    }
+
+    /// \brief Append integer formatted in base 10 directly into the block
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value, StringBuilder&>::type operator<<(T value) {
+        char* out = tail(number_space);
+        commit(static_cast<std::size_t>(to_chars(out, out + number_space, value).ptr - out));
+        return *this;
+    }
+
+    /// \brief Append shortest round-trip representation of double
+    StringBuilder& operator<<(double value) {
+        char* out = tail(number_space);
+        commit(static_cast<std::size_t>(to_chars(out, out + number_space, value).ptr - out));
+        return *this;
+    }
+
+    /// \brief Insert string at given position
+    ///
+    /// Small inserts are done in place when the block has free space left,
+    /// otherwise the block is split and only its tail is copied.
+    ///
+    /// \param[in] pos size_t Position to insert at
+    /// \param[in] str string_view String to insert
+    ///
+    /// \return StringBuilder& This builder
+    /// \throws std::out_of_range if pos is larger than size()
+    StringBuilder& insert(std::size_t pos, string_view str) {
+        if (pos > m_size) {
+            throw std::out_of_range("Insert position is out of range");
+        }
+        if (pos == m_size) {
+            return append(str);
+        }
+        if (str.empty()) {
+            return *this;
+        }
+        std::size_t index = 0;
+        while (pos >= m_blocks[index].size) {
+            pos -= m_blocks[index].size;
+            ++index;
+        }
+        Block* block = &m_blocks[index];
+        char* at = block->data.get() + pos;
+        std::size_t tail_length = block->size - pos;
+        if (block->free() >= str.size()) {
+            std::memmove(at + str.size(), at, tail_length);
+            std::memcpy(at, str.data(), str.size());
+            block->size += str.size();
+            m_size += str.size();
+            return *this;
+        }
+        if (pos > 0) {
+            // Split the tail of the block into its own block
+            Block tail_block(tail_length);
+            std::memcpy(tail_block.data.get(), at, tail_length);
+            tail_block.size = tail_length;
+            block->size = pos;
+            m_blocks.insert(m_blocks.begin() + static_cast<std::ptrdiff_t>(index) + 1, std::move(tail_block));
+            block = &m_blocks[index];
+            if (block->free() >= str.size()) {
+                std::memcpy(block->data.get() + block->size, str.data(), str.size());
+                block->size += str.size();
+                m_size += str.size();
+                return *this;
+            }
+            ++index;
+        }
+        Block inserted(str.size());
+        std::memcpy(inserted.data.get(), str.data(), str.size());
+        inserted.size = str.size();
+        m_blocks.insert(m_blocks.begin() + static_cast<std::ptrdiff_t>(index), std::move(inserted));
+        m_size += str.size();
+        return *this;
+    }
+
+    /// \brief Call function for every non-empty chunk in order
+    ///
+    /// \param[in] fn Function taking string_view
+    ///
+    /// \return void
+    template <typename Fn> void for_each_chunk(Fn fn) const {
+        for (const Block& block : m_blocks) {
+            if (block.size > 0) {
+                fn(string_view(block.data.get(), block.size));
+            }
+        }
+    }
+
+    /// \brief Write content to output stream
+    ///
+    /// \param[in] os std::ostream Stream to write to
+    ///
+    /// \return std::ostream& The given stream
+    std::ostream& write_to(std::ostream& os) const {
+        for (const Block& block : m_blocks) {
+            os.write(block.data.get(), static_cast<std::streamsize>(block.size));
+        }
+        return os;
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    /// \brief Write content to file descriptor with as few writev() calls as possible
+    ///
+    /// \param[in] fd int File descriptor to write to
+    ///
+    /// \return void
+    /// \throws std::runtime_error if writing fails
+    void write_to(int fd) const {
+        static const int max_iov = 64;
+        std::size_t index = 0;
+        std::size_t offset = 0;
+        while (true) {
+            struct iovec iov[max_iov];
+            int count = 0;
+            for (std::size_t i = index; i < m_blocks.size() && count < max_iov; i++) {
+                std::size_t start = i == index ? offset : 0;
+                if (m_blocks[i].size > start) {
+                    iov[count].iov_base = m_blocks[i].data.get() + start;
+                    iov[count].iov_len = m_blocks[i].size - start;
+                    ++count;
+                }
+            }
+            if (count == 0) {
+                return;
+            }
+            ssize_t r = ::writev(fd, iov, count);
+            if (r < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("Could not write to file descriptor");
+            }
+            // Skip what was written, writes may be partial
+            std::size_t written = static_cast<std::size_t>(r);
+            while (written > 0 || (index < m_blocks.size() && m_blocks[index].size == offset)) {
+                std::size_t left = m_blocks[index].size - offset;
+                if (written < left) {
+                    offset += written;
+                    break;
+                }
+                written -= left;
+                ++index;
+                offset = 0;
+            }
+        }
+    }
+#endif
+
+    /// \brief Concatenate content into single string
+    ///
+    /// \return std::string
+    std::string to_string() const {
+        std::string ret;
+        ret.reserve(m_size);
+        for (const Block& block : m_blocks) {
+            ret.append(block.data.get(), block.size);
+        }
+        return ret;
+    }
+
+    /// \brief Remove all content, the first block is kept for reuse
+    ///
+    /// \return void
+    void clear() noexcept {
+        if (!m_blocks.empty()) {
+            m_blocks.erase(m_blocks.begin() + 1, m_blocks.end());
+            m_blocks.front().size = 0;
+        }
+        m_size = 0;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const StringBuilder& builder) { return builder.write_to(os); }
+
+private:
+    /// Space reserved for formatting a single number
+    static const std::size_t number_space = 32;
+
+    struct Block {
+        explicit Block(std::size_t cap) : data(new char[cap]), size(0), capacity(cap) {}
+
+        std::size_t free() const noexcept { return capacity - size; }
+
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+        std::size_t capacity;
+    };
+
+    /// \brief Add block to the end with room for at least given amount of characters
+    void add_block(std::size_t min_capacity) { m_blocks.emplace_back(std::max(m_block_size, min_capacity)); }
+
+    /// \brief Get contiguous space for length characters at the end
+    char* tail(std::size_t length) {
+        if (m_blocks.empty() || m_blocks.back().free() < length) {
+            add_block(length);
+        }
+        Block& block = m_blocks.back();
+        return block.data.get() + block.size;
+    }
+
+    /// \brief Mark length characters written with tail() as used
+    void commit(std::size_t length) noexcept {
+        m_blocks.back().size += length;
+        m_size += length;
+    }
+
+    std::vector<Block> m_blocks;
+    std::size_t m_block_size;
+    std::size_t m_size;
+};
+
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_STRING_BUILDER_HPP_
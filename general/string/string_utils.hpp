@@ -31,15 +31,192 @@
 #include <functional>
 #include <iterator>
 #include <locale>
-#include <random>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <vector>
 
+#include "random.hpp"
+#include "utf8.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace drodil {
 namespace general {
 namespace string {
 
+namespace detail {
+
+/// \brief Flip case of ASCII letters between lo and hi until first non-ASCII byte
+///
+/// Works on 32 (AVX2) or 16 (SSE2) byte blocks while they are pure ASCII.
+///
+/// \return size_t Number of bytes processed
+static inline std::size_t ascii_case_run(char* p, std::size_t n, char lo, char hi) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i vlo = _mm256_set1_epi8(static_cast<char>(lo - 1));
+    const __m256i vhi = _mm256_set1_epi8(static_cast<char>(hi + 1));
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        if (_mm256_movemask_epi8(v) != 0) {
+            break;
+        }
+        __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(v, vlo), _mm256_cmpgt_epi8(vhi, v));
+        v = _mm256_xor_si256(v, _mm256_and_si256(in_range, flip));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), v);
+    }
+#elif defined(__SSE2__)
+    const __m128i vlo = _mm_set1_epi8(static_cast<char>(lo - 1));
+    const __m128i vhi = _mm_set1_epi8(static_cast<char>(hi + 1));
+    const __m128i flip = _mm_set1_epi8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        if (_mm_movemask_epi8(v) != 0) {
+            break;
+        }
+        __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(v, vlo), _mm_cmplt_epi8(v, vhi));
+        v = _mm_xor_si128(v, _mm_and_si128(in_range, flip));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), v);
+    }
+#endif
+    for (; i < n; i++) {
+        char c = p[i];
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            break;
+        }
+        if (c >= lo && c <= hi) {
+            p[i] = static_cast<char>(c ^ 0x20);
+        }
+    }
+    return i;
+}
+
+/// \brief Number of leading bytes that are ASCII and equal ignoring case
+///
+/// \return size_t Stops at the first non-ASCII byte or mismatch
+static inline std::size_t ascii_iequal_run(const char* a, const char* b, std::size_t n) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i vlo = _mm256_set1_epi8('A' - 1);
+    const __m256i vhi = _mm256_set1_epi8('Z' + 1);
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        if (_mm256_movemask_epi8(_mm256_or_si256(va, vb)) != 0) {
+            break;
+        }
+        va = _mm256_or_si256(va, _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi8(va, vlo), _mm256_cmpgt_epi8(vhi, va)), flip));
+        vb = _mm256_or_si256(vb, _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi8(vb, vlo), _mm256_cmpgt_epi8(vhi, vb)), flip));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)) != -1) {
+            break;
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i vlo = _mm_set1_epi8('A' - 1);
+    const __m128i vhi = _mm_set1_epi8('Z' + 1);
+    const __m128i flip = _mm_set1_epi8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        if (_mm_movemask_epi8(_mm_or_si128(va, vb)) != 0) {
+            break;
+        }
+        va = _mm_or_si128(va, _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(va, vlo), _mm_cmplt_epi8(va, vhi)), flip));
+        vb = _mm_or_si128(vb, _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(vb, vlo), _mm_cmplt_epi8(vb, vhi)), flip));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF) {
+            break;
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        unsigned char ca = static_cast<unsigned char>(a[i]);
+        unsigned char cb = static_cast<unsigned char>(b[i]);
+        if ((ca | cb) >= 0x80) {
+            break;
+        }
+        if (ca != cb && utf8::to_lower(ca) != utf8::to_lower(cb)) {
+            break;
+        }
+    }
+    return i;
+}
+
+/// \brief Apply code point case mapping to string in place
+///
+/// ASCII runs take the vectorized path, other code points go through the
+/// UTF-8 mapping. Malformed bytes are left untouched.
+///
+/// \return void
+template <typename Map> static inline void convert_case(std::string& str, char lo, char hi, Map map) {
+    if (str.empty()) {
+        return;
+    }
+    char* p = &str[0];
+    std::size_t n = str.size();
+    std::size_t i = 0;
+    while (i < n) {
+        i += ascii_case_run(p + i, n - i, lo, hi);
+        if (i == n) {
+            break;
+        }
+        std::uint32_t cp;
+        std::size_t len = utf8::decode(p + i, n - i, cp);
+        if (cp != utf8::invalid_code_point) {
+            std::uint32_t mapped = map(cp);
+            if (mapped != cp) {
+                utf8::encode(mapped, p + i);
+            }
+        }
+        i += len;
+    }
+}
+
+/// \brief Case-insensitive comparison of a prefix of a with the whole b
+///
+/// \param[out] consumed Bytes of a matched
+///
+/// \return bool
+static inline bool iequal_prefix(const char* a, std::size_t an, const char* b, std::size_t bn,
+                                 std::size_t& consumed) noexcept {
+    std::size_t i = 0, j = 0;
+    while (j < bn) {
+        std::size_t common = an - i < bn - j ? an - i : bn - j;
+        std::size_t run = ascii_iequal_run(a + i, b + j, common);
+        i += run;
+        j += run;
+        if (j == bn) {
+            break;
+        }
+        if (i == an) {
+            return false;
+        }
+        std::uint32_t ca, cb;
+        std::size_t la = utf8::decode(a + i, an - i, ca);
+        std::size_t lb = utf8::decode(b + j, bn - j, cb);
+        if (ca == utf8::invalid_code_point || cb == utf8::invalid_code_point) {
+            // Malformed bytes only match themselves
+            if (la != lb || a[i] != b[j]) {
+                return false;
+            }
+        } else if (utf8::fold_case(ca) != utf8::fold_case(cb)) {
+            return false;
+        }
+        i += la;
+        j += lb;
+    }
+    consumed = i;
+    return true;
+}
+
+} // namespace detail
+
 /// \brief Splits string to vector based on given delimeter
 ///
 /// \param[in] str   std::string to split
@@ -70,24 +247,47 @@ static inline std::vector<std::string> split(const std::string& str, const std::
 
 /// \brief Trim string from the start
 ///
+/// Removes ASCII and UTF-8 encoded Unicode whitespace, e.g. NBSP and
+/// ideographic space. Independent of the C locale.
+///
 /// \param[in|out] trimmed std::string to trim
 ///
 /// \return std::string
 static inline std::string& l_trim(std::string& trimmed) {
-    std::ignore = trimmed.erase(
-        trimmed.begin(), std::find_if(trimmed.begin(), trimmed.end(), std::not1(std::ptr_fun<int, int>(std::isspace))));
+    const char* first = trimmed.data();
+    const char* last = first + trimmed.size();
+    const char* p = first;
+    while (p != last) {
+        std::uint32_t cp;
+        std::size_t len = utf8::decode(p, last - p, cp);
+        if (!utf8::is_whitespace(cp)) {
+            break;
+        }
+        p += len;
+    }
+    std::ignore = trimmed.erase(0, p - first);
     return trimmed;
 }
 
 /// \brief Trim string from the end
 ///
+/// Removes ASCII and UTF-8 encoded Unicode whitespace.
+///
 /// \param[in|out] trimmed std::string to trim
 ///
 /// \return std::string
 static inline std::string& r_trim(std::string& trimmed) {
-    std::ignore = trimmed.erase(
-        std::find_if(trimmed.rbegin(), trimmed.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(),
-        trimmed.end());
+    const char* first = trimmed.data();
+    const char* end = first + trimmed.size();
+    while (end != first) {
+        const char* p = utf8::previous(first, end);
+        std::uint32_t cp;
+        if (utf8::decode(p, end - p, cp) != static_cast<std::size_t>(end - p) || !utf8::is_whitespace(cp)) {
+            break;
+        }
+        end = p;
+    }
+    trimmed.resize(end - first);
     return trimmed;
 }
 
@@ -100,25 +300,127 @@ static inline std::string& trim(std::string& trimmed) { return l_trim(r_trim(tri
 
 /// \brief Generate random string
 ///
+/// Uses a thread local FastRandom, see random.hpp for the bulk and secure variants.
+///
 /// \param[in] length size_t Size of the generated string
 ///
 /// \return std::string
 static inline std::string random_string(std::size_t length) {
-    static auto& chrs = "0123456789"
-                        "abcdefghijklmnopqrstuvwxyz"
-                        "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    thread_local static FastRandom rg;
+    std::string ret(length, '\0');
+    if (length > 0) {
+        fill_random(&ret[0], length, rg);
+    }
+    return ret;
+}
+
+/// \brief Convert string to lower case in place
+///
+/// ASCII is converted 16 or 32 bytes at a time, UTF-8 sequences use the
+/// simple case mapping of utf8::to_lower. Independent of the C locale.
+///
+/// \param[in|out] str std::string String to convert
+///
+/// \return std::string
+static inline std::string& to_lower(std::string& str) {
+    detail::convert_case(str, 'A', 'Z', utf8::to_lower);
+    return str;
+}
+
+/// \brief Convert string to upper case in place
+///
+/// \param[in|out] str std::string String to convert
+///
+/// \return std::string
+static inline std::string& to_upper(std::string& str) {
+    detail::convert_case(str, 'a', 'z', utf8::to_upper);
+    return str;
+}
 
-    thread_local static std::mt19937 rg{std::random_device{}()};
-    thread_local static std::uniform_int_distribution<std::string::size_type> pick(0, sizeof(chrs) - 2);
-    std::string ret;
-    ret.reserve(length);
+/// \brief Return lower case copy of string
+///
+/// \param[in] str std::string String to convert
+///
+/// \return std::string
+static inline std::string to_lower_copy(std::string str) { return to_lower(str); }
 
-    while (length > 0) {
-        ret += chrs[pick(rg)];
-        --length;
+/// \brief Return upper case copy of string
+///
+/// \param[in] str std::string String to convert
+///
+/// \return std::string
+static inline std::string to_upper_copy(std::string str) { return to_upper(str); }
+
+/// \brief Case-insensitive equality
+///
+/// \param[in] a std::string First string
+/// \param[in] b std::string Second string
+///
+/// \return bool
+static inline bool iequals(const std::string& a, const std::string& b) noexcept {
+    std::size_t consumed = 0;
+    return detail::iequal_prefix(a.data(), a.size(), b.data(), b.size(), consumed) && consumed == a.size();
+}
+
+/// \brief Case-insensitive search
+///
+/// \param[in] haystack std::string String to search from
+/// \param[in] needle   std::string String to search for
+/// \param[in] pos      size_t      Position to start the search from
+///
+/// \return size_t Position of the first match or std::string::npos
+static inline std::size_t ifind(const std::string& haystack, const std::string& needle, std::size_t pos = 0) noexcept {
+    if (pos > haystack.size()) {
+        return std::string::npos;
+    }
+    if (needle.empty()) {
+        return pos;
     }
 
-    return ret;
+    const char* h = haystack.data();
+    const std::size_t n = haystack.size();
+    unsigned char first = static_cast<unsigned char>(needle[0]);
+    std::size_t consumed;
+    if (first < 0x80) {
+        // Only positions starting with either case of the first byte can match
+        const char lower = static_cast<char>(utf8::to_lower(first));
+        const char upper = static_cast<char>(utf8::to_upper(first));
+        std::size_t i = pos;
+#if defined(__SSE2__)
+        const __m128i vl = _mm_set1_epi8(lower);
+        const __m128i vu = _mm_set1_epi8(upper);
+        while (i + 16 <= n) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+            int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, vl), _mm_cmpeq_epi8(v, vu)));
+            while (mask != 0) {
+                std::size_t at = i + __builtin_ctz(mask);
+                if (detail::iequal_prefix(h + at, n - at, needle.data(), needle.size(), consumed)) {
+                    return at;
+                }
+                mask &= mask - 1;
+            }
+            i += 16;
+        }
+#endif
+        for (; i < n; i++) {
+            if ((h[i] == lower || h[i] == upper) &&
+                detail::iequal_prefix(h + i, n - i, needle.data(), needle.size(), consumed)) {
+                return i;
+            }
+        }
+        return std::string::npos;
+    }
+
+    // Non-ASCII first character may have other case with different lead byte
+    for (std::size_t i = pos; i < n; i++) {
+        if ((static_cast<unsigned char>(h[i]) & 0xC0) == 0x80) {
+            continue;
+        }
+        if (detail::iequal_prefix(h + i, n - i, needle.data(), needle.size(), consumed)) {
+            return i;
+        }
+    }
+    return std::string::npos;
 }
 
 /// \brief Implode elements to string with delimiter
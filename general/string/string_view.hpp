@@ -0,0 +1,161 @@
+// string_view.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_STRING_VIEW_HPP_
+#define STRING_STRING_VIEW_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace drodil {
+namespace general {
+namespace string {
+
+/// \brief Non-owning view to a character range
+///
+/// Minimal C++11 counterpart of std::string_view. The viewed characters
+/// must outlive the view.
+class string_view {
+public:
+    typedef const char* const_iterator;
+    typedef std::size_t size_type;
+
+    static const size_type npos = static_cast<size_type>(-1);
+
+    constexpr string_view() noexcept : m_data(nullptr), m_size(0) {}
+
+    constexpr string_view(const char* data, size_type size) noexcept : m_data(data), m_size(size) {}
+
+    string_view(const char* str) noexcept : m_data(str), m_size(str ? std::strlen(str) : 0) {}
+
+    string_view(const std::string& str) noexcept : m_data(str.data()), m_size(str.size()) {}
+
+    constexpr const char* data() const noexcept { return m_data; }
+    constexpr size_type size() const noexcept { return m_size; }
+    constexpr size_type length() const noexcept { return m_size; }
+    constexpr bool empty() const noexcept { return m_size == 0; }
+
+    constexpr const_iterator begin() const noexcept { return m_data; }
+    constexpr const_iterator end() const noexcept { return m_data + m_size; }
+
+    constexpr const char& operator[](size_type pos) const noexcept { return m_data[pos]; }
+    const char& front() const noexcept { return m_data[0]; }
+    const char& back() const noexcept { return m_data[m_size - 1]; }
+
+    /// \brief Drop n characters from the start
+    void remove_prefix(size_type n) noexcept {
+        m_data += n;
+        m_size -= n;
+    }
+
+    /// \brief Drop n characters from the end
+    void remove_suffix(size_type n) noexcept { m_size -= n; }
+
+    /// \brief View to a part of this view
+    ///
+    /// \param[in] pos   size_t Start position, clamped to size()
+    /// \param[in] count size_t Maximum number of characters
+    ///
+    /// \return string_view
+    string_view substr(size_type pos, size_type count = npos) const noexcept {
+        if (pos > m_size) {
+            pos = m_size;
+        }
+        return string_view(m_data + pos, std::min(count, m_size - pos));
+    }
+
+    /// \brief Find character starting from pos
+    ///
+    /// \return size_t Position or npos
+    size_type find(char c, size_type pos = 0) const noexcept {
+        if (pos >= m_size) {
+            return npos;
+        }
+        const void* p = std::memchr(m_data + pos, c, m_size - pos);
+        return p ? static_cast<const char*>(p) - m_data : npos;
+    }
+
+    /// \brief Find substring starting from pos
+    ///
+    /// \return size_t Position or npos
+    size_type find(string_view needle, size_type pos = 0) const noexcept {
+        if (needle.m_size == 0) {
+            return pos <= m_size ? pos : npos;
+        }
+        while (pos + needle.m_size <= m_size) {
+            const void* p = std::memchr(m_data + pos, needle.m_data[0], m_size - pos - needle.m_size + 1);
+            if (p == nullptr) {
+                return npos;
+            }
+            pos = static_cast<const char*>(p) - m_data;
+            if (std::memcmp(m_data + pos, needle.m_data, needle.m_size) == 0) {
+                return pos;
+            }
+            ++pos;
+        }
+        return npos;
+    }
+
+    /// \brief Lexicographical comparison
+    ///
+    /// \return int Negative, zero or positive like std::string::compare
+    int compare(string_view other) const noexcept {
+        size_type n = std::min(m_size, other.m_size);
+        int r = n ? std::memcmp(m_data, other.m_data, n) : 0;
+        if (r != 0) {
+            return r;
+        }
+        return m_size < other.m_size ? -1 : (m_size > other.m_size ? 1 : 0);
+    }
+
+    bool starts_with(string_view prefix) const noexcept {
+        return m_size >= prefix.m_size && std::memcmp(m_data, prefix.m_data, prefix.m_size) == 0;
+    }
+
+    /// \brief Copy viewed characters to std::string
+    std::string to_string() const { return std::string(m_data, m_size); }
+
+    explicit operator std::string() const { return to_string(); }
+
+    friend bool operator==(string_view a, string_view b) noexcept {
+        return a.m_size == b.m_size && (a.m_size == 0 || std::memcmp(a.m_data, b.m_data, a.m_size) == 0);
+    }
+    friend bool operator!=(string_view a, string_view b) noexcept { return !(a == b); }
+    friend bool operator<(string_view a, string_view b) noexcept { return a.compare(b) < 0; }
+
+    friend std::ostream& operator<<(std::ostream& os, string_view sv) { return os.write(sv.m_data, sv.m_size); }
+
+private:
+    const char* m_data;
+    size_type m_size;
+};
+
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_STRING_VIEW_HPP_
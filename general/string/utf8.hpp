@@ -0,0 +1,475 @@
+// utf8.hpp
+//
+// MIT License
+//
+// Copyright (c) 2017 Heikki Hellgren <heiccih@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STRING_UTF8_HPP_
+#define STRING_UTF8_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace drodil {
+namespace general {
+namespace string {
+namespace utf8 {
+
+/// Code point returned by decode() for malformed sequences
+static const std::uint32_t invalid_code_point = 0xFFFFFFFFu;
+
+/// \brief Decode one code point
+///
+/// Overlong forms, surrogates and values above U+10FFFF are rejected.
+///
+/// \param[in]  p  Start of the sequence
+/// \param[in]  n  size_t Bytes available, at least one
+/// \param[out] cp Decoded code point or invalid_code_point
+///
+/// \return size_t Bytes consumed, one for malformed sequences
+static inline std::size_t decode(const char* p, std::size_t n, std::uint32_t& cp) noexcept {
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(p);
+    unsigned char c = s[0];
+    cp = invalid_code_point;
+    if (c < 0x80) {
+        cp = c;
+        return 1;
+    }
+
+    std::size_t len;
+    std::uint32_t min;
+    if ((c & 0xE0) == 0xC0) {
+        len = 2;
+        min = 0x80;
+        cp = c & 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+        len = 3;
+        min = 0x800;
+        cp = c & 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+        len = 4;
+        min = 0x10000;
+        cp = c & 0x07;
+    } else {
+        return 1;
+    }
+    if (n < len) {
+        cp = invalid_code_point;
+        return 1;
+    }
+    for (std::size_t i = 1; i < len; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            cp = invalid_code_point;
+            return 1;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        cp = invalid_code_point;
+        return 1;
+    }
+    return len;
+}
+
+/// \brief Encode code point, caller ensures four bytes of space
+///
+/// \param[in]  cp  Code point to encode
+/// \param[out] out Output buffer
+///
+/// \return size_t Bytes written
+static inline std::size_t encode(std::uint32_t cp, char* out) noexcept {
+    if (cp < 0x80) {
+        out[0] = static_cast<char>(cp);
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (cp >> 18));
+    out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/// \brief Simple lower case mapping
+///
+/// Covers Basic Latin, Latin-1, Latin Extended-A, Greek, Cyrillic and
+/// fullwidth Latin. Only mappings that keep the encoded length are applied,
+/// so conversions can always be done in place. Other code points are
+/// returned unchanged.
+///
+/// \param[in] cp Code point
+///
+/// \return std::uint32_t
+static inline std::uint32_t to_lower(std::uint32_t cp) noexcept {
+    if (cp < 0x80) {
+        return (cp >= 'A' && cp <= 'Z') ? cp + 0x20 : cp;
+    }
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) {
+        return cp + 0x20;
+    }
+    if (cp >= 0x100 && cp <= 0x17F) {
+        if ((cp <= 0x137 && cp != 0x130) || (cp >= 0x14A && cp <= 0x177)) {
+            return cp | 1;
+        }
+        if ((cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E)) {
+            return (cp & 1) ? cp + 1 : cp;
+        }
+        return cp == 0x178 ? 0xFF : cp;
+    }
+    if (cp >= 0x386 && cp <= 0x3AB) {
+        if (cp >= 0x391 && cp != 0x3A2) {
+            return cp + 0x20;
+        }
+        switch (cp) {
+        case 0x386:
+            return 0x3AC;
+        case 0x388:
+        case 0x389:
+        case 0x38A:
+            return cp + 0x25;
+        case 0x38C:
+            return 0x3CC;
+        case 0x38E:
+        case 0x38F:
+            return cp + 0x3F;
+        default:
+            return cp;
+        }
+    }
+    if (cp >= 0x400 && cp <= 0x42F) {
+        return cp < 0x410 ? cp + 0x50 : cp + 0x20;
+    }
+    if (cp >= 0xFF21 && cp <= 0xFF3A) {
+        return cp + 0x20;
+    }
+    return cp;
+}
+
+/// \brief Simple upper case mapping, counterpart of to_lower()
+///
+/// \param[in] cp Code point
+///
+/// \return std::uint32_t
+static inline std::uint32_t to_upper(std::uint32_t cp) noexcept {
+    if (cp < 0x80) {
+        return (cp >= 'a' && cp <= 'z') ? cp - 0x20 : cp;
+    }
+    if (cp >= 0xE0 && cp <= 0xFE && cp != 0xF7) {
+        return cp - 0x20;
+    }
+    if (cp == 0xFF) {
+        return 0x178;
+    }
+    if (cp >= 0x100 && cp <= 0x17F) {
+        if ((cp <= 0x137 && cp != 0x131) || (cp >= 0x14A && cp <= 0x177)) {
+            return cp & ~1u;
+        }
+        if ((cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E)) {
+            return (cp & 1) ? cp : cp - 1;
+        }
+        return cp;
+    }
+    if (cp == 0x3C2) {
+        return 0x3A3;
+    }
+    if (cp >= 0x3B1 && cp <= 0x3CB) {
+        return cp - 0x20;
+    }
+    switch (cp) {
+    case 0x3AC:
+        return 0x386;
+    case 0x3AD:
+    case 0x3AE:
+    case 0x3AF:
+        return cp - 0x25;
+    case 0x3CC:
+        return 0x38C;
+    case 0x3CD:
+    case 0x3CE:
+        return cp - 0x3F;
+    default:
+        break;
+    }
+    if (cp >= 0x430 && cp <= 0x45F) {
+        return cp < 0x450 ? cp - 0x20 : cp - 0x50;
+    }
+    if (cp >= 0xFF41 && cp <= 0xFF5A) {
+        return cp - 0x20;
+    }
+    return cp;
+}
+
+/// \brief Case fold for case-insensitive comparison
+///
+/// \param[in] cp Code point
+///
+/// \return std::uint32_t
+static inline std::uint32_t fold_case(std::uint32_t cp) noexcept { return to_lower(to_upper(cp)); }
+
+/// \brief Check for Unicode White_Space property
+///
+/// \param[in] cp Code point
+///
+/// \return bool
+static inline bool is_whitespace(std::uint32_t cp) noexcept {
+    if (cp < 0x80) {
+        return cp == ' ' || (cp >= '\t' && cp <= '\r');
+    }
+    switch (cp) {
+    case 0x85:
+    case 0xA0:
+    case 0x1680:
+    case 0x2028:
+    case 0x2029:
+    case 0x202F:
+    case 0x205F:
+    case 0x3000:
+        return true;
+    default:
+        return cp >= 0x2000 && cp <= 0x200A;
+    }
+}
+
+/// \brief Start of the code point that ends at end
+///
+/// \param[in] first Start of the string
+/// \param[in] end   End of the code point, greater than first
+///
+/// \return const char*
+static inline const char* previous(const char* first, const char* end) noexcept {
+    const char* p = end - 1;
+    for (int i = 0; i < 3 && p > first && (static_cast<unsigned char>(*p) & 0xC0) == 0x80; i++) {
+        --p;
+    }
+    return p;
+}
+
+/// \brief Number of leading bytes that are ASCII
+///
+/// Scans 32 (AVX2), 16 (SSE2) or 8 bytes at a time.
+///
+/// \param[in] p Start of the range
+/// \param[in] n size_t Length of the range
+///
+/// \return size_t
+static inline std::size_t ascii_prefix(const char* p, std::size_t n) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= n; i += 32) {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i))) != 0) {
+            break;
+        }
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))) != 0) {
+            break;
+        }
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if ((word & 0x8080808080808080ull) != 0) {
+            break;
+        }
+    }
+    while (i < n && static_cast<unsigned char>(p[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+/// \brief Length of the longest valid UTF-8 prefix
+///
+/// ASCII blocks are skipped with ascii_prefix(), multi-byte sequences are
+/// checked with the strict decode().
+///
+/// \param[in] p Start of the range
+/// \param[in] n size_t Length of the range
+///
+/// \return size_t n if the whole range is valid, otherwise offset of the first invalid byte
+static inline std::size_t valid_prefix(const char* p, std::size_t n) noexcept {
+    std::size_t i = 0;
+    while (i < n) {
+        i += ascii_prefix(p + i, n - i);
+        // Sequences often come in runs, stay in the scalar loop while they do
+        while (i < n && static_cast<unsigned char>(p[i]) >= 0x80) {
+            std::uint32_t cp;
+            std::size_t len = decode(p + i, n - i, cp);
+            if (cp == invalid_code_point) {
+                return i;
+            }
+            i += len;
+        }
+    }
+    return n;
+}
+
+/// \brief Check that range is valid UTF-8
+///
+/// \param[in] p Start of the range
+/// \param[in] n size_t Length of the range
+///
+/// \return bool
+static inline bool is_valid(const char* p, std::size_t n) noexcept { return valid_prefix(p, n) == n; }
+
+/// \brief Range of code points with the same display width
+struct WidthRange {
+    std::uint32_t first;
+    std::uint32_t last;
+};
+
+namespace detail {
+
+/// Combining marks and format characters that take no columns
+static const WidthRange zero_width_ranges[] = {
+    {0x300, 0x36F}, {0x483, 0x489}, {0x591, 0x5BD}, {0x5BF, 0x5BF}, {0x5C1, 0x5C2}, {0x5C4, 0x5C5},
+    {0x5C7, 0x5C7}, {0x610, 0x61A}, {0x64B, 0x65F}, {0x670, 0x670}, {0x6D6, 0x6DC}, {0x6DF, 0x6E4},
+    {0x6E7, 0x6E8}, {0x6EA, 0x6ED}, {0x711, 0x711}, {0x730, 0x74A}, {0x7A6, 0x7B0}, {0x900, 0x902},
+    {0x93A, 0x93A}, {0x93C, 0x93C}, {0x941, 0x948}, {0x94D, 0x94D}, {0x951, 0x957}, {0x962, 0x963},
+    {0xE31, 0xE31}, {0xE34, 0xE3A}, {0xE47, 0xE4E}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F},
+    {0x202A, 0x202E}, {0x2060, 0x2064}, {0x20D0, 0x20FF}, {0x302A, 0x302D}, {0x3099, 0x309A}, {0xFE00, 0xFE0F},
+    {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0x1F3FB, 0x1F3FF}, {0xE0000, 0xE0FFF}};
+
+/// East Asian wide and fullwidth characters and emoji that take two columns
+static const WidthRange wide_ranges[] = {
+    {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC}, {0x23F0, 0x23F0}, {0x23F3, 0x23F3},
+    {0x25FD, 0x25FE}, {0x2614, 0x2615}, {0x2648, 0x2653}, {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1},
+    {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE}, {0x26D4, 0x26D4}, {0x26EA, 0x26EA},
+    {0x26F2, 0x26F3}, {0x26F5, 0x26F5}, {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B},
+    {0x2728, 0x2728}, {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755}, {0x2757, 0x2757}, {0x2795, 0x2797},
+    {0x27B0, 0x27B0}, {0x27BF, 0x27BF}, {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x303E},
+    {0x3041, 0x33FF}, {0x3400, 0x4DBF}, {0x4E00, 0x9FFF}, {0xA000, 0xA4CF}, {0xA960, 0xA97F}, {0xAC00, 0xD7A3},
+    {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6F}, {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6},
+    {0x16FE0, 0x16FE4}, {0x17000, 0x18CFF}, {0x1B000, 0x1B2FF}, {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF},
+    {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A}, {0x1F200, 0x1F202}, {0x1F210, 0x1F23B}, {0x1F240, 0x1F248},
+    {0x1F250, 0x1F251}, {0x1F260, 0x1F265}, {0x1F300, 0x1F320}, {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C},
+    {0x1F37E, 0x1F393}, {0x1F3A0, 0x1F3CA}, {0x1F3CF, 0x1F3D3}, {0x1F3E0, 0x1F3F0}, {0x1F3F4, 0x1F3F4},
+    {0x1F3F8, 0x1F43E}, {0x1F440, 0x1F440}, {0x1F442, 0x1F4FC}, {0x1F4FF, 0x1F53D}, {0x1F54B, 0x1F54E},
+    {0x1F550, 0x1F567}, {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596}, {0x1F5A4, 0x1F5A4}, {0x1F5FB, 0x1F64F},
+    {0x1F680, 0x1F6C5}, {0x1F6CC, 0x1F6CC}, {0x1F6D0, 0x1F6D2}, {0x1F6D5, 0x1F6D7}, {0x1F6DC, 0x1F6DF},
+    {0x1F6EB, 0x1F6EC}, {0x1F6F4, 0x1F6FC}, {0x1F7E0, 0x1F7EB}, {0x1F7F0, 0x1F7F0}, {0x1F90C, 0x1F93A},
+    {0x1F93C, 0x1F945}, {0x1F947, 0x1F9FF}, {0x1FA70, 0x1FAFF}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}};
+
+/// \brief Binary search code point from sorted ranges
+template<std::size_t N>
+static inline bool in_ranges(const WidthRange (&ranges)[N], std::uint32_t cp) noexcept {
+    std::size_t first = 0;
+    std::size_t last = N;
+    while (first < last) {
+        std::size_t mid = (first + last) / 2;
+        if (cp < ranges[mid].first) {
+            last = mid;
+        } else if (cp > ranges[mid].last) {
+            first = mid + 1;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace detail
+
+/// \brief Number of terminal columns the code point takes, like wcwidth()
+///
+/// Control characters and combining marks take zero columns, East Asian wide
+/// characters and emoji two and everything else, including malformed input,
+/// one.
+///
+/// \param[in] cp Code point
+///
+/// \return std::size_t 0, 1 or 2
+static inline std::size_t display_width(std::uint32_t cp) noexcept {
+    if (cp < 0x300) {
+        return (cp < 0x20 || (cp >= 0x7F && cp < 0xA0)) ? 0 : 1;
+    }
+    if (cp == invalid_code_point) {
+        return 1;
+    }
+    if (detail::in_ranges(detail::zero_width_ranges, cp)) {
+        return 0;
+    }
+    return cp >= 0x1100 && detail::in_ranges(detail::wide_ranges, cp) ? 2 : 1;
+}
+
+/// \brief Number of terminal columns the string takes
+///
+/// \param[in] p Start of the string
+/// \param[in] n size_t Length of the string
+///
+/// \return size_t
+static inline std::size_t display_width(const char* p, std::size_t n) noexcept {
+    const std::uint64_t ones = 0x0101010101010101ull;
+    const std::uint64_t highs = 0x8080808080808080ull;
+    std::size_t width = 0;
+    std::size_t i = 0;
+    while (i < n) {
+        // Printable ASCII takes a column per byte, checked eight bytes at a time
+        for (; i + 8 <= n; i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, p + i, sizeof(word));
+            std::uint64_t del = word ^ (ones * 0x7F);
+            if (((word | ((word - ones * 0x20) & ~word) | ((del - ones) & ~del)) & highs) != 0) {
+                break;
+            }
+            width += 8;
+        }
+        if (i == n) {
+            break;
+        }
+        unsigned char c = static_cast<unsigned char>(p[i]);
+        if (c < 0x80) {
+            width += c >= 0x20 && c != 0x7F;
+            ++i;
+        } else {
+            std::uint32_t cp;
+            i += decode(p + i, n - i, cp);
+            width += display_width(cp);
+        }
+    }
+    return width;
+}
+
+} // namespace utf8
+} // namespace string
+} // namespace general
+} // namespace drodil
+
+#endif // STRING_UTF8_HPP_